@@ -32,7 +32,48 @@
 --
 -- DATE:        Oct 19, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              Initializes the reader's framing arena, and loads the
+--              configuration file, the reader's command set, the poll
+--              scheduler and the reconnect supervisor. The default comm
+--              settings are read without opening the port.
+--              Oct 19, 2026
+--              Starts the latency trace.
+--              Oct 19, 2026
+--              Starts the decode workers, and gives the read thread its own
+--              arena.
+--              Oct 19, 2026
+--              Reads the read thread's scheduling options and the latency
+--              profile.
+--              Oct 19, 2026
+--              The display buffer's planes are initialized with memset.
+--              Oct 19, 2026
+--              Sizes the window from the runtime-sized display buffer.
+--              Oct 19, 2026
+--              Starts the console renderer.
+--              Oct 19, 2026
+--              Reads the block engine's settings.
+--              Oct 19, 2026
+--              Compiles the tag filter.
+--              Oct 19, 2026
+--              Maps the UID lists.
+--              Oct 19, 2026
+--              Empties the read rate rollups.
+--              Oct 19, 2026
+--              Starts the tag analytics sketches.
+--              Oct 19, 2026
+--              Starts the cross-reader correlator.
+--              Oct 19, 2026
+--              Starts the read journal.
+--              Oct 19, 2026
+--              Loads the tag inventory.
+--              Oct 19, 2026
+--              Opens the shared-memory tag bus.
+--              Oct 19, 2026
+--              Creates the transport's lock, which lasts as long as the window.
+--              Oct 19, 2026
+--              Only the read thread's arena is initialized; the decode path
+--              no longer needs one.
 --
 -- DESIGNER:    Dean Morin
 --
@@ -55,8 +96,6 @@ VOID InitTerminal(HWND hWnd) {
     PAINTSTRUCT ps          = {0};
     RECT        windowRect  = {0};
     RECT        clientRect  = {0};
-    UINT        i           = 0;
-    UINT        j           = 0;
     LONG        lxDiff      = 0;
     LONG        lyDiff      = 0;
 
@@ -67,6 +106,36 @@ VOID InitTerminal(HWND hWnd) {
     pwd->lpszCommName   = TEXT("COM3");
     SetWindowLongPtr(hWnd, 0, (LONG_PTR) pwd);
 
+    // read the configuration file and build the reader's commands
+    InitConfig(hWnd);
+    LoadCommandSet(hWnd);
+    InitBlockEngine(hWnd);
+    InitFilter(hWnd);
+    InitUidLists(hWnd);
+    InitRollup(hWnd);
+    InitSketch(hWnd);
+    InitCorrelator(hWnd);
+    InitJournal(hWnd);
+    InitInventory(hWnd);
+    InitBus(hWnd);
+    InitPollScheduler(hWnd);
+    InitSupervisor(hWnd);
+    InitTrace(hWnd);
+    InitRealtime(hWnd);
+    InitLatencyProfile(hWnd);
+
+    // scratch memory for framing
+    if (!InitArena(&pwd->ioArena, ARENA_SIZE)) {
+        DISPLAY_ERROR("Error allocating memory for the framing arena");
+    }
+
+    // the workers that decode frames, and the port I/O they share
+    InitTransport(&pwd->transport);
+    InitStrand(hWnd, &pwd->strand);
+    if (!StartWorkerPool(hWnd)) {
+        DISPLAY_ERROR("Error starting the decode workers");
+    }
+
     // get text attributes and store values into the window extra struct
     hdc = GetDC(hWnd);
 	pwd->displayBuf.hFont = (HFONT) GetStockObject(OEM_FIXED_FONT);
@@ -76,22 +145,20 @@ VOID InitTerminal(HWND hWnd) {
 
     // initialize variables in PWDDATA struct to defaults
     pwd->bConnected         = FALSE;
-    pwd->psIncompleteEsc    = NULL;
     CHAR_WIDTH              = tm.tmAveCharWidth;
     CHAR_HEIGHT             = tm.tmHeight;
     CUR_FG_COLOR            = 7;
-    WINDOW_BOTTOM           = LINES_PER_SCRN -1;
 	pwd->wordWrap			= FALSE;
 	pwd->relOrigin			= FALSE;
     
-    // initialize a "blank" display buffer
-    for (i = 0; i < LINES_PER_SCRN; i++) {
-        pwd->displayBuf.rows[i] = (PLINE) calloc(1, sizeof(LINE));
-        for (j = 0; j < CHARS_PER_LINE; j++) {
-            CHARACTER(j, i).character   = ' ';
-            CHARACTER(j, i).fgColor     = 7;
-        }
+    // initialize a "blank" display buffer, and its scrollback
+    if (!InitDisplay(hWnd)) {
+        DISPLAY_ERROR("Error allocating the display buffer");
+        PostQuitMessage(0);
+        return;
     }
+    WINDOW_BOTTOM           = LINES_PER_SCRN -1;
+
     // set the window size based off of the font size
     GetWindowRect(hWnd, &windowRect);
     GetClientRect(hWnd, &clientRect);
@@ -107,17 +174,18 @@ VOID InitTerminal(HWND hWnd) {
                CHAR_HEIGHT * LINES_PER_SCRN + PADDING * 2 + lyDiff,
                TRUE);
 
-    // set default comm settings
+    // set default comm settings; the baud rate is negotiated on connect
     pwd->cc.dwSize = sizeof(COMMCONFIG);
-    Connect(hWnd);
-    GetCommConfig(pwd->hPort, &pwd->cc, &pwd->cc.dwSize);
-    Disconnect(hWnd);
+    GetDefaultCommConfig(pwd->lpszCommName, &pwd->cc, &pwd->cc.dwSize);
     FillMemory(&pwd->cc.dcb, sizeof(DCB), 0);
     pwd->cc.dcb.DCBlength = sizeof(DCB);
-    BuildCommDCB((LPCWSTR)"96,N,8,1", &pwd->cc.dcb);
+    BuildCommDCB(TEXT("baud=9600 parity=N data=8 stop=1"), &pwd->cc.dcb);
 
     //print out headers for Tokens and Values
     MakeColumns(hWnd);
+
+    // mirror the display on a terminal, if it's wanted
+    InitConsole(hWnd);
 }
 
 /*------------------------------------------------------------------------------
@@ -125,7 +193,16 @@ VOID InitTerminal(HWND hWnd) {
 --
 -- DATE:        Oct 19, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              Added View > Read Rates.
+--              Oct 19, 2026
+--              Added View > Tag Analytics.
+--              Oct 19, 2026
+--              Added View > Zone Events.
+--              Oct 19, 2026
+--              Added View > Tag History.
+--              Oct 19, 2026
+--              Added View > Inventory.
 --
 -- DESIGNER:    Dean Morin
 --
@@ -176,6 +253,26 @@ VOID PerformMenuAction(HWND hWnd, WPARAM wParam) {
                 DISPLAY_ERROR("The comm settings dialogue failed.\nThis port may not exist");
             }
 		    return;
+
+        case IDM_RATES:
+            ShowRollup(hWnd);
+            return;
+
+        case IDM_SKETCH:
+            ShowSketch(hWnd);
+            return;
+
+        case IDM_ZONES:
+            ShowCorrelator(hWnd);
+            return;
+
+        case IDM_HISTORY:
+            ShowJournal(hWnd);
+            return;
+
+        case IDM_INVENTORY:
+            ShowInventory(hWnd);
+            return;
         
         default:
             return;
@@ -187,7 +284,15 @@ VOID PerformMenuAction(HWND hWnd, WPARAM wParam) {
 --
 -- DATE:        Oct 19, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              Reads the cells from the display buffer's planes.
+--              Oct 19, 2026
+--              Only draws the lines in the update region, from wherever the
+--              viewport is in the scrollback, and draws each run of cells
+--              with the same colours in one call.
+--              Oct 19, 2026
+--              Holds the display buffer's critical section while it reads
+--              the cells, which the decode workers write.
 --
 -- DESIGNER:    Dean Morin
 --
@@ -204,18 +309,31 @@ VOID PerformMenuAction(HWND hWnd, WPARAM wParam) {
 VOID Paint(HWND hWnd) {
     PLOGFONT	    plf         = NULL;
     PWNDDATA        pwd         = NULL;
-    CHAR            a[2]        = {0};
     HDC             hdc         = {0};
     PAINTSTRUCT     ps          = {0};
-    UINT            i           = 0;
+    CHAR*           pcChars     = NULL;
+    BYTE*           pbFgColors  = NULL;
+    BYTE*           pbBgColors  = NULL;
+    INT             iFirst      = 0;
+    INT             iLast       = 0;
+    INT             i           = 0;
     UINT            j           = 0;
+    UINT            k           = 0;
+    UINT            uiCell      = 0;
     UINT            tempfgColor = 0;
     UINT            tempbgColor = 0;
 	UINT            tempStyle	= 0;
     pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
 
+    if (pwd->displayBuf.pcChars == NULL) {
+        ValidateRect(hWnd, NULL);
+        return;
+    }
+    UpdateViewport(hWnd);
+
     hdc = BeginPaint(hWnd, &ps) ;
     SelectObject(hdc, pwd->displayBuf.hFont);
+    EnterCriticalSection(&pwd->displayBuf.cs);
 
     tempfgColor = CUR_FG_COLOR;
     tempbgColor = CUR_BG_COLOR;
@@ -224,23 +342,41 @@ VOID Paint(HWND hWnd) {
     SetTextColor(hdc, TXT_COLOURS[CUR_FG_COLOR]);
     SetBkColor(hdc, TXT_COLOURS[CUR_BG_COLOR]);
                              
-    for (i = 0; i < LINES_PER_SCRN; i++) {
-        for (j = 0; j < CHARS_PER_LINE; j++) {
+    // only the lines of the screen that need to be drawn again
+    iFirst  = max((ps.rcPaint.top - PADDING) / (INT) CHAR_HEIGHT, 0);
+    iLast   = (ps.rcPaint.bottom - PADDING + (INT) CHAR_HEIGHT - 1) 
+            / (INT) CHAR_HEIGHT;
+    iLast   = min(iLast, (INT) LINES_PER_SCRN);
+                             
+    for (i = iFirst; i < iLast; i++) {
+        uiCell      = GetDisplayRow(&pwd->displayBuf, 
+                                    i - (INT) pwd->displayBuf.uiView)
+                    * CHARS_PER_LINE;
+        pcChars     = pwd->displayBuf.pcChars    + uiCell;
+        pbFgColors  = pwd->displayBuf.pbFgColors + uiCell;
+        pbBgColors  = pwd->displayBuf.pbBgColors + uiCell;
+
+        for (j = 0; j < CHARS_PER_LINE; j = k) {
             
-            if (CHARACTER(j, i).fgColor != tempfgColor) {
-                SetTextColor(hdc, TXT_COLOURS[CHARACTER(j, i).fgColor]);
-                tempfgColor = CHARACTER(j, i).fgColor;
+            if (pbFgColors[j] != tempfgColor) {
+                SetTextColor(hdc, TXT_COLOURS[pbFgColors[j]]);
+                tempfgColor = pbFgColors[j];
             }
-            if (CHARACTER(j, i).bgColor != tempbgColor) {
-	            SetBkColor(hdc, TXT_COLOURS[CHARACTER(j, i).bgColor]);
-                tempbgColor = CHARACTER(j, i).bgColor;
+            if (pbBgColors[j] != tempbgColor) {
+	            SetBkColor(hdc, TXT_COLOURS[pbBgColors[j]]);
+                tempbgColor = pbBgColors[j];
             }
-
-            a[0] = CHARACTER(j, i).character;
-            TextOut(hdc, CHAR_WIDTH * j + PADDING, CHAR_HEIGHT * i + PADDING,
-                    (LPCWSTR) a, 1);
+            for (k = j + 1; k < CHARS_PER_LINE; k++) {
+                if (pbFgColors[k] != tempfgColor  
+                        ||  pbBgColors[k] != tempbgColor) {
+                    break;
+                }
+            }
+            TextOutA(hdc, CHAR_WIDTH * j + PADDING, CHAR_HEIGHT * i + PADDING,
+                     pcChars + j, k - j);
         }
     }
+    LeaveCriticalSection(&pwd->displayBuf.cs);
 	
     EndPaint(hWnd, &ps);
 }
@@ -250,7 +386,10 @@ VOID Paint(HWND hWnd) {
 --
 -- DATE:        Nov 6, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              Writes each header with UpdateDisplayRun().
+--              Oct 19, 2026
+--              Holds the display buffer's critical section.
 --
 -- DESIGNER:    Ian Lee
 --
@@ -269,14 +408,12 @@ VOID Paint(HWND hWnd) {
 VOID MakeColumns(HWND hWnd){
     CHAR temp1[10]= "Token";
     CHAR temp2[10]= "Value";
-	DWORD i;
+    PWNDDATA pwd  = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
 
+    EnterCriticalSection(&pwd->displayBuf.cs);
     MoveCursor( hWnd, 1, 1, FALSE);
-    for(i=0;i<10;i++){
-        UpdateDisplayBuf(hWnd,temp1[i]);
-    }
+    UpdateDisplayRun(hWnd, temp1, 10);
     MoveCursor( hWnd, 12, 1, FALSE);
-    for(i=0;i<10;i++){
-        UpdateDisplayBuf(hWnd,temp2[i]);
-    }    
+    UpdateDisplayRun(hWnd, temp2, 10);
+    LeaveCriticalSection(&pwd->displayBuf.cs);
 }
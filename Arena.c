@@ -0,0 +1,175 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Arena.c - Contains a simple bump allocator for the scratch
+--                            memory used while framing reads.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              BOOL    InitArena(PARENA, DWORD);
+--              VOID*   ArenaAlloc(PARENA, DWORD);
+--              VOID    ResetArena(PARENA);
+--              VOID    FreeArena(PARENA);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- Every reader's read thread owns one arena. The packets it pulls off its
+-- queue only have to live until they have been copied to the strand, so they
+-- are taken from the arena instead of the heap, and the whole arena is
+-- released at once by ResetArena() after each read.
+--
+-- If a read needs more than the arena holds, the extra requests fall back to
+-- the heap and are released on the next reset. dwHeapAllocs counts every heap
+-- allocation made on behalf of the read thread, so it should stop increasing
+-- once the reader reaches a steady state. dwFailures counts the requests that
+-- couldn't be met at all. Both are shown with the read rates.
+------------------------------------------------------------------------------*/
+
+#include "Arena.h"
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitArena
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL InitArena(PARENA pArena, DWORD dwCapacity)
+--                          pArena      - the arena to initialize
+--                          dwCapacity  - the size of the arena in bytes
+--
+-- RETURNS:     False if the arena's memory could not be allocated.
+--
+-- NOTES:
+--              Allocates the arena's block and zeroes its counters.
+------------------------------------------------------------------------------*/
+BOOL InitArena(PARENA pArena, DWORD dwCapacity) {
+
+    ZeroMemory(pArena, sizeof(ARENA));
+
+    if ((pArena->pBlock = (CHAR*) malloc(dwCapacity)) == NULL) {
+        return FALSE;
+    }
+    pArena->dwCapacity = dwCapacity;
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ArenaAlloc
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID* ArenaAlloc(PARENA pArena, DWORD dwSize)
+--                          pArena  - the arena to allocate from
+--                          dwSize  - the number of bytes needed
+--
+-- RETURNS:     A pointer to dwSize bytes, or NULL if the memory could not be
+--              allocated.
+--
+-- NOTES:
+--              The memory is valid until the next call to ResetArena(). It
+--              must not be passed to free().
+------------------------------------------------------------------------------*/
+VOID* ArenaAlloc(PARENA pArena, DWORD dwSize) {
+    ARENA_CHUNK*    pChunk  = NULL;
+    VOID*           p       = NULL;
+
+    // keep every allocation pointer-aligned
+    dwSize = (dwSize + sizeof(VOID*) - 1) & ~(sizeof(VOID*) - 1);
+
+    if (pArena->dwUsed + dwSize <= pArena->dwCapacity) {
+        p = pArena->pBlock + pArena->dwUsed;
+        pArena->dwUsed += dwSize;
+
+        if (pArena->dwUsed > pArena->dwHighWater) {
+            pArena->dwHighWater = pArena->dwUsed;
+        }
+        return p;
+    }
+
+    // the arena is full, so borrow from the heap until the next reset
+    pChunk = (ARENA_CHUNK*) malloc(sizeof(ARENA_CHUNK) + dwSize);
+    if (pChunk == NULL) {
+        pArena->dwFailures++;
+        return NULL;
+    }
+    pArena->dwHeapAllocs++;
+    pChunk->next        = pArena->pOverflow;
+    pArena->pOverflow   = pChunk;
+    return pChunk + 1;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ResetArena
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID ResetArena(PARENA pArena)
+--                          pArena  - the arena to reset
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Releases everything allocated since the last reset. Called once
+--              a batch of frames has been fully processed.
+------------------------------------------------------------------------------*/
+VOID ResetArena(PARENA pArena) {
+    ARENA_CHUNK* pChunk = NULL;
+
+    while (pArena->pOverflow != NULL) {
+        pChunk              = pArena->pOverflow;
+        pArena->pOverflow   = pChunk->next;
+        free(pChunk);
+    }
+    pArena->dwUsed = 0;
+    pArena->dwResets++;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FreeArena
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID FreeArena(PARENA pArena)
+--                          pArena  - the arena to free
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Releases the arena's block along with any heap overflow.
+------------------------------------------------------------------------------*/
+VOID FreeArena(PARENA pArena) {
+    ResetArena(pArena);
+    free(pArena->pBlock);
+    pArena->pBlock      = NULL;
+    pArena->dwCapacity  = 0;
+}
@@ -0,0 +1,29 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <Windows.h>
+
+#define ARENA_SIZE      4096    // bytes of scratch memory per reader
+
+typedef struct arenaChunk ARENA_CHUNK;
+typedef struct arenaChunk {
+    ARENA_CHUNK*    next;
+} ARENA_CHUNK;
+
+typedef struct arena {
+    CHAR*           pBlock;
+    DWORD           dwCapacity;
+    DWORD           dwUsed;
+    DWORD           dwHighWater;
+    ARENA_CHUNK*    pOverflow;
+    DWORD           dwHeapAllocs;
+    DWORD           dwFailures;
+    DWORD           dwResets;
+} ARENA, *PARENA;
+
+BOOL    InitArena(PARENA pArena, DWORD dwCapacity);
+VOID*   ArenaAlloc(PARENA pArena, DWORD dwSize);
+VOID    ResetArena(PARENA pArena);
+VOID    FreeArena(PARENA pArena);
+
+#endif
@@ -0,0 +1,558 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Blocks.c - Contains the engine that reads and writes the
+--                             memory blocks of ISO 15693 tags.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    InitBlockEngine(HWND);
+--              VOID    StartBlockJob(HWND, PTAGREAD);
+--              BOOL    ProcessBlockReply(HWND, CHAR*, DWORD, PTAGREAD);
+--              VOID    CheckBlockTimeout(HWND);
+--              VOID    ResetBlockEngine(HWND);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Timeouts are checked on a tick from the read thread, and the
+--              requests in flight are queued again when the port is closed.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- When an ISO 15693 tag is inventoried, the engine queues the block requests
+-- for it: Read Multiple Blocks for up to BLOCK_LINE_BYTES at a time, or Write
+-- Single Block for each block. Each request is addressed to the tag's UID, and
+-- is wrapped in the reader's own command, which is configurable:
+--
+--      SOF | length (2) | device | flags | Command | 0x22 | ISO command |
+--      UID (LSB first) | block | count - 1 or data | LRC | ~LRC
+--
+-- Up to BLOCK_PIPELINE requests are sent without waiting for their replies, so
+-- the reader always has the next one waiting when it finishes with the RF,
+-- and requests for different tags are interleaved. The reader answers its
+-- commands in order, so each reply belongs to the oldest request sent. Every
+-- reader has its own engine, which only its strand uses (see Pool.c), so
+-- readers don't wait on one another and nothing needs locking.
+--
+-- A reply that fails its LRC, or whose status says the tag didn't answer, is
+-- sent again up to BLOCK_RETRIES times, as is every request outstanding when
+-- the oldest has gone Timeout milliseconds without a reply. The read thread
+-- hands the strand an empty frame every Timeout milliseconds so that this is
+-- checked even when nothing else arrives. Errors reported by the tag itself
+-- (e.g. a locked block) are not retried. When the port is closed, the requests
+-- in flight will never be answered, so they go back on the queue to be sent
+-- once the port is open again. The time from sending
+-- a request to its reply is added to the "block" latency histogram once for
+-- each block it carried.
+--
+-- A tag is only done once; the last BLOCK_RECENT tags are remembered.
+--
+--      [Blocks]
+--      Mode=off
+--      Command=
+--      FirstBlock=0
+--      Count=8
+--      BlockSize=4
+--      Data=
+--      Timeout=500
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+static VOID SendBlockRequests(HWND hWnd);
+static VOID RetryBlockRequest(HWND hWnd, PBLOCKREQ pReq);
+static VOID ShowBlockResult(HWND hWnd, PBLOCKREQ pReq, CHAR* pcData,
+                            DWORD dwLength, BOOL bError);
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitBlockEngine
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitBlockEngine(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Reads the [Blocks] section of the configuration file. The
+--              engine stays off unless Mode is "read" or "write" and Command
+--              holds the reader's opcode. Data is padded with zeros to fill
+--              Count blocks. Must be called after InitConfig().
+------------------------------------------------------------------------------*/
+VOID InitBlockEngine(HWND hWnd) {
+    PWNDDATA        pwd         = NULL;
+    PBLOCKENGINE    pBlocks     = NULL;
+    TCHAR           szMode[16]  = {0};
+    TCHAR           szHex[BLOCK_MAX_BLOCKS * BLOCK_MAX_SIZE * 3 + 1] = {0};
+    INT             iCount      = 0;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pBlocks = &pwd->blocks;
+
+    ZeroMemory(pBlocks, sizeof(BLOCKENGINE));
+    ReadConfigString(hWnd, TEXT("Blocks"), TEXT("Mode"), TEXT("off"),
+                     szMode, 16);
+    if (lstrcmpi(szMode, TEXT("write")) == 0) {
+        pBlocks->bWrite = TRUE;
+    } else if (lstrcmpi(szMode, TEXT("read")) != 0) {
+        return;
+    }
+
+    ReadConfigString(hWnd, TEXT("Blocks"), TEXT("Command"), TEXT(""),
+                     szHex, CMD_TEMPLATE_SIZE);
+    iCount = ParseHexBytes(szHex, pBlocks->pbPrefix, BLOCK_PREFIX_MAX);
+    if (iCount < 1) {
+        DISPLAY_ERROR("The block engine needs the reader's command");
+        return;
+    }
+    pBlocks->dwPrefixLength = iCount;
+
+    pBlocks->dwFirst        = min(ReadConfigInt(hWnd, TEXT("Blocks"),
+                                                TEXT("FirstBlock"), 0), 255);
+    pBlocks->dwCount        = ReadConfigInt(hWnd, TEXT("Blocks"),
+                                            TEXT("Count"), 8);
+    pBlocks->dwCount        = max(1, min(pBlocks->dwCount,
+                                         min(BLOCK_MAX_BLOCKS,
+                                             256 - pBlocks->dwFirst)));
+    pBlocks->dwBlockSize    = ReadConfigInt(hWnd, TEXT("Blocks"),
+                                            TEXT("BlockSize"), 4);
+    pBlocks->dwBlockSize    = max(1, min(pBlocks->dwBlockSize,
+                                         BLOCK_MAX_SIZE));
+    pBlocks->dwTimeout      = ReadConfigInt(hWnd, TEXT("Blocks"),
+                                            TEXT("Timeout"), BLOCK_TIMEOUT);
+
+    if (pBlocks->bWrite) {
+        ReadConfigString(hWnd, TEXT("Blocks"), TEXT("Data"), TEXT(""),
+                         szHex, sizeof(szHex) / sizeof(TCHAR));
+        if (ParseHexBytes(szHex, pBlocks->pbData,
+                          pBlocks->dwCount * pBlocks->dwBlockSize) < 0) {
+            DISPLAY_ERROR("The block engine's data is invalid");
+            return;
+        }
+    }
+    pBlocks->bEnabled = TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    StartBlockJob
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID StartBlockJob(HWND hWnd, PTAGREAD pRead)
+--                          hWnd    - the handle to the window
+--                          pRead   - a decoded tag
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Queues the requests for every block of an ISO 15693 tag that
+--              hasn't been done yet, and sends as many as the pipeline has
+--              room for. If the queue can't hold the whole job, the tag is
+--              left for the next inventory to find. Called from the reader's
+--              strand.
+------------------------------------------------------------------------------*/
+VOID StartBlockJob(HWND hWnd, PTAGREAD pRead) {
+    PWNDDATA        pwd             = NULL;
+    PBLOCKENGINE    pBlocks         = NULL;
+    PBLOCKREQ       pReq            = NULL;
+    DWORD           dwPerRequest    = 0;
+    DWORD           dwRequests      = 0;
+    DWORD           i               = 0;
+    DWORD           j               = 0;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pBlocks = &pwd->blocks;
+
+    if (!pBlocks->bEnabled  ||  pRead->bType != TAG_ISO15693
+            ||  pRead->dwUidLength != MAX_UID_LENGTH) {
+        return;
+    }
+    for (i = 0; i < BLOCK_RECENT; i++) {
+        if (memcmp(pBlocks->pbRecent[i], pRead->pbUid, MAX_UID_LENGTH) == 0) {
+            return;
+        }
+    }
+
+    dwPerRequest    = pBlocks->bWrite ? 1
+                                      : BLOCK_LINE_BYTES / pBlocks->dwBlockSize;
+    dwRequests      = (pBlocks->dwCount + dwPerRequest - 1) / dwPerRequest;
+    if (pBlocks->dwWaitCount + dwRequests > BLOCK_QUEUE) {
+        return;
+    }
+    memcpy(pBlocks->pbRecent[pBlocks->dwRecentNext], pRead->pbUid,
+           MAX_UID_LENGTH);
+    pBlocks->dwRecentNext = (pBlocks->dwRecentNext + 1) % BLOCK_RECENT;
+
+    for (i = 0; i < dwRequests; i++) {
+        pReq = &pBlocks->waiting[(pBlocks->dwWaitHead + pBlocks->dwWaitCount)
+                                 % BLOCK_QUEUE];
+
+        // the UID is displayed MSB first, and sent LSB first
+        for (j = 0; j < MAX_UID_LENGTH; j++) {
+            pReq->pbUid[j] = pRead->pbUid[MAX_UID_LENGTH - 1 - j];
+        }
+        pReq->bBlock    = (BYTE) (pBlocks->dwFirst + i * dwPerRequest);
+        pReq->bCount    = (BYTE) min(dwPerRequest,
+                                     pBlocks->dwCount - i * dwPerRequest);
+        pReq->dwTries   = 0;
+        pBlocks->dwWaitCount++;
+    }
+    SendBlockRequests(hWnd);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ProcessBlockReply
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL ProcessBlockReply(HWND hWnd, CHAR* pcPacket,
+--                                     DWORD dwLength, PTAGREAD pRead)
+--                          hWnd        - the handle to the window
+--                          pcPacket    - a frame from the reader
+--                          dwLength    - the number of bytes in pcPacket
+--                          pRead       - the frame's read and framed times
+--
+-- RETURNS:     True if the frame was the reply to a block request, in which
+--              case it shouldn't be decoded as a tag.
+--
+-- NOTES:
+--              Matches the reply to the oldest request sent, and then either
+--              displays the result or sends the request again. Every other
+--              frame is used to check for requests that have timed out.
+--              Called from the reader's strand for every frame.
+------------------------------------------------------------------------------*/
+BOOL ProcessBlockReply(HWND hWnd, CHAR* pcPacket, DWORD dwLength,
+                       PTAGREAD pRead) {
+    PWNDDATA        pwd     = NULL;
+    PBLOCKENGINE    pBlocks = NULL;
+    BLOCKREQ        req     = {0};
+    DWORD           dwSize  = 0;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pBlocks = &pwd->blocks;
+
+    if (pBlocks->dwSentCount == 0) {
+        return FALSE;
+    }
+    if (dwLength <= TAG_OPCODE
+            ||  (BYTE) pcPacket[TAG_OPCODE] != pBlocks->pbPrefix[0]) {
+        CheckBlockTimeout(hWnd);
+        return FALSE;
+    }
+
+    req = pBlocks->sent[pBlocks->dwSentHead];
+    pBlocks->dwSentHead = (pBlocks->dwSentHead + 1) % BLOCK_PIPELINE;
+    pBlocks->dwSentCount--;
+    dwSize = pBlocks->bWrite ? 0 : req.bCount * pBlocks->dwBlockSize;
+
+    if (DetectLRCError(pcPacket, dwLength)
+            ||  dwLength < BLOCK_DATA + CMD_TRAILER_LENGTH
+            ||  pcPacket[BLOCK_STATUS] != 0) {
+        // corrupted, or the tag didn't hear the request
+        RetryBlockRequest(hWnd, &req);
+
+    } else if (pcPacket[BLOCK_ISO_FLAGS] & ISO_ERROR_FLAG) {
+        // the tag refused it, so trying again won't help
+        pBlocks->dwFailures++;
+        ShowBlockResult(hWnd, &req, pcPacket + BLOCK_DATA,
+                        (dwLength > BLOCK_DATA + CMD_TRAILER_LENGTH) ? 1 : 0,
+                        TRUE);
+
+    } else if (dwLength < BLOCK_DATA + dwSize + CMD_TRAILER_LENGTH) {
+        RetryBlockRequest(hWnd, &req);
+
+    } else {
+        RecordBlockLatency(&pwd->trace, req.llSent, pRead->llFramed,
+                           req.bCount);
+        pBlocks->dwBlocksDone += req.bCount;
+        if (pBlocks->bWrite) {
+            ShowBlockResult(hWnd, &req,
+                            (CHAR*) pBlocks->pbData + (req.bBlock
+                                - pBlocks->dwFirst) * pBlocks->dwBlockSize,
+                            pBlocks->dwBlockSize, FALSE);
+        } else {
+            ShowBlockResult(hWnd, &req, pcPacket + BLOCK_DATA, dwSize, FALSE);
+        }
+    }
+    SendBlockRequests(hWnd);
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    SendBlockRequests
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID SendBlockRequests(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Moves waiting requests onto the reader's write queue until
+--              BLOCK_PIPELINE of them are outstanding. If the write queue is
+--              full, the rest wait for the next reply.
+------------------------------------------------------------------------------*/
+static VOID SendBlockRequests(HWND hWnd) {
+    PWNDDATA        pwd         = NULL;
+    PBLOCKENGINE    pBlocks     = NULL;
+    PBLOCKREQ       pReq        = NULL;
+    COMMAND         cmd         = {0};
+    BYTE            pbParams[BLOCK_PREFIX_MAX + 3 + MAX_UID_LENGTH
+                             + BLOCK_MAX_SIZE] = {0};
+    DWORD           dwLength    = 0;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pBlocks = &pwd->blocks;
+
+    while (pBlocks->dwSentCount < BLOCK_PIPELINE
+            &&  pBlocks->dwWaitCount > 0) {
+        pReq = &pBlocks->waiting[pBlocks->dwWaitHead];
+
+        dwLength = pBlocks->dwPrefixLength - 1;
+        memcpy(pbParams, pBlocks->pbPrefix + 1, dwLength);
+        pbParams[dwLength++] = ISO_FLAGS_ADDRESSED;
+        pbParams[dwLength++] = pBlocks->bWrite ? ISO_WRITE_SINGLE
+                                               : ISO_READ_MULTIPLE;
+        memcpy(pbParams + dwLength, pReq->pbUid, MAX_UID_LENGTH);
+        dwLength += MAX_UID_LENGTH;
+        pbParams[dwLength++] = pReq->bBlock;
+
+        if (pBlocks->bWrite) {
+            memcpy(pbParams + dwLength, pBlocks->pbData + (pReq->bBlock
+                       - pBlocks->dwFirst) * pBlocks->dwBlockSize,
+                   pBlocks->dwBlockSize);
+            dwLength += pBlocks->dwBlockSize;
+        } else {
+            pbParams[dwLength++] = pReq->bCount - 1;
+        }
+
+        if (!BuildCommand(&cmd, pBlocks->pbPrefix[0], pbParams, dwLength,
+                          FALSE)
+                ||  !QueueCommand(&pwd->transport, &cmd)) {
+            return;
+        }
+        pReq->llSent = TraceNow();
+        pBlocks->sent[(pBlocks->dwSentHead + pBlocks->dwSentCount)
+                      % BLOCK_PIPELINE] = *pReq;
+        pBlocks->dwSentCount++;
+        pBlocks->dwWaitHead = (pBlocks->dwWaitHead + 1) % BLOCK_QUEUE;
+        pBlocks->dwWaitCount--;
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    RetryBlockRequest
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID RetryBlockRequest(HWND hWnd, PBLOCKREQ pReq)
+--                          hWnd    - the handle to the window
+--                          pReq    - a request that wasn't answered properly
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Puts the request at the front of the queue, so it goes out
+--              next. After BLOCK_RETRIES it is reported as a failure instead.
+------------------------------------------------------------------------------*/
+static VOID RetryBlockRequest(HWND hWnd, PBLOCKREQ pReq) {
+    PWNDDATA        pwd     = NULL;
+    PBLOCKENGINE    pBlocks = NULL;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pBlocks = &pwd->blocks;
+
+    if (++pReq->dwTries > BLOCK_RETRIES
+            ||  pBlocks->dwWaitCount == BLOCK_QUEUE) {
+        pBlocks->dwFailures++;
+        ShowBlockResult(hWnd, pReq, NULL, 0, TRUE);
+        return;
+    }
+    pBlocks->dwWaitHead = (pBlocks->dwWaitHead + BLOCK_QUEUE - 1)
+                        % BLOCK_QUEUE;
+    pBlocks->waiting[pBlocks->dwWaitHead] = *pReq;
+    pBlocks->dwWaitCount++;
+    pBlocks->dwRetries++;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CheckBlockTimeout
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Called from DecodeFrame() for the read thread's timeout ticks,
+--              as well as for every frame that isn't a block reply.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID CheckBlockTimeout(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Called from the reader's strand. Requests that were queued
+--              while the port was closed are sent from here.
+--              If the oldest request has gone unanswered for too long, the
+--              reader has lost it, and since it answers in order, the requests
+--              sent after it can't be trusted either. They are all queued
+--              again, in their original order, and re-sent.
+------------------------------------------------------------------------------*/
+VOID CheckBlockTimeout(HWND hWnd) {
+    PWNDDATA        pwd     = NULL;
+    PBLOCKENGINE    pBlocks = NULL;
+    BLOCKREQ        req     = {0};
+    LONGLONG        llAge   = 0;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pBlocks = &pwd->blocks;
+
+    if (pBlocks->dwSentCount == 0) {
+        SendBlockRequests(hWnd);
+        return;
+    }
+    llAge = (TraceNow() - pBlocks->sent[pBlocks->dwSentHead].llSent) * 1000
+          / pwd->trace.llFrequency;
+    if (llAge < pBlocks->dwTimeout) {
+        return;
+    }
+
+    // newest first, so they end up at the front in order
+    while (pBlocks->dwSentCount > 0) {
+        pBlocks->dwSentCount--;
+        req = pBlocks->sent[(pBlocks->dwSentHead + pBlocks->dwSentCount)
+                            % BLOCK_PIPELINE];
+        RetryBlockRequest(hWnd, &req);
+    }
+    SendBlockRequests(hWnd);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ResetBlockEngine
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID ResetBlockEngine(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Called by ClosePort() once the strand has drained. The replies
+--              to the requests in flight went with the port, so the requests
+--              are put back at the front of the queue, in order, without
+--              counting as a try. Any that don't fit are counted as failures.
+------------------------------------------------------------------------------*/
+VOID ResetBlockEngine(HWND hWnd) {
+    PWNDDATA        pwd     = NULL;
+    PBLOCKENGINE    pBlocks = NULL;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pBlocks = &pwd->blocks;
+
+    // newest first, so they end up at the front in order
+    while (pBlocks->dwSentCount > 0) {
+        pBlocks->dwSentCount--;
+        if (pBlocks->dwWaitCount == BLOCK_QUEUE) {
+            pBlocks->dwFailures++;
+            continue;
+        }
+        pBlocks->dwWaitHead = (pBlocks->dwWaitHead + BLOCK_QUEUE - 1)
+                            % BLOCK_QUEUE;
+        pBlocks->waiting[pBlocks->dwWaitHead] =
+            pBlocks->sent[(pBlocks->dwSentHead + pBlocks->dwSentCount)
+                          % BLOCK_PIPELINE];
+        pBlocks->dwWaitCount++;
+    }
+    pBlocks->dwSentHead = 0;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ShowBlockResult
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID ShowBlockResult(HWND hWnd, PBLOCKREQ pReq,
+--                                          CHAR* pcData, DWORD dwLength,
+--                                          BOOL bError)
+--                          hWnd        - the handle to the window
+--                          pReq        - the request that finished
+--                          pcData      - the blocks read or written, or the
+--                                        tag's error code
+--                          dwLength    - the number of bytes in pcData
+--                          bError      - whether the request failed
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Displays the blocks under the number of the first one. A
+--              failure is displayed with the tag's UID, followed by its error
+--              code if it sent one.
+------------------------------------------------------------------------------*/
+static VOID ShowBlockResult(HWND hWnd, PBLOCKREQ pReq, CHAR* pcData,
+                            DWORD dwLength, BOOL bError) {
+    PWNDDATA    pwd                         = NULL;
+    CHAR        pcToken[16]                 = {0};
+    CHAR        pcUid[MAX_UID_LENGTH + 1]   = {0};
+    DWORD       i                           = 0;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    if (!bError) {
+        sprintf(pcToken, "%s %u", pwd->blocks.bWrite ? "WROTE" : "BLK",
+                pReq->bBlock);
+        EchoTag(hWnd, pcToken, strlen(pcToken), pcData, dwLength);
+        return;
+    }
+    for (i = 0; i < MAX_UID_LENGTH; i++) {
+        pcUid[i] = pReq->pbUid[MAX_UID_LENGTH - 1 - i];
+    }
+    if (dwLength > 0) {
+        pcUid[MAX_UID_LENGTH] = pcData[0];
+    }
+    sprintf(pcToken, "BLK %u ERR", pReq->bBlock);
+    EchoTag(hWnd, pcToken, strlen(pcToken), pcUid, MAX_UID_LENGTH + dwLength);
+}
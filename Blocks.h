@@ -0,0 +1,65 @@
+#ifndef BLOCKS_H
+#define BLOCKS_H
+
+#include <Windows.h>
+#include "Tag.h"
+
+#define BLOCK_QUEUE         64      // requests waiting to be sent
+#define BLOCK_PIPELINE      4       // requests sent but not yet answered
+#define BLOCK_RETRIES       3       // times a request is re-sent
+#define BLOCK_TIMEOUT       500     // default ms to wait for a reply
+#define BLOCK_RECENT        64      // tags remembered, so each is done once
+#define BLOCK_MAX_BLOCKS    64      // blocks in a job, at most
+#define BLOCK_MAX_SIZE      8       // bytes in a block, at most
+#define BLOCK_PREFIX_MAX    8       // bytes of the reader's command
+#define BLOCK_LINE_BYTES    16      // bytes read per request, so each
+                                    // result fits on a line of the display
+
+#define ISO_FLAGS_ADDRESSED 0x22    // addressed, high data rate
+#define ISO_READ_MULTIPLE   0x23    // ISO 15693 commands
+#define ISO_WRITE_SINGLE    0x21
+#define ISO_ERROR_FLAG      0x01    // set in the response flags on an error
+
+#define BLOCK_STATUS        6       // offsets in a reply to a block request
+#define BLOCK_ISO_FLAGS     7
+#define BLOCK_DATA          8
+
+typedef struct blockReq {
+    BYTE        pbUid[MAX_UID_LENGTH];  // LSB first, as it is sent
+    BYTE        bBlock;
+    BYTE        bCount;
+    DWORD       dwTries;
+    LONGLONG    llSent;
+} BLOCKREQ, *PBLOCKREQ;
+
+typedef struct blockEngine {
+    BOOL        bEnabled;
+    BOOL        bWrite;
+    BYTE        pbPrefix[BLOCK_PREFIX_MAX];
+    DWORD       dwPrefixLength;
+    DWORD       dwFirst;
+    DWORD       dwCount;
+    DWORD       dwBlockSize;
+    DWORD       dwTimeout;
+    BYTE        pbData[BLOCK_MAX_BLOCKS * BLOCK_MAX_SIZE];
+    BLOCKREQ    waiting[BLOCK_QUEUE];
+    DWORD       dwWaitHead;
+    DWORD       dwWaitCount;
+    BLOCKREQ    sent[BLOCK_PIPELINE];   // in the order the reader answers
+    DWORD       dwSentHead;
+    DWORD       dwSentCount;
+    BYTE        pbRecent[BLOCK_RECENT][MAX_UID_LENGTH];
+    DWORD       dwRecentNext;
+    DWORD       dwBlocksDone;
+    DWORD       dwRetries;
+    DWORD       dwFailures;
+} BLOCKENGINE, *PBLOCKENGINE;
+
+VOID    InitBlockEngine(HWND hWnd);
+VOID    StartBlockJob(HWND hWnd, PTAGREAD pRead);
+BOOL    ProcessBlockReply(HWND hWnd, CHAR* pcPacket, DWORD dwLength, 
+                          PTAGREAD pRead);
+VOID    CheckBlockTimeout(HWND hWnd);
+VOID    ResetBlockEngine(HWND hWnd);
+
+#endif
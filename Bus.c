@@ -0,0 +1,344 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Bus.c - Contains the tag bus, which passes every tag to
+--                          other programs on this computer through shared
+--                          memory.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    InitBus(HWND);
+--              VOID    PublishTag(PTAGREAD);
+--              VOID    CloseBus(VOID);
+--              BOOL    OpenBusConsumer(PBUSCONSUMER, LPCTSTR);
+--              DWORD   ReadBus(PBUSCONSUMER, PBUSRECORD, LONGLONG*);
+--              VOID    CloseBusConsumer(PBUSCONSUMER);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- Every tag that gets past the filter is written to a ring of BUS_SLOTS
+-- fixed-size records in a named file mapping (backed by the paging file), which
+-- any number of programs can map read-only. This program is the only writer;
+-- the decode strands take turns with a critical section. Writing a record
+-- costs the same however many programs read the ring, since the writer never
+-- looks at them.
+--
+-- Each record holds its number + 1, which is set to 0 while it is being
+-- written. The header holds the number of records written so far, which is
+-- only advanced once a record is complete. A consumer keeps its own cursor,
+-- and polls the header for new records. If it falls more than BUS_SLOTS behind,
+-- or a record it is copying is overwritten, ReadBus() reports an overrun and
+-- how many records were lost, and skips ahead to half a ring behind the
+-- writer.
+--
+-- The consumer functions use nothing but the mapping, so other programs can
+-- be built with this file and Bus.h. The name is Name in the [Bus] section;
+-- a name in the Local\ namespace is only seen in the same session. Only one
+-- program may write to a name.
+--
+--      [Bus]
+--      Name=Local\RfidTagBus
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+static BUS  bus             = {0};
+static BOOL bInitialized    = FALSE;
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitBus
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitBus(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Creates the shared memory if a name is set in the
+--              configuration file. Only the first call does anything, so
+--              every reader window can call it. Must be called after
+--              InitConfig().
+------------------------------------------------------------------------------*/
+VOID InitBus(HWND hWnd) {
+    TCHAR   szName[MAX_PATH]    = {0};
+    DWORD   dwSize              = 0;
+
+    if (bInitialized) {
+        return;
+    }
+    bInitialized = TRUE;
+
+    if (ReadConfigString(hWnd, TEXT("Bus"), TEXT("Name"), TEXT(""), szName,
+                         MAX_PATH) == 0) {
+        return;
+    }
+    dwSize  = sizeof(BUSHEADER) + BUS_SLOTS * sizeof(BUSRECORD);
+    bus.hMap = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0,
+                                 dwSize, szName);
+    if (bus.hMap == NULL) {
+        DISPLAY_ERROR("Could not create the tag bus");
+        return;
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        DISPLAY_ERROR("Another program is already writing to the tag bus");
+        CloseHandle(bus.hMap);
+        bus.hMap = NULL;
+        return;
+    }
+    bus.pHeader = (PBUSHEADER) MapViewOfFile(bus.hMap, FILE_MAP_WRITE, 0, 0,
+                                             0);
+    if (bus.pHeader == NULL) {
+        DISPLAY_ERROR("Could not map the tag bus");
+        CloseHandle(bus.hMap);
+        bus.hMap = NULL;
+        return;
+    }
+    bus.pRecords = (PBUSRECORD) (bus.pHeader + 1);
+
+    // a new mapping is all zeros; the magic number goes in last
+    bus.pHeader->dwVersion      = BUS_VERSION;
+    bus.pHeader->dwSlots        = BUS_SLOTS;
+    bus.pHeader->dwRecordSize   = sizeof(BUSRECORD);
+    bus.pHeader->dwProducer     = GetCurrentProcessId();
+    MemoryBarrier();
+    bus.pHeader->dwMagic        = BUS_MAGIC;
+
+    InitializeCriticalSection(&bus.cs);
+    bus.llNext   = 0;
+    bus.bEnabled = TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    PublishTag
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID PublishTag(PTAGREAD pRead)
+--                          pRead - a decoded tag, after UpdateInventory()
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Writes the tag over the oldest record in the ring. Called from
+--              any reader's strand.
+------------------------------------------------------------------------------*/
+VOID PublishTag(PTAGREAD pRead) {
+    PBUSRECORD      pRecord = NULL;
+    FILETIME        ft      = {0};
+    ULARGE_INTEGER  uli     = {0};
+    LONGLONG        llSeq   = 0;
+
+    if (!bus.bEnabled) {
+        return;
+    }
+    GetSystemTimeAsFileTime(&ft);
+    uli.LowPart     = ft.dwLowDateTime;
+    uli.HighPart    = ft.dwHighDateTime;
+
+    EnterCriticalSection(&bus.cs);
+    llSeq   = bus.llNext++;
+    pRecord = &bus.pRecords[llSeq & (BUS_SLOTS - 1)];
+    InterlockedExchange64(&pRecord->llSequence, 0);
+
+    pRecord->ullUid     = PackUid(pRead);
+    pRecord->ullTime    = uli.QuadPart;
+    pRecord->llFramed   = pRead->llFramed;
+    pRecord->dwReader   = pRead->dwReader;
+    pRecord->bType      = pRead->bType;
+    pRecord->bMatch     = pRead->bMatch;
+    pRecord->bArrived   = pRead->bArrived;
+    pRecord->bUidLength = (BYTE) pRead->dwUidLength;
+    memcpy(pRecord->pbUid, pRead->pbUid, MAX_UID_LENGTH);
+
+    MemoryBarrier();
+    pRecord->llSequence = llSeq + 1;
+    InterlockedExchange64(&bus.pHeader->llHead, llSeq + 1);
+    LeaveCriticalSection(&bus.cs);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CloseBus
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID CloseBus(VOID)
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Unmaps the ring. Consumers keep their own views, so it lasts
+--              until the last of them closes it. The decode workers must have
+--              stopped.
+------------------------------------------------------------------------------*/
+VOID CloseBus(VOID) {
+    if (!bus.bEnabled) {
+        return;
+    }
+    bus.bEnabled = FALSE;
+    DeleteCriticalSection(&bus.cs);
+    UnmapViewOfFile(bus.pHeader);
+    CloseHandle(bus.hMap);
+    ZeroMemory(&bus, sizeof(BUS));
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    OpenBusConsumer
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL OpenBusConsumer(PBUSCONSUMER pConsumer, LPCTSTR lpszName)
+--                          pConsumer   - the consumer to open
+--                          lpszName    - the bus's name
+--
+-- RETURNS:     False if there is no bus by that name, or it isn't one.
+--
+-- NOTES:
+--              Maps the ring read-only. The consumer starts with the next
+--              record to be written.
+------------------------------------------------------------------------------*/
+BOOL OpenBusConsumer(PBUSCONSUMER pConsumer, LPCTSTR lpszName) {
+    PBUSHEADER pHeader = NULL;
+
+    ZeroMemory(pConsumer, sizeof(BUSCONSUMER));
+    if ((pConsumer->hMap = OpenFileMapping(FILE_MAP_READ, FALSE, lpszName))
+            == NULL) {
+        return FALSE;
+    }
+    pHeader = (PBUSHEADER) MapViewOfFile(pConsumer->hMap, FILE_MAP_READ, 0, 0,
+                                         0);
+    if (pHeader == NULL  ||  pHeader->dwMagic != BUS_MAGIC
+            ||  pHeader->dwVersion != BUS_VERSION
+            ||  pHeader->dwSlots != BUS_SLOTS
+            ||  pHeader->dwRecordSize != sizeof(BUSRECORD)) {
+        if (pHeader != NULL) {
+            UnmapViewOfFile(pHeader);
+        }
+        CloseHandle(pConsumer->hMap);
+        pConsumer->hMap = NULL;
+        return FALSE;
+    }
+    MemoryBarrier();
+    pConsumer->pHeader  = pHeader;
+    pConsumer->pRecords = (PBUSRECORD) (pHeader + 1);
+    pConsumer->llCursor = pHeader->llHead;
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ReadBus
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   DWORD ReadBus(PBUSCONSUMER pConsumer, PBUSRECORD pRecord,
+--                            LONGLONG* pllLost)
+--                          pConsumer   - an open consumer
+--                          pRecord     - receives the next record
+--                          pllLost     - receives the number of records
+--                                        skipped, on an overrun
+--
+-- RETURNS:     BUS_RECORD if a record was read, BUS_EMPTY if there are no new
+--              ones, or BUS_OVERRUN if the consumer fell too far behind.
+--
+-- NOTES:
+--              Copies the record at the cursor, and checks that its number
+--              was the same before and after, so that a record overwritten
+--              while it was copied is never returned.
+------------------------------------------------------------------------------*/
+DWORD ReadBus(PBUSCONSUMER pConsumer, PBUSRECORD pRecord, LONGLONG* pllLost) {
+    PBUSRECORD  pSlot       = NULL;
+    LONGLONG    llHead      = 0;
+    LONGLONG    llBefore    = 0;
+    LONGLONG    llResume    = 0;
+
+    *pllLost = 0;
+    llHead = pConsumer->pHeader->llHead;
+    MemoryBarrier();
+    if (pConsumer->llCursor >= llHead) {
+        return BUS_EMPTY;
+    }
+    llResume = llHead - BUS_SLOTS / 2;
+
+    if (llHead - pConsumer->llCursor <= BUS_SLOTS) {
+        pSlot    = &pConsumer->pRecords[pConsumer->llCursor & (BUS_SLOTS - 1)];
+        llBefore = pSlot->llSequence;
+        MemoryBarrier();
+        memcpy(pRecord, (const VOID*) pSlot, sizeof(BUSRECORD));
+        MemoryBarrier();
+        if (llBefore == pConsumer->llCursor + 1
+                &&  pSlot->llSequence == llBefore) {
+            pConsumer->llCursor++;
+            return BUS_RECORD;
+        }
+        // overwritten while it was copied
+        llResume = max(pConsumer->pHeader->llHead - BUS_SLOTS / 2,
+                       pConsumer->llCursor + 1);
+    }
+    *pllLost = llResume - pConsumer->llCursor;
+    pConsumer->llCursor = llResume;
+    return BUS_OVERRUN;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CloseBusConsumer
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID CloseBusConsumer(PBUSCONSUMER pConsumer)
+--                          pConsumer - a consumer from OpenBusConsumer()
+--
+-- RETURNS:     VOID.
+------------------------------------------------------------------------------*/
+VOID CloseBusConsumer(PBUSCONSUMER pConsumer) {
+    if (pConsumer->pHeader != NULL) {
+        UnmapViewOfFile(pConsumer->pHeader);
+    }
+    if (pConsumer->hMap != NULL) {
+        CloseHandle(pConsumer->hMap);
+    }
+    ZeroMemory(pConsumer, sizeof(BUSCONSUMER));
+}
@@ -0,0 +1,67 @@
+#ifndef BUS_H
+#define BUS_H
+
+#include <Windows.h>
+#include "Tag.h"
+
+#define BUS_SLOTS           65536   // records in the ring, a power of two
+#define BUS_MAGIC           0x53554254  // "TBUS"
+#define BUS_VERSION         1
+
+#define BUS_EMPTY           0       // ReadBus() results
+#define BUS_RECORD          1
+#define BUS_OVERRUN         2
+
+// The shared memory is the header, then BUS_SLOTS records. Each is a cache
+// line, so that the producer and consumers of different records don't share
+// one.
+typedef struct busHeader {
+    DWORD               dwMagic;
+    DWORD               dwVersion;
+    DWORD               dwSlots;
+    DWORD               dwRecordSize;
+    volatile LONGLONG   llHead;         // records ever published
+    DWORD               dwProducer;     // the producer's process id
+    DWORD               dwReserved;
+    BYTE                pbReserved[32];
+} BUSHEADER, *PBUSHEADER;
+
+typedef struct busRecord {
+    volatile LONGLONG   llSequence;     // its number + 1, or 0 while written
+    ULONGLONG           ullUid;         // see PackUid()
+    ULONGLONG           ullTime;        // a FILETIME, in UTC
+    LONGLONG            llFramed;       // QueryPerformanceCounter()
+    DWORD               dwReader;
+    BYTE                bType;
+    BYTE                bMatch;
+    BYTE                bArrived;
+    BYTE                bUidLength;
+    BYTE                pbUid[MAX_UID_LENGTH];
+    BYTE                pbReserved[16];
+} BUSRECORD, *PBUSRECORD;
+
+typedef struct busConsumer {
+    HANDLE      hMap;
+    PBUSHEADER  pHeader;
+    PBUSRECORD  pRecords;
+    LONGLONG    llCursor;               // the next record to read
+} BUSCONSUMER, *PBUSCONSUMER;
+
+typedef struct bus {
+    CRITICAL_SECTION    cs;
+    BOOL                bEnabled;
+    HANDLE              hMap;
+    PBUSHEADER          pHeader;
+    PBUSRECORD          pRecords;
+    LONGLONG            llNext;
+} BUS, *PBUS;
+
+VOID    InitBus(HWND hWnd);
+VOID    PublishTag(PTAGREAD pRead);
+VOID    CloseBus(VOID);
+BOOL    OpenBusConsumer(PBUSCONSUMER pConsumer, LPCTSTR lpszName);
+DWORD   ReadBus(PBUSCONSUMER pConsumer, PBUSRECORD pRecord,
+                LONGLONG* pllLost);
+VOID    CloseBusConsumer(PBUSCONSUMER pConsumer);
+
+#endif
@@ -0,0 +1,261 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Command.c - Contains the functions that assemble the
+--                              command frames sent to the RFID reader.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              INT     ParseHexBytes(LPCTSTR, BYTE*, DWORD);
+--              BOOL    BuildCommand(PCOMMAND, BYTE, BYTE*, DWORD, BOOL);
+--              BOOL    LoadCommand(HWND, PCOMMAND, LPCTSTR, LPCTSTR, BOOL);
+--              VOID    LoadCommandSet(HWND);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Added the multi-tag inventory command.
+--              Oct 19, 2026
+--              ParseHexBytes() is public, for the block engine.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- Every command sent to the reader has the form:
+--
+--      SOF | length (LSB, MSB) | device | flags | opcode | params | LRC | ~LRC
+--
+-- The commands are described in the [Commands] section of the configuration
+-- file as an opcode followed by its parameters, all in hex. For example:
+--
+--      [Commands]
+--      Inventory=41 00
+--      Init=43 06 00
+--      MultiInventory=
+--
+-- If MultiInventory is set, it is sent instead of Inventory, and its replies
+-- are decoded as multi-tag responses (see ProcessPacket()).
+--
+-- The frames are built once at startup, so nothing is computed per request.
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ParseHexBytes
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              No longer static, so the block engine can parse its
+--              configuration.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   INT ParseHexBytes(LPCTSTR lpszHex, BYTE* pbBytes, DWORD dwMax)
+--                          lpszHex - whitespace separated hex bytes
+--                          pbBytes - receives the parsed bytes
+--                          dwMax   - the size of pbBytes
+--
+-- RETURNS:     The number of bytes parsed, or -1 if lpszHex is malformed.
+--
+-- NOTES:
+--              Parses a string such as "43 06 00" into bytes.
+------------------------------------------------------------------------------*/
+INT ParseHexBytes(LPCTSTR lpszHex, BYTE* pbBytes, DWORD dwMax) {
+    DWORD   dwCount     = 0;
+    DWORD   dwDigits    = 0;
+    BYTE    bValue      = 0;
+    TCHAR   c           = 0;
+
+    for (;; lpszHex++) {
+        c = *lpszHex;
+
+        if (c >= '0'  &&  c <= '9') {
+            bValue = (bValue << 4) | (c - '0');
+        } else if (c >= 'A'  &&  c <= 'F') {
+            bValue = (bValue << 4) | (c - 'A' + 10);
+        } else if (c >= 'a'  &&  c <= 'f') {
+            bValue = (bValue << 4) | (c - 'a' + 10);
+        } else if (c == ' '  ||  c == '\t'  ||  c == '\0') {
+            if (dwDigits > 0) {
+                if (dwCount == dwMax) {
+                    return -1;
+                }
+                pbBytes[dwCount++]  = bValue;
+                bValue              = 0;
+                dwDigits            = 0;
+            }
+            if (c == '\0') {
+                return dwCount;
+            }
+            continue;
+        } else {
+            return -1;
+        }
+
+        if (++dwDigits > 2) {
+            return -1;
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    BuildCommand
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL BuildCommand(PCOMMAND pCmd, BYTE bOpcode, BYTE* pbParams,
+--                                DWORD dwParamLength, BOOL bAsciiPrefix)
+--                          pCmd            - receives the frame
+--                          bOpcode         - the command's opcode
+--                          pbParams        - the command's parameters
+--                          dwParamLength   - the number of parameters
+--                          bAsciiPrefix    - whether to send the frame in
+--                                            ascii-hex before the binary frame
+--
+-- RETURNS:     False if the frame would be too long.
+--
+-- NOTES:
+--              Assembles a complete frame, including the LRC trailer. If
+--              bAsciiPrefix is set, the frame (without the trailer) is also
+--              written as ascii-hex ahead of the binary frame. The reader
+--              powers up expecting ascii, so the initialization command needs
+--              this to be understood.
+------------------------------------------------------------------------------*/
+BOOL BuildCommand(PCOMMAND pCmd, BYTE bOpcode, BYTE* pbParams,
+                  DWORD dwParamLength, BOOL bAsciiPrefix) {
+    static const CHAR HEX[] = "0123456789ABCDEF";
+    CHAR*   pcFrame         = NULL;
+    DWORD   dwFrameLength   = 0;
+    DWORD   dwPrefixLength  = 0;
+    DWORD   i               = 0;
+
+    dwFrameLength = CMD_HEADER_LENGTH + dwParamLength + CMD_TRAILER_LENGTH;
+    if (bAsciiPrefix) {
+        dwPrefixLength = (dwFrameLength - CMD_TRAILER_LENGTH) * 2;
+    }
+    if (dwPrefixLength + dwFrameLength > MAX_CMD_LENGTH) {
+        return FALSE;
+    }
+    pcFrame = pCmd->pcFrame + dwPrefixLength;
+
+    pcFrame[0] = CMD_SOF;
+    pcFrame[1] = (CHAR) (dwFrameLength & 0xFF);
+    pcFrame[2] = (CHAR) (dwFrameLength >> 8);
+    pcFrame[3] = CMD_DEVICE;
+    pcFrame[4] = CMD_FLAGS;
+    pcFrame[5] = bOpcode;
+    CopyMemory(pcFrame + CMD_HEADER_LENGTH, pbParams, dwParamLength);
+    AppendLRC(pcFrame, dwFrameLength);
+
+    for (i = 0; i < dwPrefixLength / 2; i++) {
+        pCmd->pcFrame[i * 2]        = HEX[(BYTE) pcFrame[i] >> 4];
+        pCmd->pcFrame[i * 2 + 1]    = HEX[(BYTE) pcFrame[i] & 0x0F];
+    }
+    pCmd->dwLength = dwPrefixLength + dwFrameLength;
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    LoadCommand
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL LoadCommand(HWND hWnd, PCOMMAND pCmd, LPCTSTR lpszName,
+--                               LPCTSTR lpszDefault, BOOL bAsciiPrefix)
+--                          hWnd            - the handle to the window
+--                          pCmd            - receives the frame
+--                          lpszName        - the key in the [Commands] section
+--                          lpszDefault     - the template used if the key is
+--                                            missing
+--                          bAsciiPrefix    - see BuildCommand()
+--
+-- RETURNS:     False if the template was invalid, in which case the default
+--              template is built. If there is no usable template at all (the
+--              default may be an empty string), the command's length is set
+--              to 0.
+--
+-- NOTES:
+--              Reads a command template from the configuration file and builds
+--              its frame.
+------------------------------------------------------------------------------*/
+BOOL LoadCommand(HWND hWnd, PCOMMAND pCmd, LPCTSTR lpszName,
+                 LPCTSTR lpszDefault, BOOL bAsciiPrefix) {
+    TCHAR   szTemplate[CMD_TEMPLATE_SIZE]   = {0};
+    BYTE    pbBytes[MAX_CMD_PARAMS + 1]     = {0};
+    INT     iCount                          = 0;
+
+    ReadConfigString(hWnd, TEXT("Commands"), lpszName, lpszDefault,
+                     szTemplate, CMD_TEMPLATE_SIZE);
+    iCount = ParseHexBytes(szTemplate, pbBytes, MAX_CMD_PARAMS + 1);
+
+    if (iCount >= 1  &&  BuildCommand(pCmd, pbBytes[0], pbBytes + 1, 
+                                      iCount - 1, bAsciiPrefix)) {
+        return TRUE;
+    }
+    iCount = ParseHexBytes(lpszDefault, pbBytes, MAX_CMD_PARAMS + 1);
+    if (iCount < 1  ||  !BuildCommand(pCmd, pbBytes[0], pbBytes + 1, 
+                                      iCount - 1, bAsciiPrefix)) {
+        pCmd->dwLength = 0;
+    }
+    return FALSE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    LoadCommandSet
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Loads the multi-tag inventory command.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID LoadCommandSet(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Builds every command the program sends to the reader.
+------------------------------------------------------------------------------*/
+VOID LoadCommandSet(HWND hWnd) {
+    PWNDDATA    pwd         = NULL;
+    COMMAND     multiCmd    = {0};
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    if (!LoadCommand(hWnd, &pwd->inventoryCmd, TEXT("Inventory"),
+                     DEFAULT_INVENTORY_CMD, FALSE)) {
+        DISPLAY_ERROR("Invalid Inventory command in Rfid.ini, using default");
+    }
+    if (!LoadCommand(hWnd, &pwd->initCmd, TEXT("Init"),
+                     DEFAULT_INIT_CMD, TRUE)) {
+        DISPLAY_ERROR("Invalid Init command in Rfid.ini, using default");
+    }
+    
+    // the anti-collision inventory reports every tag in the field at once
+    pwd->bMultiTag = LoadCommand(hWnd, &multiCmd, TEXT("MultiInventory"),
+                                 DEFAULT_MULTI_CMD, FALSE);
+    if (pwd->bMultiTag) {
+        pwd->inventoryCmd = multiCmd;
+    }
+}
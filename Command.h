@@ -0,0 +1,33 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <Windows.h>
+
+#define MAX_CMD_LENGTH      128     // the longest frame (ascii prefix
+                                    // included) that can be sent
+#define MAX_CMD_PARAMS      32      // the most parameter bytes in a command
+#define CMD_TEMPLATE_SIZE   128     // characters in a config file template
+
+#define CMD_SOF             0x01    // start of frame
+#define CMD_DEVICE          0x03    // the multi-protocol reader
+#define CMD_FLAGS           0x01
+#define CMD_HEADER_LENGTH   6       // SOF, length (2), device, flags, opcode
+#define CMD_TRAILER_LENGTH  2       // LRC and its complement
+
+#define DEFAULT_INVENTORY_CMD   TEXT("41 00")
+#define DEFAULT_INIT_CMD        TEXT("43 06 00")
+#define DEFAULT_MULTI_CMD       TEXT("")    // off unless configured
+
+typedef struct command {
+    CHAR    pcFrame[MAX_CMD_LENGTH];
+    DWORD   dwLength;
+} COMMAND, *PCOMMAND;
+
+INT     ParseHexBytes(LPCTSTR lpszHex, BYTE* pbBytes, DWORD dwMax);
+BOOL    BuildCommand(PCOMMAND pCmd, BYTE bOpcode, BYTE* pbParams,
+                     DWORD dwParamLength, BOOL bAsciiPrefix);
+BOOL    LoadCommand(HWND hWnd, PCOMMAND pCmd, LPCTSTR lpszName,
+                    LPCTSTR lpszDefault, BOOL bAsciiPrefix);
+VOID    LoadCommandSet(HWND hWnd);
+
+#endif
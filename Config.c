@@ -0,0 +1,186 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Config.c - Contains the functions for reading settings from
+--                             the RFID reader's configuration file.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    InitConfig(HWND);
+--              UINT    ReadConfigInt(HWND, LPCTSTR, LPCTSTR, INT);
+--              DWORD   ReadConfigString(HWND, LPCTSTR, LPCTSTR, LPCTSTR,
+--                                       LPTSTR, DWORD);
+--              DWORD   ReadConfigPath(HWND, LPCTSTR, LPCTSTR, LPTSTR);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Added ReadConfigPath().
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- Settings are kept in an .ini file (Rfid.ini) in the same directory as the
+-- executable. Every setting has a default, so the file, or any key in it, may
+-- be left out.
+------------------------------------------------------------------------------*/
+
+#include "Config.h"
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitConfig
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitConfig(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Stores the full path of the configuration file in the window
+--              extra. The Get*Profile* functions look in the Windows directory
+--              when given a bare filename, so the path has to be absolute.
+------------------------------------------------------------------------------*/
+VOID InitConfig(HWND hWnd) {
+    PWNDDATA    pwd     = NULL;
+    DWORD       dwLen   = 0;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    dwLen = GetModuleFileName(NULL, pwd->szConfigFile, MAX_PATH);
+
+    // strip the executable's name, leaving the trailing backslash
+    while (dwLen > 0  &&  pwd->szConfigFile[dwLen - 1] != '\\') {
+        dwLen--;
+    }
+    if (dwLen + lstrlen(CONFIG_FILENAME) >= MAX_PATH) {
+        dwLen = 0;
+    }
+    lstrcpy(pwd->szConfigFile + dwLen, CONFIG_FILENAME);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ReadConfigInt
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   UINT ReadConfigInt(HWND hWnd, LPCTSTR lpszSection, 
+--                                 LPCTSTR lpszKey, INT iDefault)
+--                          hWnd        - the handle to the window
+--                          lpszSection - the [section] containing the key
+--                          lpszKey     - the name of the setting
+--                          iDefault    - the value used if the key is missing
+--
+-- RETURNS:     The value of the setting.
+--
+-- NOTES:
+--              Reads an integer setting from the configuration file.
+------------------------------------------------------------------------------*/
+UINT ReadConfigInt(HWND hWnd, LPCTSTR lpszSection, LPCTSTR lpszKey, 
+                   INT iDefault) {
+    PWNDDATA pwd = NULL;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    return GetPrivateProfileInt(lpszSection, lpszKey, iDefault, 
+                                pwd->szConfigFile);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ReadConfigString
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   DWORD ReadConfigString(HWND hWnd, LPCTSTR lpszSection, 
+--                                     LPCTSTR lpszKey, LPCTSTR lpszDefault,
+--                                     LPTSTR lpszBuf, DWORD dwSize)
+--                          hWnd        - the handle to the window
+--                          lpszSection - the [section] containing the key
+--                          lpszKey     - the name of the setting
+--                          lpszDefault - the value used if the key is missing
+--                          lpszBuf     - receives the value
+--                          dwSize      - the size of lpszBuf in characters
+--
+-- RETURNS:     The number of characters copied to lpszBuf.
+--
+-- NOTES:
+--              Reads a string setting from the configuration file.
+------------------------------------------------------------------------------*/
+DWORD ReadConfigString(HWND hWnd, LPCTSTR lpszSection, LPCTSTR lpszKey,
+                       LPCTSTR lpszDefault, LPTSTR lpszBuf, DWORD dwSize) {
+    PWNDDATA pwd = NULL;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    return GetPrivateProfileString(lpszSection, lpszKey, lpszDefault, 
+                                   lpszBuf, dwSize, pwd->szConfigFile);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ReadConfigPath
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   DWORD ReadConfigPath(HWND hWnd, LPCTSTR lpszSection, 
+--                                   LPCTSTR lpszKey, LPTSTR lpszPath)
+--                          hWnd        - the handle to the window
+--                          lpszSection - the [section] containing the key
+--                          lpszKey     - the name of the setting
+--                          lpszPath    - receives the path; MAX_PATH 
+--                                        characters
+--
+-- RETURNS:     The length of the path, or 0 if the setting is missing or
+--              empty.
+--
+-- NOTES:
+--              Reads a file name from the configuration file. A relative name
+--              is taken to be in the same directory as the configuration file.
+------------------------------------------------------------------------------*/
+DWORD ReadConfigPath(HWND hWnd, LPCTSTR lpszSection, LPCTSTR lpszKey,
+                     LPTSTR lpszPath) {
+    PWNDDATA    pwd                 = NULL;
+    TCHAR       szPath[MAX_PATH]    = {0};
+    DWORD       dwLen               = 0;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    if (ReadConfigString(hWnd, lpszSection, lpszKey, TEXT(""), lpszPath,
+                         MAX_PATH) == 0) {
+        return 0;
+    }
+    if (lpszPath[0] != '\\'  &&  lpszPath[1] != ':') {
+        lstrcpy(szPath, pwd->szConfigFile);
+        dwLen = lstrlen(szPath);
+        while (dwLen > 0  &&  szPath[dwLen - 1] != '\\') {
+            dwLen--;
+        }
+        if (dwLen + lstrlen(lpszPath) < MAX_PATH) {
+            lstrcpy(szPath + dwLen, lpszPath);
+            lstrcpy(lpszPath, szPath);
+        }
+    }
+    return lstrlen(lpszPath);
+}
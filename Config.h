@@ -0,0 +1,16 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include "Main.h"
+
+#define CONFIG_FILENAME     TEXT("Rfid.ini")
+
+VOID    InitConfig(HWND hWnd);
+UINT    ReadConfigInt(HWND hWnd, LPCTSTR lpszSection, LPCTSTR lpszKey, 
+                      INT iDefault);
+DWORD   ReadConfigString(HWND hWnd, LPCTSTR lpszSection, LPCTSTR lpszKey,
+                         LPCTSTR lpszDefault, LPTSTR lpszBuf, DWORD dwSize);
+DWORD   ReadConfigPath(HWND hWnd, LPCTSTR lpszSection, LPCTSTR lpszKey,
+                       LPTSTR lpszPath);
+
+#endif
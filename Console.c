@@ -0,0 +1,509 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Console.c - Draws the display buffer on a text terminal
+--                              with ANSI escape sequences.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    InitConsole(HWND);
+--              VOID    RenderConsole(HWND);
+--              VOID    CloseConsole(HWND);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- The console renderer is a second way of showing the display buffer, for
+-- when nobody is looking at the window: a console, or an SSH session to the
+-- machine. It writes to the program's standard output if that has been
+-- redirected (e.g. by sshd), and otherwise to the console it was started from,
+-- or a new one. Virtual terminal processing is turned on, so the output is
+-- plain ANSI/VT100.
+--
+-- Every Interval milliseconds the live screen is compared with a shadow copy
+-- of what the terminal is already showing. Only the cells that changed are
+-- sent: the cursor is moved to the start of each changed run (unless it is
+-- already there), colours are only set when they change, and short stretches
+-- of unchanged cells inside a run are rewritten rather than skipped with
+-- another cursor move. An idle screen costs nothing, and a new tag costs
+-- about the length of its line.
+--
+-- With Headless=1 the window is never shown, the reader on Port (1-9, or 0
+-- for the default) is connected at startup, and Ctrl+C closes the program.
+--
+--      [Console]
+--      Enabled=0
+--      Headless=0
+--      Interval=100
+--      Port=0
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+static HWND hConsoleWnd = NULL;
+
+static BOOL     ResizeShadow(PCONSOLE pCon, UINT uiCols, UINT uiRows);
+static VOID     WriteRun(PCONSOLE pCon, CHAR* pcChars, BYTE* pbFgColors,
+                         BYTE* pbBgColors, UINT cxCoord, UINT cyCoord,
+                         UINT uiCount);
+static CHAR*    ReserveOutput(PCONSOLE pCon, DWORD dwBytes);
+static VOID     FlushConsole(PCONSOLE pCon);
+static BOOL WINAPI ConsoleCtrlHandler(DWORD dwCtrlType);
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitConsole
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitConsole(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Reads the [Console] settings. If the renderer is enabled, it
+--              finds the terminal to write to, turns on virtual terminal
+--              processing, hides the terminal's cursor and starts the refresh
+--              timer. A headless program also selects its port and connects
+--              once the message loop is running.
+------------------------------------------------------------------------------*/
+VOID InitConsole(HWND hWnd) {
+    PWNDDATA    pwd     = NULL;
+    PCONSOLE    pCon    = NULL;
+    HANDLE      hOut    = NULL;
+    DWORD       dwMode  = 0;
+    UINT        uiPort  = 0;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pCon    = &pwd->console;
+
+    pCon->bEnabled      = ReadConfigInt(hWnd, TEXT("Console"),
+                                        TEXT("Enabled"), 0);
+    pCon->bHeadless     = ReadConfigInt(hWnd, TEXT("Console"),
+                                        TEXT("Headless"), 0);
+    pCon->dwInterval    = ReadConfigInt(hWnd, TEXT("Console"),
+                                        TEXT("Interval"), CONSOLE_INTERVAL);
+    uiPort              = ReadConfigInt(hWnd, TEXT("Console"),
+                                        TEXT("Port"), 0);
+    pCon->dwInterval    = max(pCon->dwInterval, USER_TIMER_MINIMUM);
+
+    if (pCon->bHeadless) {
+        pCon->bEnabled = TRUE;
+    }
+    if (!pCon->bEnabled) {
+        return;
+    }
+
+    // redirected output (e.g. from sshd) first, then a console
+    hOut = GetStdHandle(STD_OUTPUT_HANDLE);
+    if (hOut == NULL  ||  hOut == INVALID_HANDLE_VALUE) {
+        if (!AttachConsole(ATTACH_PARENT_PROCESS)  &&  !AllocConsole()) {
+            DISPLAY_ERROR("Error opening the console");
+            pCon->bEnabled = FALSE;
+            return;
+        }
+        hOut = CreateFile(TEXT("CONOUT$"), GENERIC_READ | GENERIC_WRITE,
+                          FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL);
+        if (hOut == INVALID_HANDLE_VALUE) {
+            DISPLAY_ERROR("Error opening the console");
+            pCon->bEnabled = FALSE;
+            return;
+        }
+    }
+    if (GetConsoleMode(hOut, &dwMode)) {
+        SetConsoleMode(hOut, dwMode | ENABLE_VIRTUAL_TERMINAL_PROCESSING
+                                    | DISABLE_NEWLINE_AUTO_RETURN);
+    }
+    pCon->hOut          = hOut;
+    pCon->bShadowValid  = FALSE;
+    hConsoleWnd         = hWnd;
+    SetConsoleCtrlHandler(ConsoleCtrlHandler, TRUE);
+
+    // hide the cursor; the whole screen is drawn on the first refresh
+    strcpy(ReserveOutput(pCon, 6), "\x1b[?25l");
+    pCon->dwOutLength += 6;
+    SetTimer(hWnd, IDT_CONSOLE, pCon->dwInterval, NULL);
+
+    if (pCon->bHeadless) {
+        if (uiPort >= 1  &&  uiPort <= NO_OF_PORTS) {
+            SelectPort(hWnd, IDM_COM1 + uiPort - 1);
+        }
+        PostMessage(hWnd, WM_COMMAND, IDM_CONNECT, 0);
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    RenderConsole
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Compares the screen under the display buffer's critical
+--              section, and writes to the terminal after leaving it.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID RenderConsole(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Called on the console timer. Sends the terminal the cells of
+--              the live screen that differ from the shadow, and updates the
+--              shadow to match. Lines that haven't changed are skipped with a
+--              memcmp() of each plane. If the screen has changed size, or a
+--              write failed, the terminal is cleared and drawn in full.
+------------------------------------------------------------------------------*/
+VOID RenderConsole(HWND hWnd) {
+    PWNDDATA    pwd         = NULL;
+    PCONSOLE    pCon        = NULL;
+    CHAR*       pcChars     = NULL;
+    BYTE*       pbFgColors  = NULL;
+    BYTE*       pbBgColors  = NULL;
+    UINT        uiCols      = 0;
+    UINT        uiCell      = 0;
+    UINT        uiShadow    = 0;
+    UINT        uiGap       = 0;
+    UINT        uiEnd       = 0;
+    UINT        i           = 0;
+    UINT        j           = 0;
+    UINT        k           = 0;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pCon    = &pwd->console;
+
+    if (!pCon->bEnabled  ||  pwd->displayBuf.pcChars == NULL) {
+        return;
+    }
+    EnterCriticalSection(&pwd->displayBuf.cs);
+    uiCols = CHARS_PER_LINE;
+
+    if (pCon->uiCols != uiCols  ||  pCon->uiRows != LINES_PER_SCRN) {
+        if (!ResizeShadow(pCon, uiCols, LINES_PER_SCRN)) {
+            LeaveCriticalSection(&pwd->displayBuf.cs);
+            return;
+        }
+    }
+    if (!pCon->bShadowValid) {
+        strcpy(ReserveOutput(pCon, 8), "\x1b[0m\x1b[2J");
+        pCon->dwOutLength   += 8;
+        pCon->cxCursor      = -1;
+        pCon->iFgColor      = -1;
+        pCon->iBgColor      = -1;
+        // no cell can match a null character, so every cell is sent
+        memset(pCon->pcShadow, 0, pCon->uiCols * pCon->uiRows);
+        pCon->bShadowValid  = TRUE;
+    }
+
+    for (i = 0; i < pCon->uiRows; i++) {
+        uiCell      = GetDisplayRow(&pwd->displayBuf, i) * uiCols;
+        uiShadow    = i * uiCols;
+        pcChars     = pwd->displayBuf.pcChars    + uiCell;
+        pbFgColors  = pwd->displayBuf.pbFgColors + uiCell;
+        pbBgColors  = pwd->displayBuf.pbBgColors + uiCell;
+
+        if (memcmp(pcChars, pCon->pcShadow + uiShadow, uiCols) == 0
+            &&  memcmp(pbFgColors, pCon->pbShadowFg + uiShadow, uiCols) == 0
+            &&  memcmp(pbBgColors, pCon->pbShadowBg + uiShadow, uiCols) == 0) {
+            continue;
+        }
+
+        for (j = 0; j < uiCols; j = uiEnd) {
+            // skip to the next changed cell
+            for ( ; j < uiCols; j++) {
+                if (pcChars[j]       != pCon->pcShadow[uiShadow + j]
+                ||  pbFgColors[j]    != pCon->pbShadowFg[uiShadow + j]
+                ||  pbBgColors[j]    != pCon->pbShadowBg[uiShadow + j]) {
+                    break;
+                }
+            }
+            if (j == uiCols) {
+                break;
+            }
+
+            // the run ends after CONSOLE_GAP unchanged cells in a row
+            uiEnd = j + 1;
+            uiGap = 0;
+            for (k = j + 1; k < uiCols  &&  uiGap <= CONSOLE_GAP; k++) {
+                if (pcChars[k]       != pCon->pcShadow[uiShadow + k]
+                ||  pbFgColors[k]    != pCon->pbShadowFg[uiShadow + k]
+                ||  pbBgColors[k]    != pCon->pbShadowBg[uiShadow + k]) {
+                    uiEnd = k + 1;
+                    uiGap = 0;
+                } else {
+                    uiGap++;
+                }
+            }
+            WriteRun(pCon, pcChars, pbFgColors, pbBgColors, j, i, uiEnd - j);
+
+            memcpy(pCon->pcShadow   + uiShadow + j, pcChars + j, uiEnd - j);
+            memcpy(pCon->pbShadowFg + uiShadow + j, pbFgColors + j, uiEnd - j);
+            memcpy(pCon->pbShadowBg + uiShadow + j, pbBgColors + j, uiEnd - j);
+        }
+    }
+    LeaveCriticalSection(&pwd->displayBuf.cs);
+    FlushConsole(pCon);
+    pCon->dwRefreshes++;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CloseConsole
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID CloseConsole(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Stops the refresh timer, and leaves the terminal with its
+--              default colours and a visible cursor below the screen.
+------------------------------------------------------------------------------*/
+VOID CloseConsole(HWND hWnd) {
+    PWNDDATA    pwd     = NULL;
+    PCONSOLE    pCon    = NULL;
+    CHAR*       pcOut   = NULL;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pCon    = &pwd->console;
+
+    if (!pCon->bEnabled) {
+        return;
+    }
+    KillTimer(hWnd, IDT_CONSOLE);
+    SetConsoleCtrlHandler(ConsoleCtrlHandler, FALSE);
+
+    pcOut = ReserveOutput(pCon, 32);
+    pCon->dwOutLength += sprintf(pcOut, "\x1b[%u;1H\x1b[0m\x1b[?25h\r\n",
+                                 pCon->uiRows);
+    FlushConsole(pCon);
+
+    free(pCon->pcShadow);
+    free(pCon->pbShadowFg);
+    free(pCon->pbShadowBg);
+    pCon->pcShadow      = NULL;
+    pCon->pbShadowFg    = NULL;
+    pCon->pbShadowBg    = NULL;
+    pCon->bEnabled      = FALSE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ResizeShadow
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL ResizeShadow(PCONSOLE pCon, UINT uiCols, UINT uiRows)
+--                          pCon    - the console renderer
+--                          uiCols  - the width of the screen
+--                          uiRows  - the height of the screen
+--
+-- RETURNS:     False if the shadow couldn't be allocated.
+--
+-- NOTES:
+--              Reallocates the shadow for a screen of a new size. The
+--              terminal is redrawn in full on the next refresh.
+------------------------------------------------------------------------------*/
+static BOOL ResizeShadow(PCONSOLE pCon, UINT uiCols, UINT uiRows) {
+    free(pCon->pcShadow);
+    free(pCon->pbShadowFg);
+    free(pCon->pbShadowBg);
+
+    pCon->pcShadow      = (CHAR*) calloc(uiCols, uiRows);
+    pCon->pbShadowFg    = (BYTE*) calloc(uiCols, uiRows);
+    pCon->pbShadowBg    = (BYTE*) calloc(uiCols, uiRows);
+    pCon->bShadowValid  = FALSE;
+
+    if (pCon->pcShadow == NULL  ||  pCon->pbShadowFg == NULL
+            ||  pCon->pbShadowBg == NULL) {
+        pCon->uiCols = 0;
+        pCon->uiRows = 0;
+        return FALSE;
+    }
+    pCon->uiCols = uiCols;
+    pCon->uiRows = uiRows;
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    WriteRun
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID WriteRun(PCONSOLE pCon, CHAR* pcChars, BYTE* pbFgColors,
+--                            BYTE* pbBgColors, UINT cxCoord, UINT cyCoord,
+--                            UINT uiCount)
+--                          pCon        - the console renderer
+--                          pcChars     - the line's characters
+--                          pbFgColors  - the line's foreground colours
+--                          pbBgColors  - the line's background colours
+--                          cxCoord     - the first cell of the run
+--                                        - (0,0) origin
+--                          cyCoord     - the line of the run - (0,0) origin
+--                          uiCount     - the number of cells in the run
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Adds a run of cells to the output. The display's colours are
+--              the 16 ANSI colours in order, so 0-7 map to SGR 30-37/40-47 and
+--              8-15 to the bright 90-97/100-107. Control characters are sent
+--              as spaces. After the last column the terminal's cursor may or
+--              may not have wrapped, so its position is forgotten.
+------------------------------------------------------------------------------*/
+static VOID WriteRun(PCONSOLE pCon, CHAR* pcChars, BYTE* pbFgColors,
+                     BYTE* pbBgColors, UINT cxCoord, UINT cyCoord,
+                     UINT uiCount) {
+    CHAR*   pcOut   = NULL;
+    BYTE    bChar   = 0;
+    UINT    i       = 0;
+
+    if (pCon->cxCursor != (INT) cxCoord  ||  pCon->cyCursor != (INT) cyCoord) {
+        pcOut = ReserveOutput(pCon, 16);
+        pCon->dwOutLength += sprintf(pcOut, "\x1b[%u;%uH",
+                                     cyCoord + 1, cxCoord + 1);
+    }
+
+    for (i = cxCoord; i < cxCoord + uiCount; i++) {
+        pcOut = ReserveOutput(pCon, 16);
+
+        if (pbFgColors[i] != pCon->iFgColor
+                ||  pbBgColors[i] != pCon->iBgColor) {
+            pCon->iFgColor = pbFgColors[i] & 0x0F;
+            pCon->iBgColor = pbBgColors[i] & 0x0F;
+            pcOut += sprintf(pcOut, "\x1b[%d;%dm",
+                        pCon->iFgColor < 8 ? 30 + pCon->iFgColor
+                                           : 90 + pCon->iFgColor - 8,
+                        pCon->iBgColor < 8 ? 40 + pCon->iBgColor
+                                           : 100 + pCon->iBgColor - 8);
+        }
+        bChar = (BYTE) pcChars[i];
+        *pcOut++ = (bChar < 0x20  ||  bChar >= 0x7F) ? ' ' : (CHAR) bChar;
+        pCon->dwOutLength = (DWORD) (pcOut - pCon->pcOut);
+    }
+
+    pCon->cxCursor = cxCoord + uiCount;
+    pCon->cyCursor = cyCoord;
+    if (pCon->cxCursor >= (INT) pCon->uiCols) {
+        pCon->cxCursor = -1;
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ReserveOutput
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   CHAR* ReserveOutput(PCONSOLE pCon, DWORD dwBytes)
+--                          pCon    - the console renderer
+--                          dwBytes - the most that is about to be added
+--
+-- RETURNS:     Where to add the bytes. The caller adds what it used to
+--              dwOutLength.
+--
+-- NOTES:
+--              Flushes the output first if there isn't room for dwBytes.
+------------------------------------------------------------------------------*/
+static CHAR* ReserveOutput(PCONSOLE pCon, DWORD dwBytes) {
+    if (pCon->dwOutLength + dwBytes > CONSOLE_BUFSIZE) {
+        FlushConsole(pCon);
+    }
+    return pCon->pcOut + pCon->dwOutLength;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FlushConsole
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID FlushConsole(PCONSOLE pCon)
+--                          pCon - the console renderer
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Writes the output to the terminal. If the write fails (e.g.
+--              the SSH session went away) the output is dropped, and the
+--              terminal is redrawn in full on the next refresh.
+------------------------------------------------------------------------------*/
+static VOID FlushConsole(PCONSOLE pCon) {
+    DWORD dwWritten = 0;
+
+    if (pCon->dwOutLength == 0) {
+        return;
+    }
+    if (!WriteFile(pCon->hOut, pCon->pcOut, pCon->dwOutLength, &dwWritten,
+                   NULL)) {
+        pCon->bShadowValid = FALSE;
+    }
+    pCon->dwBytesWritten    += dwWritten;
+    pCon->dwOutLength       = 0;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ConsoleCtrlHandler
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL WINAPI ConsoleCtrlHandler(DWORD dwCtrlType)
+--                          dwCtrlType - the kind of signal
+--
+-- RETURNS:     True, since the signal is always handled.
+--
+-- NOTES:
+--              Runs on a thread of its own when Ctrl+C is pressed or the
+--              console is closed. It asks the window to close, so that the
+--              program shuts down the same way as from the menu.
+------------------------------------------------------------------------------*/
+static BOOL WINAPI ConsoleCtrlHandler(DWORD dwCtrlType) {
+    PostMessage(hConsoleWnd, WM_CLOSE, 0, 0);
+    return TRUE;
+}
@@ -0,0 +1,37 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <Windows.h>
+
+#define IDT_CONSOLE         2
+#define CONSOLE_INTERVAL    100     // ms between refreshes
+#define CONSOLE_BUFSIZE     8192    // bytes written to the terminal at a time
+#define CONSOLE_GAP         4       // unchanged cells worth rewriting rather
+                                    // than moving the cursor past them
+
+typedef struct console {
+    BOOL    bEnabled;
+    BOOL    bHeadless;
+    DWORD   dwInterval;
+    HANDLE  hOut;
+    CHAR*   pcShadow;               // the cells the terminal is showing
+    BYTE*   pbShadowFg;
+    BYTE*   pbShadowBg;
+    UINT    uiCols;
+    UINT    uiRows;
+    BOOL    bShadowValid;
+    INT     cxCursor;               // where the terminal's cursor is, or -1
+    INT     cyCursor;
+    INT     iFgColor;               // the terminal's colours, or -1
+    INT     iBgColor;
+    CHAR    pcOut[CONSOLE_BUFSIZE];
+    DWORD   dwOutLength;
+    DWORD   dwRefreshes;
+    DWORD   dwBytesWritten;
+} CONSOLE, *PCONSOLE;
+
+VOID    InitConsole(HWND hWnd);
+VOID    RenderConsole(HWND hWnd);
+VOID    CloseConsole(HWND hWnd);
+
+#endif
@@ -0,0 +1,528 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Correlate.c - Contains the correlator, which follows tags
+--                                from one reader's zone to another's.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    InitCorrelator(HWND);
+--              VOID    CorrelateTag(PTAGREAD);
+--              VOID    AdvanceCorrelator(VOID);
+--              VOID    ShowCorrelator(HWND);
+--              VOID    CloseCorrelator(HWND);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- Each reader covers a zone, numbered in the [Correlate] section by its COM
+-- port (Zone3=1 puts the reader on COM3 in zone 1). Readers in the same zone
+-- act as one. A tag that is read in one zone and then, within Window ms, in
+-- another, has moved between them: towards a higher numbered zone is "in",
+-- and towards a lower one is "out". So a doorway needs a reader outside in
+-- zone 1 and one inside in zone 2.
+--
+-- The readers are decoded on different workers, so their reads arrive out of
+-- order with each other, though each reader's are in order. Every read is
+-- queued on its reader's stream, and the streams are merged by the time the
+-- frame was complete. A read is only merged once the watermark has passed it:
+-- the time before which every stream is known to be complete. A stream is
+-- complete up to its last read, and an idle one up to Lateness ms ago, which
+-- is the longest a read is expected to take to get here. A read that arrives
+-- behind the watermark anyway is counted as late and dropped. There are only
+-- a few streams, so the merge just looks at the head of each.
+--
+-- Each tag being followed has a small state machine: the zone it is in, and
+-- the zone it may be moving to. A transition needs Confirm reads in the new
+-- zone, so that a tag sitting where two zones overlap doesn't flap between
+-- them. States are kept in a fixed table, found by hashing the UID and
+-- looking at CORRELATE_PROBES slots; a tag not read for Window ms has left,
+-- and its slot is reused. If every slot is in use, the oldest is evicted. A
+-- full stream forces the watermark up to its oldest read. So memory is fixed
+-- however many tags pass.
+--
+-- Zone events are shown with View > Zone Events, and appended to Log, if it
+-- is set. The times are those of the performance counter, in ms, as in the
+-- latency trace.
+--
+--      [Correlate]
+--      Zone3=1
+--      Zone4=2
+--      Window=2000
+--      Lateness=250
+--      Confirm=2
+--      Log=zones.log
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+static CORRELATOR   correlator      = {0};
+static BOOL         bInitialized    = FALSE;
+
+static VOID         ReleaseReads(LONGLONG llWatermark);
+static VOID         UpdateTagState(PCORRREAD pRead, BYTE bZone);
+static PTAGSTATE    FindTagState(ULONGLONG ullUid, LONGLONG llTime);
+static VOID         AddZoneEvent(PTAGSTATE pState, LONGLONG llTime,
+                                 BYTE bZone);
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitCorrelator
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitCorrelator(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Reads the [Correlate] section, if this is the first call, and
+--              starts the window's timer, which moves the watermark on while
+--              the readers are idle. Every reader window can call it. Must be
+--              called after InitConfig().
+------------------------------------------------------------------------------*/
+VOID InitCorrelator(HWND hWnd) {
+    PCORRELATOR     pCorr               = &correlator;
+    LARGE_INTEGER   li                  = {0};
+    TCHAR           szKey[8]            = {0};
+    TCHAR           szFile[MAX_PATH]    = {0};
+    DWORD           i                   = 0;
+
+    if (!bInitialized) {
+        bInitialized = TRUE;
+        InitializeCriticalSection(&pCorr->cs);
+        pCorr->hLog = INVALID_HANDLE_VALUE;
+
+        for (i = 1; i < CORRELATE_READERS; i++) {
+            wsprintf(szKey, TEXT("Zone%u"), i);
+            pCorr->streams[i].bZone = (BYTE) ReadConfigInt(hWnd,
+                                            TEXT("Correlate"), szKey, 0);
+            if (pCorr->streams[i].bZone != 0) {
+                pCorr->bEnabled = TRUE;
+            }
+        }
+        if (!pCorr->bEnabled) {
+            return;
+        }
+
+        QueryPerformanceFrequency(&li);
+        pCorr->llWindow     = li.QuadPart * ReadConfigInt(hWnd,
+                                TEXT("Correlate"), TEXT("Window"),
+                                CORRELATE_WINDOW) / 1000;
+        pCorr->dwLateness   = max(10, ReadConfigInt(hWnd, TEXT("Correlate"),
+                                TEXT("Lateness"), CORRELATE_LATENESS));
+        pCorr->llLateness   = li.QuadPart * pCorr->dwLateness / 1000;
+        pCorr->dwConfirm    = max(1, ReadConfigInt(hWnd, TEXT("Correlate"),
+                                TEXT("Confirm"), CORRELATE_CONFIRM));
+
+        if (ReadConfigPath(hWnd, TEXT("Correlate"), TEXT("Log"), szFile) > 0) {
+            pCorr->hLog = CreateFile(szFile, FILE_APPEND_DATA, FILE_SHARE_READ,
+                                     NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL,
+                                     NULL);
+            if (pCorr->hLog == INVALID_HANDLE_VALUE) {
+                DISPLAY_ERROR("Could not open the zone event log");
+            }
+        }
+    }
+    if (pCorr->bEnabled) {
+        SetTimer(hWnd, IDT_CORRELATE, pCorr->dwLateness, NULL);
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CorrelateTag
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID CorrelateTag(PTAGREAD pRead)
+--                          pRead - a decoded tag, with its framed time set
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Queues the read on its reader's stream, and merges every read
+--              the watermark has now passed. Called from any reader's strand.
+------------------------------------------------------------------------------*/
+VOID CorrelateTag(PTAGREAD pRead) {
+    PCORRELATOR pCorr   = &correlator;
+    PCORRSTREAM pStream = NULL;
+    PCORRREAD   pQueued = NULL;
+
+    if (!pCorr->bEnabled  ||  pRead->dwReader >= CORRELATE_READERS
+            ||  pCorr->streams[pRead->dwReader].bZone == 0) {
+        return;
+    }
+    pStream = &pCorr->streams[pRead->dwReader];
+
+    EnterCriticalSection(&pCorr->cs);
+    if (pRead->llFramed < pCorr->llWatermark) {
+        pCorr->dwLate++;
+        LeaveCriticalSection(&pCorr->cs);
+        return;
+    }
+    if (pStream->dwCount == CORRELATE_QUEUE) {
+        ReleaseReads(pStream->reads[pStream->dwHead].llTime);
+    }
+    pQueued = &pStream->reads[(pStream->dwHead + pStream->dwCount++)
+                              % CORRELATE_QUEUE];
+    pQueued->ullUid = PackUid(pRead);
+    pQueued->llTime = pRead->llFramed;
+    pStream->llLast = pRead->llFramed;
+    LeaveCriticalSection(&pCorr->cs);
+
+    AdvanceCorrelator();
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    AdvanceCorrelator
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID AdvanceCorrelator(VOID)
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Moves the watermark up to the earliest time any stream may
+--              still add a read at, and merges the reads before it. Called
+--              after each read, and on the IDT_CORRELATE timer.
+------------------------------------------------------------------------------*/
+VOID AdvanceCorrelator(VOID) {
+    PCORRELATOR pCorr       = &correlator;
+    LONGLONG    llIdle      = 0;
+    LONGLONG    llWatermark = MAXLONGLONG;
+    DWORD       i           = 0;
+
+    if (!pCorr->bEnabled) {
+        return;
+    }
+    llIdle = TraceNow() - pCorr->llLateness;
+
+    EnterCriticalSection(&pCorr->cs);
+    for (i = 0; i < CORRELATE_READERS; i++) {
+        if (pCorr->streams[i].bZone != 0) {
+            llWatermark = min(llWatermark,
+                              max(pCorr->streams[i].llLast, llIdle));
+        }
+    }
+    ReleaseReads(llWatermark);
+    LeaveCriticalSection(&pCorr->cs);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ShowCorrelator
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID ShowCorrelator(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Shows the most recent zone events, newest first, and how many
+--              reads were late and tags evicted.
+------------------------------------------------------------------------------*/
+VOID ShowCorrelator(HWND hWnd) {
+    PCORRELATOR pCorr                       = &correlator;
+    ZONEEVENT   recent[CORRELATE_RECENT]    = {0};
+    TCHAR       szText[2048]                = {0};
+    DWORD       dwLength                    = 0;
+    DWORD       dwEvents                    = 0;
+    DWORD       dwLate                      = 0;
+    DWORD       dwEvicted                   = 0;
+    PZONEEVENT  pEvent                      = NULL;
+    DWORD       i                           = 0;
+
+    if (!pCorr->bEnabled) {
+        MessageBox(hWnd, TEXT("No readers are in a zone. Set them in the ")
+                   TEXT("[Correlate] section of the configuration file."),
+                   TEXT("Zone Events"), MB_OK);
+        return;
+    }
+    EnterCriticalSection(&pCorr->cs);
+    memcpy(recent, pCorr->recent, sizeof(recent));
+    dwEvents    = pCorr->dwEvents;
+    dwLate      = pCorr->dwLate;
+    dwEvicted   = pCorr->dwEvicted;
+    LeaveCriticalSection(&pCorr->cs);
+
+    dwLength = wsprintf(szText, TEXT("%u events, %u late reads, ")
+                        TEXT("%u tags evicted\n\n"),
+                        dwEvents, dwLate, dwEvicted);
+    for (i = 0; i < min(dwEvents, CORRELATE_RECENT); i++) {
+        pEvent = &recent[(dwEvents - 1 - i) % CORRELATE_RECENT];
+        dwLength += wsprintf(szText + dwLength,
+                             TEXT("%08X%08X\t%s\tzone %u to %u\n"),
+                             (DWORD) (pEvent->ullUid >> 32),
+                             (DWORD) pEvent->ullUid,
+                             (pEvent->bDirection == DIRECTION_IN)
+                                ? TEXT("IN") : TEXT("OUT"),
+                             pEvent->bFrom, pEvent->bTo);
+    }
+    MessageBox(hWnd, szText, TEXT("Zone Events"), MB_OK);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CloseCorrelator
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID CloseCorrelator(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Merges every queued read, so that their events are logged, and
+--              closes the log. The decode workers must have stopped.
+------------------------------------------------------------------------------*/
+VOID CloseCorrelator(HWND hWnd) {
+    PCORRELATOR pCorr = &correlator;
+
+    if (!bInitialized) {
+        return;
+    }
+    KillTimer(hWnd, IDT_CORRELATE);
+    if (pCorr->bEnabled) {
+        EnterCriticalSection(&pCorr->cs);
+        ReleaseReads(MAXLONGLONG);
+        LeaveCriticalSection(&pCorr->cs);
+    }
+    if (pCorr->hLog != INVALID_HANDLE_VALUE) {
+        CloseHandle(pCorr->hLog);
+        pCorr->hLog = INVALID_HANDLE_VALUE;
+    }
+    DeleteCriticalSection(&pCorr->cs);
+    pCorr->bEnabled = FALSE;
+    bInitialized    = FALSE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ReleaseReads
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID ReleaseReads(LONGLONG llWatermark)
+--                          llWatermark - the new watermark; it is never moved
+--                                        back
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Merges the streams, earliest read first, up to the watermark.
+--              The caller holds the lock.
+------------------------------------------------------------------------------*/
+static VOID ReleaseReads(LONGLONG llWatermark) {
+    PCORRELATOR pCorr   = &correlator;
+    PCORRSTREAM pStream = NULL;
+    PCORRSTREAM pNext   = NULL;
+    DWORD       i       = 0;
+
+    pCorr->llWatermark = max(pCorr->llWatermark, llWatermark);
+
+    for (;;) {
+        pNext = NULL;
+        for (i = 0; i < CORRELATE_READERS; i++) {
+            pStream = &pCorr->streams[i];
+            if (pStream->dwCount > 0  &&  (pNext == NULL
+                    ||  pStream->reads[pStream->dwHead].llTime
+                        < pNext->reads[pNext->dwHead].llTime)) {
+                pNext = pStream;
+            }
+        }
+        if (pNext == NULL
+                ||  pNext->reads[pNext->dwHead].llTime > pCorr->llWatermark) {
+            return;
+        }
+        UpdateTagState(&pNext->reads[pNext->dwHead], pNext->bZone);
+        pNext->dwHead = (pNext->dwHead + 1) % CORRELATE_QUEUE;
+        pNext->dwCount--;
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    UpdateTagState
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID UpdateTagState(PCORRREAD pRead, BYTE bZone)
+--                          pRead   - the next read, in time order
+--                          bZone   - the zone it was read in
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Steps the tag's state machine. A tag not followed yet, or not
+--              read for a window, starts out in the zone it was read in. A read
+--              in its own zone cancels a transition in progress.
+------------------------------------------------------------------------------*/
+static VOID UpdateTagState(PCORRREAD pRead, BYTE bZone) {
+    PCORRELATOR pCorr   = &correlator;
+    PTAGSTATE   pState  = NULL;
+
+    pState = FindTagState(pRead->ullUid, pRead->llTime);
+
+    if (pState->llSeen == 0  ||  pState->ullUid != pRead->ullUid
+            ||  pRead->llTime - pState->llSeen > pCorr->llWindow) {
+        pState->ullUid      = pRead->ullUid;
+        pState->bZone       = bZone;
+        pState->bCandidate  = 0;
+        pState->bHits       = 0;
+    } else if (bZone == pState->bZone) {
+        pState->bCandidate  = 0;
+        pState->bHits       = 0;
+    } else {
+        if (bZone != pState->bCandidate) {
+            pState->bCandidate  = bZone;
+            pState->bHits       = 0;
+        }
+        if (++pState->bHits >= pCorr->dwConfirm) {
+            AddZoneEvent(pState, pRead->llTime, bZone);
+            pState->bZone       = bZone;
+            pState->bCandidate  = 0;
+            pState->bHits       = 0;
+        }
+    }
+    pState->llSeen = pRead->llTime;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FindTagState
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static PTAGSTATE FindTagState(ULONGLONG ullUid,
+--                                            LONGLONG llTime)
+--                          ullUid  - the packed UID
+--                          llTime  - the time of the read
+--
+-- RETURNS:     The tag's state, or, if it isn't followed, the slot it should
+--              take: an unused one, one whose tag has left, or the oldest.
+------------------------------------------------------------------------------*/
+static PTAGSTATE FindTagState(ULONGLONG ullUid, LONGLONG llTime) {
+    PCORRELATOR pCorr   = &correlator;
+    PTAGSTATE   pState  = NULL;
+    PTAGSTATE   pFree   = NULL;
+    DWORD       dwSlot  = 0;
+    DWORD       i       = 0;
+
+    dwSlot = (DWORD) HashUid(ullUid);
+    for (i = 0; i < CORRELATE_PROBES; i++) {
+        pState = &pCorr->tags[(dwSlot + i) & (CORRELATE_TAGS - 1)];
+        if (pState->llSeen != 0  &&  pState->ullUid == ullUid) {
+            return pState;
+        }
+        if (pFree == NULL  ||  pState->llSeen < pFree->llSeen) {
+            pFree = pState;
+        }
+    }
+    if (pFree->llSeen != 0  &&  llTime - pFree->llSeen <= pCorr->llWindow) {
+        pCorr->dwEvicted++;
+    }
+    return pFree;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    AddZoneEvent
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID AddZoneEvent(PTAGSTATE pState, LONGLONG llTime,
+--                                       BYTE bZone)
+--                          pState  - the tag, still in the zone it left
+--                          llTime  - the read that confirmed the move
+--                          bZone   - the zone it moved to
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Keeps the event for display, and appends it to the log.
+------------------------------------------------------------------------------*/
+static VOID AddZoneEvent(PTAGSTATE pState, LONGLONG llTime, BYTE bZone) {
+    PCORRELATOR     pCorr       = &correlator;
+    PZONEEVENT      pEvent      = NULL;
+    LARGE_INTEGER   li          = {0};
+    CHAR            pcLine[80]  = {0};
+    DWORD           dwLength    = 0;
+    DWORD           dwWritten   = 0;
+
+    pEvent = &pCorr->recent[pCorr->dwEvents++ % CORRELATE_RECENT];
+    pEvent->ullUid      = pState->ullUid;
+    pEvent->llTime      = llTime;
+    pEvent->bFrom       = pState->bZone;
+    pEvent->bTo         = bZone;
+    pEvent->bDirection  = (bZone > pState->bZone) ? DIRECTION_IN
+                                                  : DIRECTION_OUT;
+
+    if (pCorr->hLog == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    QueryPerformanceFrequency(&li);
+    dwLength = sprintf(pcLine, "%I64d %08X%08X %s %u %u\r\n",
+                       llTime * 1000 / li.QuadPart,
+                       (DWORD) (pEvent->ullUid >> 32), (DWORD) pEvent->ullUid,
+                       (pEvent->bDirection == DIRECTION_IN) ? "IN" : "OUT",
+                       pEvent->bFrom, pEvent->bTo);
+    WriteFile(pCorr->hLog, pcLine, dwLength, &dwWritten, NULL);
+}
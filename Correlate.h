@@ -0,0 +1,74 @@
+#ifndef CORRELATE_H
+#define CORRELATE_H
+
+#include <Windows.h>
+#include "Tag.h"
+
+#define IDT_CORRELATE       4
+#define CORRELATE_READERS   10      // readers are numbered by their COM port
+#define CORRELATE_QUEUE     1024    // reads waiting for the watermark, each
+#define CORRELATE_TAGS      4096    // tags being followed, a power of two
+#define CORRELATE_PROBES    16      // slots looked at for a tag
+#define CORRELATE_RECENT    32      // zone events kept for display
+#define CORRELATE_WINDOW    2000    // ms a tag may take between zones
+#define CORRELATE_LATENESS  250     // ms a read may take to reach the merge
+#define CORRELATE_CONFIRM   2       // reads in the new zone for a transition
+
+#define DIRECTION_IN        1       // to a higher numbered zone
+#define DIRECTION_OUT       2
+
+typedef struct corrRead {
+    ULONGLONG   ullUid;
+    LONGLONG    llTime;
+} CORRREAD, *PCORRREAD;
+
+// One reader's reads, in the order they were framed.
+typedef struct corrStream {
+    BYTE        bZone;          // 0 if the reader isn't correlated
+    CORRREAD    reads[CORRELATE_QUEUE];
+    DWORD       dwHead;
+    DWORD       dwCount;
+    LONGLONG    llLast;         // the last read added
+} CORRSTREAM, *PCORRSTREAM;
+
+// A tag is in bZone until it has been read bHits times in bCandidate.
+typedef struct tagState {
+    ULONGLONG   ullUid;
+    LONGLONG    llSeen;         // the last read in any zone, 0 if unused
+    BYTE        bZone;
+    BYTE        bCandidate;
+    BYTE        bHits;
+} TAGSTATE, *PTAGSTATE;
+
+typedef struct zoneEvent {
+    ULONGLONG   ullUid;
+    LONGLONG    llTime;
+    BYTE        bFrom;
+    BYTE        bTo;
+    BYTE        bDirection;
+} ZONEEVENT, *PZONEEVENT;
+
+typedef struct correlator {
+    CRITICAL_SECTION    cs;
+    BOOL                bEnabled;
+    LONGLONG            llWindow;       // in performance counter ticks
+    LONGLONG            llLateness;
+    DWORD               dwLateness;     // in ms, for the timer
+    DWORD               dwConfirm;
+    LONGLONG            llWatermark;    // every read before it is merged
+    HANDLE              hLog;
+    CORRSTREAM          streams[CORRELATE_READERS];
+    TAGSTATE            tags[CORRELATE_TAGS];
+    ZONEEVENT           recent[CORRELATE_RECENT];
+    DWORD               dwEvents;
+    DWORD               dwLate;
+    DWORD               dwEvicted;
+} CORRELATOR, *PCORRELATOR;
+
+VOID    InitCorrelator(HWND hWnd);
+VOID    CorrelateTag(PTAGREAD pRead);
+VOID    AdvanceCorrelator(VOID);
+VOID    ShowCorrelator(HWND hWnd);
+VOID    CloseCorrelator(HWND hWnd);
+
+#endif
@@ -0,0 +1,736 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Display.c - Contains the display buffer's storage, its
+--                              scrollback and the viewport onto it.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              BOOL    InitDisplay(HWND);
+--              VOID    FreeDisplay(HWND);
+--              VOID    ResizeDisplay(HWND, INT, INT);
+--              VOID    OnVScroll(HWND, WPARAM);
+--              VOID    OnMouseWheel(HWND, WPARAM);
+--              VOID    UpdateViewport(HWND);
+--              UINT    GetDisplayRow(PDISPLAYBUF, INT);
+--              BOOL    AdvanceDisplay(PDISPLAYBUF, UINT);
+--              VOID    FillCells(PDISPLAYBUF, UINT, UINT, UINT);
+--              VOID    MoveRows(PDISPLAYBUF, INT, INT, UINT);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- The display buffer is a ring of lines, stored as four planes (characters,
+-- foreground, background and style). The screen is the uiRows lines starting
+-- at ring row uiFirst, and the lines before it are the scrollback. When the
+-- whole bottom of the screen scrolls, the top line isn't copied anywhere; the
+-- screen just starts one ring row later, and the line it leaves behind becomes
+-- the newest line of scrollback. Once the ring is full the oldest line of
+-- scrollback is reused as the new bottom line.
+--
+-- The ring's address space is reserved when the program starts, but it is
+-- only committed COMMIT_ROWS lines at a time as lines are first used, so the
+-- memory used grows with the scrollback actually kept. The screen follows the
+-- height of the window, and the viewport (the vertical scroll bar and the
+-- mouse wheel) can be moved back through the scrollback; Paint() only draws
+-- the lines it shows.
+--
+-- The lines are written by the reader's decode worker, while the UI thread
+-- paints, resizes and scrolls, so both hold the buffer's critical section
+-- while they use it. The critical section lasts as long as the window. The
+-- sizes are set in the [Display] section of the configuration file:
+--
+--      [Display]
+--      Columns=80
+--      Rows=24
+--      Scrollback=200000
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+#define PLANES 4
+
+static BYTE*    GetPlane(PDISPLAYBUF pDisplay, INT iPlane);
+static BOOL     CommitRow(PDISPLAYBUF pDisplay, UINT uiRow);
+static VOID     FillSpan(PDISPLAYBUF pDisplay, UINT uiCell, UINT uiCount);
+static VOID     ScrollViewport(HWND hWnd, INT iView);
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitDisplay
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Creates the buffer's critical section.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL InitDisplay(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     False if the display buffer couldn't be allocated.
+--
+-- NOTES:
+--              Reads the [Display] settings, reserves the ring and commits
+--              the lines of the screen. The ring has room for the scrollback
+--              plus a screen as tall as the desktop, so that making the
+--              window bigger doesn't cost any scrollback. If that much
+--              address space isn't available, less scrollback is kept. The
+--              font metrics must already be set.
+------------------------------------------------------------------------------*/
+BOOL InitDisplay(HWND hWnd) {
+    PWNDDATA    pwd             = NULL;
+    PDISPLAYBUF pDisplay        = NULL;
+    BYTE*       pbRing          = NULL;
+    UINT        uiScrollback    = 0;
+    UINT        uiMaxRows       = 0;
+    SIZE_T      cbPlane         = 0;
+    pwd         = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pDisplay    = &pwd->displayBuf;
+
+    InitializeCriticalSection(&pDisplay->cs);
+
+    pDisplay->uiCols    = ReadConfigInt(hWnd, TEXT("Display"),
+                                        TEXT("Columns"), DISPLAY_COLUMNS);
+    pDisplay->uiRows    = ReadConfigInt(hWnd, TEXT("Display"),
+                                        TEXT("Rows"), DISPLAY_ROWS);
+    uiScrollback        = ReadConfigInt(hWnd, TEXT("Display"),
+                                        TEXT("Scrollback"), DISPLAY_SCROLLBACK);
+
+    pDisplay->uiCols    = max(pDisplay->uiCols, MIN_DISPLAY_COLUMNS);
+    pDisplay->uiCols    = min(pDisplay->uiCols, MAX_DISPLAY_COLUMNS);
+    pDisplay->uiRows    = max(pDisplay->uiRows, MIN_DISPLAY_ROWS);
+    uiScrollback        = min(uiScrollback, MAX_SCROLLBACK);
+    uiMaxRows           = GetSystemMetrics(SM_CYVIRTUALSCREEN)
+                        / max(pDisplay->cyChar, 1) + 1;
+    uiMaxRows           = max(uiMaxRows, pDisplay->uiRows);
+
+    for (;;) {
+        pDisplay->uiCapacity = uiScrollback + uiMaxRows;
+        cbPlane = (SIZE_T) pDisplay->uiCapacity * pDisplay->uiCols;
+        pbRing  = (BYTE*) VirtualAlloc(NULL, cbPlane * PLANES, MEM_RESERVE,
+                                       PAGE_READWRITE);
+        if (pbRing != NULL  ||  uiScrollback == 0) {
+            break;
+        }
+        uiScrollback /= 2;
+    }
+    if (pbRing == NULL) {
+        return FALSE;
+    }
+    pDisplay->pcChars       = (CHAR*) pbRing;
+    pDisplay->pbFgColors    = pbRing + cbPlane;
+    pDisplay->pbBgColors    = pbRing + cbPlane * 2;
+    pDisplay->pbStyles      = pbRing + cbPlane * 3;
+    pDisplay->pbScratch     = (BYTE*) calloc(PLANES, pDisplay->uiCols);
+    pDisplay->uiCommitted   = 0;
+    pDisplay->uiFirst       = 0;
+    pDisplay->uiKept        = 0;
+    pDisplay->uiView        = 0;
+
+    if (pDisplay->pbScratch == NULL
+            ||  !CommitRow(pDisplay, pDisplay->uiRows - 1)) {
+        FreeDisplay(hWnd);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FreeDisplay
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID FreeDisplay(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Releases the ring and the scratch row.
+------------------------------------------------------------------------------*/
+VOID FreeDisplay(HWND hWnd) {
+    PWNDDATA    pwd         = NULL;
+    PDISPLAYBUF pDisplay    = NULL;
+    pwd         = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pDisplay    = &pwd->displayBuf;
+
+    if (pDisplay->pcChars != NULL) {
+        VirtualFree(pDisplay->pcChars, 0, MEM_RELEASE);
+    }
+    free(pDisplay->pbScratch);
+    pDisplay->pcChars       = NULL;
+    pDisplay->pbFgColors    = NULL;
+    pDisplay->pbBgColors    = NULL;
+    pDisplay->pbStyles      = NULL;
+    pDisplay->pbScratch     = NULL;
+    pDisplay->uiCommitted   = 0;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ResizeDisplay
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Holds the buffer's critical section, since a decode worker
+--              may be writing to the screen.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID ResizeDisplay(HWND hWnd, INT cxClient, INT cyClient)
+--                          hWnd        - the handle to the window
+--                          cxClient    - the width of the client area
+--                          cyClient    - the height of the client area
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Called on WM_SIZE. Fits the number of lines on the screen to
+--              the height of the window. The top of the screen stays where it
+--              is: new lines are added blank at the bottom, and lines are
+--              dropped from the bottom when the window shrinks. A scroll
+--              region that reached the bottom of the screen still does. The
+--              width of a line doesn't change.
+------------------------------------------------------------------------------*/
+VOID ResizeDisplay(HWND hWnd, INT cxClient, INT cyClient) {
+    PWNDDATA    pwd         = NULL;
+    PDISPLAYBUF pDisplay    = NULL;
+    INT         iRows       = 0;
+    UINT        uiOldRows   = 0;
+    UINT        i           = 0;
+    pwd         = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pDisplay    = &pwd->displayBuf;
+
+    if (pDisplay->pcChars == NULL  ||  CHAR_HEIGHT == 0) {
+        return;
+    }
+    EnterCriticalSection(&pDisplay->cs);
+
+    iRows = (cyClient - PADDING * 2) / (INT) CHAR_HEIGHT;
+    iRows = max(iRows, MIN_DISPLAY_ROWS);
+    iRows = min(iRows, (INT) pDisplay->uiCapacity);
+    uiOldRows = pDisplay->uiRows;
+
+    if ((UINT) iRows > uiOldRows) {
+        for (i = uiOldRows; i < (UINT) iRows; i++) {
+            if (!CommitRow(pDisplay, GetDisplayRow(pDisplay, i))) {
+                break;
+            }
+        }
+        iRows = i;
+        // the new lines may take the ring rows of the oldest scrollback
+        pDisplay->uiKept = min(pDisplay->uiKept,
+                               pDisplay->uiCapacity - (UINT) iRows);
+        FillCells(pDisplay, 0, uiOldRows,
+                  ((UINT) iRows - uiOldRows) * pDisplay->uiCols);
+    }
+    pDisplay->uiRows = iRows;
+
+    if (WINDOW_BOTTOM == (INT) uiOldRows - 1  ||  WINDOW_BOTTOM >= iRows) {
+        WINDOW_BOTTOM = iRows - 1;
+    }
+    if (WINDOW_TOP >= WINDOW_BOTTOM) {
+        WINDOW_TOP = 0;
+    }
+    if (Y >= iRows) {
+        Y = iRows - 1;
+    }
+    pDisplay->uiView = min(pDisplay->uiView, pDisplay->uiKept);
+    UpdateViewport(hWnd);
+
+    LeaveCriticalSection(&pDisplay->cs);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    OnVScroll
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID OnVScroll(HWND hWnd, WPARAM wParam)
+--                          hWnd    - the handle to the window
+--                          wParam  - the WM_VSCROLL request
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Moves the viewport for the vertical scroll bar. The thumb's
+--              position is read with GetScrollInfo(), since the 16 bits in
+--              wParam can't hold a position in a long scrollback.
+------------------------------------------------------------------------------*/
+VOID OnVScroll(HWND hWnd, WPARAM wParam) {
+    PWNDDATA    pwd     = NULL;
+    SCROLLINFO  si      = {0};
+    INT         iView   = 0;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    iView = pwd->displayBuf.uiView;
+
+    switch (LOWORD(wParam)) {
+        case SB_LINEUP:     iView++;                                break;
+        case SB_LINEDOWN:   iView--;                                break;
+        case SB_PAGEUP:     iView += pwd->displayBuf.uiRows;        break;
+        case SB_PAGEDOWN:   iView -= pwd->displayBuf.uiRows;        break;
+        case SB_TOP:        iView = pwd->displayBuf.uiKept;         break;
+        case SB_BOTTOM:     iView = 0;                              break;
+
+        case SB_THUMBTRACK:
+        case SB_THUMBPOSITION:
+            si.cbSize   = sizeof(SCROLLINFO);
+            si.fMask    = SIF_TRACKPOS;
+            GetScrollInfo(hWnd, SB_VERT, &si);
+            iView = pwd->displayBuf.uiKept - si.nTrackPos;
+            break;
+
+        default:
+            return;
+    }
+    ScrollViewport(hWnd, iView);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    OnMouseWheel
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID OnMouseWheel(HWND hWnd, WPARAM wParam)
+--                          hWnd    - the handle to the window
+--                          wParam  - the WM_MOUSEWHEEL keys and distance
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Moves the viewport WHEEL_LINES lines per notch; rolling the
+--              wheel away goes back through the scrollback.
+------------------------------------------------------------------------------*/
+VOID OnMouseWheel(HWND hWnd, WPARAM wParam) {
+    PWNDDATA    pwd     = NULL;
+    INT         iLines  = 0;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    iLines = GET_WHEEL_DELTA_WPARAM(wParam) * WHEEL_LINES / WHEEL_DELTA;
+    ScrollViewport(hWnd, pwd->displayBuf.uiView + iLines);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    UpdateViewport
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Reads the scrollback under the buffer's critical section.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID UpdateViewport(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Sets the vertical scroll bar from the scrollback and the
+--              viewport. Lines are added to the scrollback by the decode
+--              workers, so this is called from Paint() rather than for every
+--              line.
+------------------------------------------------------------------------------*/
+VOID UpdateViewport(HWND hWnd) {
+    PWNDDATA    pwd = NULL;
+    SCROLLINFO  si  = {0};
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    EnterCriticalSection(&pwd->displayBuf.cs);
+    si.cbSize   = sizeof(SCROLLINFO);
+    si.fMask    = SIF_RANGE | SIF_PAGE | SIF_POS | SIF_DISABLENOSCROLL;
+    si.nMin     = 0;
+    si.nMax     = pwd->displayBuf.uiKept + pwd->displayBuf.uiRows - 1;
+    si.nPage    = pwd->displayBuf.uiRows;
+    si.nPos     = pwd->displayBuf.uiKept - pwd->displayBuf.uiView;
+    LeaveCriticalSection(&pwd->displayBuf.cs);
+
+    SetScrollInfo(hWnd, SB_VERT, &si, TRUE);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetDisplayRow
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   UINT GetDisplayRow(PDISPLAYBUF pDisplay, INT cyCoord)
+--                          pDisplay    - the display buffer
+--                          cyCoord     - a line of the screen - (0,0) origin.
+--                                        Negative lines are scrollback.
+--
+-- RETURNS:     The ring row that holds the line.
+------------------------------------------------------------------------------*/
+UINT GetDisplayRow(PDISPLAYBUF pDisplay, INT cyCoord) {
+    return (UINT) ((INT) pDisplay->uiFirst + cyCoord
+                 + (INT) pDisplay->uiCapacity) % pDisplay->uiCapacity;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    AdvanceDisplay
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL AdvanceDisplay(PDISPLAYBUF pDisplay, UINT uiFixed)
+--                          pDisplay    - the display buffer
+--                          uiFixed     - the number of lines above the scroll
+--                                        region
+--
+-- RETURNS:     False if the new line couldn't be committed, in which case
+--              nothing is changed.
+--
+-- NOTES:
+--              Scrolls a region that ends at the bottom of the screen up one
+--              line by moving the screen one row along the ring. The top line
+--              of the region goes to the scrollback. The uiFixed lines above
+--              the region are first rotated down past it, so that they stay
+--              on the screen. A viewport that is scrolled back keeps showing
+--              the same lines.
+------------------------------------------------------------------------------*/
+BOOL AdvanceDisplay(PDISPLAYBUF pDisplay, UINT uiFixed) {
+    UINT    uiCols  = pDisplay->uiCols;
+    UINT    uiRow   = 0;
+    INT     i       = 0;
+
+    if (!CommitRow(pDisplay, GetDisplayRow(pDisplay, pDisplay->uiRows))) {
+        return FALSE;
+    }
+    if (uiFixed > 0) {
+        uiRow = GetDisplayRow(pDisplay, uiFixed);
+        for (i = 0; i < PLANES; i++) {
+            memcpy(pDisplay->pbScratch + i * uiCols,
+                   GetPlane(pDisplay, i) + uiRow * uiCols, uiCols);
+        }
+        MoveRows(pDisplay, 1, 0, uiFixed);
+
+        uiRow = GetDisplayRow(pDisplay, 0);
+        for (i = 0; i < PLANES; i++) {
+            memcpy(GetPlane(pDisplay, i) + uiRow * uiCols,
+                   pDisplay->pbScratch + i * uiCols, uiCols);
+        }
+    }
+    pDisplay->uiFirst = GetDisplayRow(pDisplay, 1);
+
+    if (pDisplay->uiKept + pDisplay->uiRows < pDisplay->uiCapacity) {
+        pDisplay->uiKept++;
+    }
+    if (pDisplay->uiView > 0) {
+        pDisplay->uiView = min(pDisplay->uiView + 1, pDisplay->uiKept);
+    }
+    FillCells(pDisplay, 0, pDisplay->uiRows - 1, uiCols);
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FillCells
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Moved from Presentation.c, and handles the end of the ring.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID FillCells(PDISPLAYBUF pDisplay, UINT cxCoord,
+--                             UINT cyCoord, UINT uiCount)
+--                          pDisplay    - the display buffer
+--                          cxCoord     - the column of the first cell to
+--                                        clear - (0,0) origin
+--                          cyCoord     - the line of the first cell to clear
+--                                        - (0,0) origin
+--                          uiCount     - the number of cells to clear
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Blanks uiCount cells in the current background colour. The
+--              rows of each plane are contiguous, so the cells may run on
+--              past the end of the line; a span that runs past the end of
+--              the ring is cleared in two parts. The foreground colour is
+--              left alone, as it always has been when clearing.
+------------------------------------------------------------------------------*/
+VOID FillCells(PDISPLAYBUF pDisplay, UINT cxCoord, UINT cyCoord,
+               UINT uiCount) {
+    UINT uiCell     = 0;
+    UINT uiTotal    = 0;
+    UINT uiPart     = 0;
+
+    uiCell  = GetDisplayRow(pDisplay, cyCoord) * pDisplay->uiCols + cxCoord;
+    uiTotal = pDisplay->uiCapacity * pDisplay->uiCols;
+    uiPart  = min(uiCount, uiTotal - uiCell);
+
+    FillSpan(pDisplay, uiCell, uiPart);
+    FillSpan(pDisplay, 0, uiCount - uiPart);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    MoveRows
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Moved from Presentation.c, and handles the end of the ring.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID MoveRows(PDISPLAYBUF pDisplay, INT cyTo, INT cyFrom,
+--                            UINT uiRows)
+--                          pDisplay    - the display buffer
+--                          cyTo        - the line to move the first row to
+--                          cyFrom      - the first line to move
+--                          uiRows      - the number of lines to move
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Moves a block of lines in every plane. The source and
+--              destination may overlap. A block that doesn't cross the end of
+--              the ring is moved with one memmove per plane, otherwise it is
+--              moved a line at a time.
+------------------------------------------------------------------------------*/
+VOID MoveRows(PDISPLAYBUF pDisplay, INT cyTo, INT cyFrom, UINT uiRows) {
+    UINT    uiCols  = pDisplay->uiCols;
+    UINT    uiTo    = 0;
+    UINT    uiFrom  = 0;
+    UINT    j       = 0;
+    INT     i       = 0;
+
+    if (uiRows == 0  ||  cyTo == cyFrom) {
+        return;
+    }
+    uiTo    = GetDisplayRow(pDisplay, cyTo);
+    uiFrom  = GetDisplayRow(pDisplay, cyFrom);
+
+    if (uiTo + uiRows <= pDisplay->uiCapacity
+            &&  uiFrom + uiRows <= pDisplay->uiCapacity) {
+        for (i = 0; i < PLANES; i++) {
+            memmove(GetPlane(pDisplay, i) + uiTo * uiCols,
+                    GetPlane(pDisplay, i) + uiFrom * uiCols, uiRows * uiCols);
+        }
+        return;
+    }
+
+    // copy in the direction that doesn't overwrite lines still to be moved
+    for (j = 0; j < uiRows; j++) {
+        if (cyTo < cyFrom) {
+            uiTo    = GetDisplayRow(pDisplay, cyTo + j);
+            uiFrom  = GetDisplayRow(pDisplay, cyFrom + j);
+        } else {
+            uiTo    = GetDisplayRow(pDisplay, cyTo + uiRows - 1 - j);
+            uiFrom  = GetDisplayRow(pDisplay, cyFrom + uiRows - 1 - j);
+        }
+        for (i = 0; i < PLANES; i++) {
+            memcpy(GetPlane(pDisplay, i) + uiTo * uiCols,
+                   GetPlane(pDisplay, i) + uiFrom * uiCols, uiCols);
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetPlane
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BYTE* GetPlane(PDISPLAYBUF pDisplay, INT iPlane)
+--                          pDisplay    - the display buffer
+--                          iPlane      - 0 to PLANES - 1
+--
+-- RETURNS:     The start of the plane.
+------------------------------------------------------------------------------*/
+static BYTE* GetPlane(PDISPLAYBUF pDisplay, INT iPlane) {
+    switch (iPlane) {
+        case 0:     return (BYTE*) pDisplay->pcChars;
+        case 1:     return pDisplay->pbFgColors;
+        case 2:     return pDisplay->pbBgColors;
+        default:    return pDisplay->pbStyles;
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CommitRow
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL CommitRow(PDISPLAYBUF pDisplay, UINT uiRow)
+--                          pDisplay    - the display buffer
+--                          uiRow       - a ring row that is about to be used
+--
+-- RETURNS:     False if the memory couldn't be committed.
+--
+-- NOTES:
+--              Ring rows are first used in order, so everything below
+--              uiCommitted is already backed by memory. Otherwise the ring is
+--              committed up to the end of uiRow's block of COMMIT_ROWS lines,
+--              and the new lines are made blank with the default colour.
+------------------------------------------------------------------------------*/
+static BOOL CommitRow(PDISPLAYBUF pDisplay, UINT uiRow) {
+    UINT    uiCols  = pDisplay->uiCols;
+    UINT    uiStart = pDisplay->uiCommitted;
+    UINT    uiEnd   = 0;
+    SIZE_T  cbNew   = 0;
+    INT     i       = 0;
+
+    if (uiRow < uiStart) {
+        return TRUE;
+    }
+    uiEnd = min((uiRow / COMMIT_ROWS + 1) * COMMIT_ROWS, pDisplay->uiCapacity);
+    cbNew = (SIZE_T) (uiEnd - uiStart) * uiCols;
+
+    for (i = 0; i < PLANES; i++) {
+        if (VirtualAlloc(GetPlane(pDisplay, i) + uiStart * uiCols, cbNew,
+                         MEM_COMMIT, PAGE_READWRITE) == NULL) {
+            return FALSE;
+        }
+    }
+    memset(pDisplay->pcChars + uiStart * uiCols, ' ', cbNew);
+    memset(pDisplay->pbFgColors + uiStart * uiCols, 7, cbNew);
+    pDisplay->uiCommitted = uiEnd;
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FillSpan
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID FillSpan(PDISPLAYBUF pDisplay, UINT uiCell, UINT uiCount)
+--                          pDisplay    - the display buffer
+--                          uiCell      - the offset of the first cell in the
+--                                        planes
+--                          uiCount     - the number of cells to clear
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Blanks cells that don't cross the end of the ring.
+------------------------------------------------------------------------------*/
+static VOID FillSpan(PDISPLAYBUF pDisplay, UINT uiCell, UINT uiCount) {
+    if (uiCount == 0) {
+        return;
+    }
+    memset(pDisplay->pcChars + uiCell, ' ', uiCount);
+    memset(pDisplay->pbBgColors + uiCell, pDisplay->bgColor, uiCount);
+    memset(pDisplay->pbStyles + uiCell, 0, uiCount);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ScrollViewport
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Holds the buffer's critical section, since a decode worker
+--              may be adding to the scrollback.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID ScrollViewport(HWND hWnd, INT iView)
+--                          hWnd    - the handle to the window
+--                          iView   - the number of lines to scroll back
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Moves the viewport, limited to the scrollback that is kept.
+--              The lines that are still visible are moved with
+--              ScrollWindowEx(), so only the lines that come into view are
+--              drawn again.
+------------------------------------------------------------------------------*/
+static VOID ScrollViewport(HWND hWnd, INT iView) {
+    PWNDDATA    pwd     = NULL;
+    RECT        rect    = {0};
+    INT         iLines  = 0;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    EnterCriticalSection(&pwd->displayBuf.cs);
+    iView   = max(iView, 0);
+    iView   = min(iView, (INT) pwd->displayBuf.uiKept);
+    iLines  = iView - (INT) pwd->displayBuf.uiView;
+
+    if (iLines == 0) {
+        LeaveCriticalSection(&pwd->displayBuf.cs);
+        return;
+    }
+    pwd->displayBuf.uiView = iView;
+    UpdateViewport(hWnd);
+
+    rect.left   = PADDING;
+    rect.top    = PADDING;
+    rect.right  = PADDING + CHAR_WIDTH  * CHARS_PER_LINE;
+    rect.bottom = PADDING + CHAR_HEIGHT * LINES_PER_SCRN;
+
+    if (abs(iLines) >= (INT) LINES_PER_SCRN) {
+        InvalidateRect(hWnd, &rect, FALSE);
+    } else {
+        ScrollWindowEx(hWnd, 0, iLines * (INT) CHAR_HEIGHT, &rect, &rect,
+                       NULL, NULL, SW_INVALIDATE);
+    }
+    LeaveCriticalSection(&pwd->displayBuf.cs);
+}
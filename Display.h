@@ -0,0 +1,59 @@
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include <Windows.h>
+
+#define DISPLAY_COLUMNS     80      // default characters per line
+#define DISPLAY_ROWS        24      // default lines on the screen
+#define DISPLAY_SCROLLBACK  200000  // default lines kept above the screen
+#define MIN_DISPLAY_COLUMNS 20
+#define MAX_DISPLAY_COLUMNS 256
+#define MIN_DISPLAY_ROWS    2
+#define MAX_SCROLLBACK      1000000
+#define COMMIT_ROWS         256     // lines of the ring committed at a time
+#define WHEEL_LINES         3       // lines scrolled per notch of the wheel
+
+// Each cell attribute is its own plane, so runs of cells (and whole rows,
+// which are contiguous) can be filled and moved with memset and memmove. The
+// rows of each plane form a ring: the screen is uiRows lines starting at
+// uiFirst, and the uiKept lines before it are the scrollback. The decode
+// workers write to it, and the UI thread resizes, scrolls and paints it, each
+// while holding cs.
+typedef struct displayBuf {
+    CRITICAL_SECTION    cs;
+    CHAR*   pcChars;
+    BYTE*   pbFgColors;
+    BYTE*   pbBgColors;
+    BYTE*   pbStyles;
+    BYTE*   pbScratch;      // one row of each plane, for rotating rows
+    UINT    uiCols;         // characters per line
+    UINT    uiRows;         // lines on the screen
+    UINT    uiCapacity;     // lines in the ring
+    UINT    uiCommitted;    // lines of the ring backed by memory
+    UINT    uiFirst;        // the ring row of the top line of the screen
+    UINT    uiKept;         // lines of scrollback
+    UINT    uiView;         // lines the viewport is scrolled back
+    UINT    cxChar;
+    UINT    cyChar;
+    INT     cxCursor;
+    INT     cyCursor;
+    HFONT	hFont;
+	BYTE    fgColor;
+    BYTE    bgColor;
+    BYTE    style;
+	BYTE	brightness;
+} DISPLAYBUF, *PDISPLAYBUF;
+
+BOOL    InitDisplay(HWND hWnd);
+VOID    FreeDisplay(HWND hWnd);
+VOID    ResizeDisplay(HWND hWnd, INT cxClient, INT cyClient);
+VOID    OnVScroll(HWND hWnd, WPARAM wParam);
+VOID    OnMouseWheel(HWND hWnd, WPARAM wParam);
+VOID    UpdateViewport(HWND hWnd);
+UINT    GetDisplayRow(PDISPLAYBUF pDisplay, INT cyCoord);
+BOOL    AdvanceDisplay(PDISPLAYBUF pDisplay, UINT uiFixed);
+VOID    FillCells(PDISPLAYBUF pDisplay, UINT cxCoord, UINT cyCoord,
+                  UINT uiCount);
+VOID    MoveRows(PDISPLAYBUF pDisplay, INT cyTo, INT cyFrom, UINT uiRows);
+
+#endif
@@ -7,11 +7,13 @@
 --
 -- FUNCTIONS:
 --              BOOL DetectLRCError(CHAR* pcPacket, DWORD dwLength)
+--              VOID AppendLRC(CHAR* pcPacket, DWORD dwLength)
 --
 --
 -- DATE:        Nov 2, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              Added AppendLRC() for building outgoing frames.
 --
 -- DESIGNER:    Dean Morin, Marcel Vangrootheest
 --
@@ -74,3 +76,40 @@ BOOL DetectLRCError(CHAR* pcPacket, DWORD dwLength){
 	}
 	return FALSE;
 }
+
+/*---------------------------------------------------------------
+--FUNCTION: 	AppendLRC
+--
+--DATE:			Oct 19, 2026
+--
+--REVISIONS:	(Date and Description)
+--
+--DESIGNER:		Dean Morin
+--
+--Programer:	Dean Morin
+--
+--INTERFACE:	VOID AppendLRC(CHAR* pcPacket, DWORD dwLength)
+--									pcPacket	- Frame to be completed
+--									dwLength	- number of Bytes in frame,
+--												  including the two LRC bytes
+--
+--
+--RETURNS:		VOID
+--
+--NOTES:
+--
+--				Fills in the last two bytes of the frame so that
+--				DetectLRCError() will accept it: the XOR of every other
+--				byte, followed by that value XOR'd with FF.
+--
+----------------------------------------------------------------*/
+VOID AppendLRC(CHAR* pcPacket, DWORD dwLength){
+	DWORD i;
+	char sum = 0x0;
+
+	for(i = 0; i < dwLength - 2; i++){
+		sum = sum ^ pcPacket[i];
+	}
+	pcPacket[i++] = sum;
+	pcPacket[i] = sum ^ (char)0xFF;
+}
@@ -4,5 +4,6 @@
 #include "Main.h"
 #include <stdio.h>
 BOOL DetectLRCError(CHAR* pcPacket, DWORD dwLength);
+VOID AppendLRC(CHAR* pcPacket, DWORD dwLength);
 
 #endif
@@ -0,0 +1,526 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Escape.c - Contains the VT100 escape sequence parser used
+--                             when the window shows the reader's ASCII output.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    ProcessWrite(HWND, CHAR*, DWORD);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- Anything the reader sends outside of a binary frame (i.e. that doesn't start
+-- with SOF) is its ASCII output, and is written to the display as it would be
+-- on a VT100. 
+--
+-- The parser is a table-driven state machine. Each byte is mapped to one of a
+-- handful of classes, and the current state and the class give both the next
+-- state and an action to perform. The state and the numeric parameters of a
+-- control sequence are kept in the window extra, so a sequence that is split
+-- across two reads just carries on where it left off, and nothing is ever
+-- buffered or allocated. In the ground state, runs of printable characters
+-- are found first and written to the display in one UpdateDisplayRun() call.
+--
+-- Supported:   C0      BS, HT, LF, VT, FF, CR
+--              ESC     D (index), M (reverse index), E (next line), 
+--                      7 / 8 (save / restore cursor), c (reset)
+--              CSI     A B C D (cursor movement), H f (cursor position),
+--                      J K (erase), m (colours), r (scroll region),
+--                      ?6 ?7 h / l (origin mode, autowrap)
+-- Anything else is parsed (so it doesn't end up on the screen) and ignored.
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+#define CC_PRINT        0       // character classes
+#define CC_EXECUTE      1
+#define CC_ESC          2
+#define CC_DIGIT        3
+#define CC_SEMI         4
+#define CC_PRIVATE      5
+#define CC_INTERMED     6
+#define CC_LBRACKET     7
+#define CC_FINAL        8
+#define CC_IGNORE       9
+#define CC_CLASSES      10
+
+#define A_NONE          0       // actions
+#define A_PRINT         1
+#define A_EXECUTE       2
+#define A_CLEAR         3
+#define A_PARAM         4
+#define A_NEXT_PARAM    5
+#define A_PRIVATE       6
+#define A_ESC_DISPATCH  7
+#define A_CSI_DISPATCH  8
+
+#define T(a, s)         (BYTE) (((a) << 4) | (s))
+#define ACTION(t)       ((t) >> 4)
+#define NEXT_STATE(t)   ((t) & 0x0F)
+
+static BYTE bClasses[256];
+static BOOL bClassesBuilt = FALSE;
+
+static const BYTE bTransitions[ESC_STATES][CC_CLASSES] = {
+    // ESC_GROUND
+    {   T(A_PRINT, ESC_GROUND),             T(A_EXECUTE, ESC_GROUND),
+        T(A_CLEAR, ESC_ESCAPE),             T(A_PRINT, ESC_GROUND),
+        T(A_PRINT, ESC_GROUND),             T(A_PRINT, ESC_GROUND),
+        T(A_PRINT, ESC_GROUND),             T(A_PRINT, ESC_GROUND),
+        T(A_PRINT, ESC_GROUND),             T(A_NONE, ESC_GROUND)       },
+    // ESC_ESCAPE
+    {   T(A_NONE, ESC_GROUND),              T(A_EXECUTE, ESC_ESCAPE),
+        T(A_CLEAR, ESC_ESCAPE),             T(A_ESC_DISPATCH, ESC_GROUND),
+        T(A_ESC_DISPATCH, ESC_GROUND),      T(A_ESC_DISPATCH, ESC_GROUND),
+        T(A_NONE, ESC_ESCAPE),              T(A_CLEAR, ESC_CSI_ENTRY),
+        T(A_ESC_DISPATCH, ESC_GROUND),      T(A_NONE, ESC_ESCAPE)       },
+    // ESC_CSI_ENTRY
+    {   T(A_NONE, ESC_GROUND),              T(A_EXECUTE, ESC_CSI_ENTRY),
+        T(A_CLEAR, ESC_ESCAPE),             T(A_PARAM, ESC_CSI_PARAM),
+        T(A_NEXT_PARAM, ESC_CSI_PARAM),     T(A_PRIVATE, ESC_CSI_PARAM),
+        T(A_NONE, ESC_CSI_IGNORE),          T(A_CSI_DISPATCH, ESC_GROUND),
+        T(A_CSI_DISPATCH, ESC_GROUND),      T(A_NONE, ESC_CSI_ENTRY)    },
+    // ESC_CSI_PARAM
+    {   T(A_NONE, ESC_GROUND),              T(A_EXECUTE, ESC_CSI_PARAM),
+        T(A_CLEAR, ESC_ESCAPE),             T(A_PARAM, ESC_CSI_PARAM),
+        T(A_NEXT_PARAM, ESC_CSI_PARAM),     T(A_NONE, ESC_CSI_IGNORE),
+        T(A_NONE, ESC_CSI_IGNORE),          T(A_CSI_DISPATCH, ESC_GROUND),
+        T(A_CSI_DISPATCH, ESC_GROUND),      T(A_NONE, ESC_CSI_PARAM)    },
+    // ESC_CSI_IGNORE
+    {   T(A_NONE, ESC_GROUND),              T(A_EXECUTE, ESC_CSI_IGNORE),
+        T(A_CLEAR, ESC_ESCAPE),             T(A_NONE, ESC_CSI_IGNORE),
+        T(A_NONE, ESC_CSI_IGNORE),          T(A_NONE, ESC_CSI_IGNORE),
+        T(A_NONE, ESC_CSI_IGNORE),          T(A_NONE, ESC_GROUND),
+        T(A_NONE, ESC_GROUND),              T(A_NONE, ESC_CSI_IGNORE)   }
+};
+
+static VOID BuildClasses(VOID);
+static VOID Execute(HWND hWnd, CHAR c);
+static VOID EscDispatch(HWND hWnd, CHAR c);
+static VOID CsiDispatch(HWND hWnd, CHAR c);
+static VOID SelectGraphicRendition(HWND hWnd);
+static VOID LineFeed(HWND hWnd);
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ProcessWrite
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Holds the display buffer's critical section for the whole
+--              buffer, so the UI thread never paints half a sequence.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID ProcessWrite(HWND hWnd, CHAR* psBuf, DWORD dwLength)
+--                          hWnd        - the handle to the window
+--                          psBuf       - the characters to process
+--                          dwLength    - the number of characters in psBuf
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Runs the characters through the parser, updating the display
+--              buffer as it goes.
+------------------------------------------------------------------------------*/
+VOID ProcessWrite(HWND hWnd, CHAR* psBuf, DWORD dwLength) {
+    PWNDDATA    pwd     = NULL;
+    PESCPARSER  pEsc    = NULL;
+    BYTE        bTrans  = 0;
+    DWORD       i       = 0;
+    DWORD       j       = 0;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pEsc    = &pwd->escParser;
+
+    if (!bClassesBuilt) {
+        BuildClasses();
+    }
+    EnterCriticalSection(&pwd->displayBuf.cs);
+
+    while (i < dwLength) {
+        
+        if (pEsc->bState == ESC_GROUND) {
+            // write a run of printable characters all at once
+            for (j = i; j < dwLength; j++) {
+                bTrans = bTransitions[ESC_GROUND][bClasses[(BYTE) psBuf[j]]];
+                if (ACTION(bTrans) != A_PRINT) {
+                    break;
+                }
+            }
+            if (j > i) {
+                UpdateDisplayRun(hWnd, psBuf + i, j - i);
+                i = j;
+                continue;
+            }
+        }
+        bTrans = bTransitions[pEsc->bState][bClasses[(BYTE) psBuf[i]]];
+        pEsc->bState = NEXT_STATE(bTrans);
+
+        switch (ACTION(bTrans)) {
+            
+            case A_EXECUTE:
+                Execute(hWnd, psBuf[i]);
+                break;
+            
+            case A_CLEAR:
+                pEsc->dwParamCount  = 0;
+                pEsc->bPrivate      = 0;
+                ZeroMemory(pEsc->dwParams, sizeof(pEsc->dwParams));
+                break;
+            
+            case A_PARAM:
+                if (pEsc->dwParamCount == 0) {
+                    pEsc->dwParamCount = 1;
+                }
+                if (pEsc->dwParamCount <= ESC_MAX_PARAMS) {
+                    j = pEsc->dwParamCount - 1;
+                    pEsc->dwParams[j] = min(pEsc->dwParams[j] * 10 
+                                            + psBuf[i] - ASCII_DIGIT_OFFSET,
+                                            ESC_MAX_PARAM_VALUE);
+                }
+                break;
+            
+            case A_NEXT_PARAM:
+                // an empty first parameter still counts
+                pEsc->dwParamCount = max(pEsc->dwParamCount, 1) + 1;
+                break;
+            
+            case A_PRIVATE:
+                pEsc->bPrivate = psBuf[i];
+                break;
+            
+            case A_ESC_DISPATCH:
+                EscDispatch(hWnd, psBuf[i]);
+                break;
+            
+            case A_CSI_DISPATCH:
+                CsiDispatch(hWnd, psBuf[i]);
+                break;
+
+            default:
+                break;
+        }
+        i++;
+    }
+    LeaveCriticalSection(&pwd->displayBuf.cs);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    BuildClasses
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID BuildClasses(VOID)
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Fills in the class of every byte. Called once.
+------------------------------------------------------------------------------*/
+static VOID BuildClasses(VOID) {
+    UINT i = 0;
+
+    for (i = 0; i < 256; i++) {
+        if (i < 0x20) {
+            bClasses[i] = CC_EXECUTE;
+        } else if (i < 0x30) {
+            bClasses[i] = CC_INTERMED;
+        } else if (i < 0x3A) {
+            bClasses[i] = CC_DIGIT;
+        } else if (i < 0x40) {
+            bClasses[i] = CC_PRIVATE;
+        } else if (i < 0x7F) {
+            bClasses[i] = CC_FINAL;
+        } else if (i == 0x7F) {
+            bClasses[i] = CC_IGNORE;
+        } else {
+            bClasses[i] = CC_PRINT;
+        }
+    }
+    bClasses[0x00]  = CC_IGNORE;
+    bClasses[0x1B]  = CC_ESC;
+    bClasses[';']   = CC_SEMI;
+    bClasses['[']   = CC_LBRACKET;
+    bClassesBuilt   = TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    Execute
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID Execute(HWND hWnd, CHAR c)
+--                          hWnd    - the handle to the window
+--                          c       - a C0 control character
+--
+-- RETURNS:     VOID.
+------------------------------------------------------------------------------*/
+static VOID Execute(HWND hWnd, CHAR c) {
+    PWNDDATA pwd = NULL;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    switch (c) {
+        case '\b':  if (X > 0) X--;         return;
+        case '\t':  HorizontalTab(hWnd);    return;
+        case '\n':
+        case '\v':  LineFeed(hWnd);         return;
+        case '\f':  FormFeed(hWnd);         return;
+        case '\r':  X = 0;                  return;
+        default:                            return;
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    EscDispatch
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID EscDispatch(HWND hWnd, CHAR c)
+--                          hWnd    - the handle to the window
+--                          c       - the character following ESC
+--
+-- RETURNS:     VOID.
+------------------------------------------------------------------------------*/
+static VOID EscDispatch(HWND hWnd, CHAR c) {
+    PWNDDATA    pwd     = NULL;
+    PESCPARSER  pEsc    = NULL;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pEsc    = &pwd->escParser;
+
+    switch (c) {
+        case 'D':
+            LineFeed(hWnd);
+            return;
+        case 'E':
+            X = 0;
+            LineFeed(hWnd);
+            return;
+        case 'M':
+            if (Y == WINDOW_TOP) {
+                ScrollUp(hWnd);
+            } else if (Y > 0) {
+                Y--;
+            }
+            return;
+        case '7':
+            pEsc->cxSaved = X;
+            pEsc->cySaved = Y;
+            return;
+        case '8':
+            X = pEsc->cxSaved;
+            Y = pEsc->cySaved;
+            return;
+        case 'c':
+            CUR_FG_COLOR    = 7;
+            CUR_BG_COLOR    = 0;
+            CUR_STYLE       = 0;
+            BRIGHTNESS      = 0;
+            SetScrollRegion(hWnd, 1, LINES_PER_SCRN);
+            FormFeed(hWnd);
+            return;
+        default:
+            return;
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CsiDispatch
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID CsiDispatch(HWND hWnd, CHAR c)
+--                          hWnd    - the handle to the window
+--                          c       - the final character of the sequence
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Performs a control sequence. Missing or zero parameters take
+--              their VT100 defaults.
+------------------------------------------------------------------------------*/
+static VOID CsiDispatch(HWND hWnd, CHAR c) {
+    PWNDDATA    pwd     = NULL;
+    PESCPARSER  pEsc    = NULL;
+    DWORD       dwFirst = 0;
+    DWORD       dwN     = 0;
+    DWORD       dwM     = 0;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pEsc    = &pwd->escParser;
+
+    dwFirst = pEsc->dwParams[0];
+    dwN     = max(pEsc->dwParams[0], 1);
+    dwM     = max(pEsc->dwParams[1], 1);
+
+    if (pEsc->bPrivate == '?') {
+        if (c == 'h'  ||  c == 'l') {
+            if (dwFirst == 6) {
+                pwd->relOrigin  = (c == 'h');
+            } else if (dwFirst == 7) {
+                pwd->wordWrap   = (c == 'h');
+            }
+        }
+        return;
+    }
+
+    switch (c) {
+        case 'A':   MoveCursor(hWnd, X + 1, Y + 1 - (INT) dwN, FALSE); return;
+        case 'B':   MoveCursor(hWnd, X + 1, Y + 1 + (INT) dwN, FALSE); return;
+        case 'C':   MoveCursor(hWnd, X + 1 + (INT) dwN, Y + 1, FALSE); return;
+        case 'D':   MoveCursor(hWnd, X + 1 - (INT) dwN, Y + 1, FALSE); return;
+        
+        case 'H':
+        case 'f':
+            if (pwd->relOrigin) {
+                dwN += WINDOW_TOP;
+            }
+            MoveCursor(hWnd, dwM, dwN, FALSE);
+            return;
+        
+        case 'J':
+            if (dwFirst == 2) {
+                ClearScreen(hWnd, 0, 0, CLR_DOWN);
+            } else {
+                ClearScreen(hWnd, X, Y, dwFirst == 1 ? CLR_UP : CLR_DOWN);
+            }
+            return;
+        
+        case 'K':
+            if (dwFirst == 2) {
+                ClearLine(hWnd, 0, Y, CLR_RIGHT);
+            } else {
+                ClearLine(hWnd, X, Y, dwFirst == 1 ? CLR_LEFT : CLR_RIGHT);
+            }
+            return;
+        
+        case 'm':
+            SelectGraphicRendition(hWnd);
+            return;
+        
+        case 'r':
+            if (pEsc->dwParamCount < 2  ||  pEsc->dwParams[1] == 0) {
+                dwM = LINES_PER_SCRN;
+            }
+            if (dwN < dwM  &&  dwM <= LINES_PER_SCRN) {
+                SetScrollRegion(hWnd, dwN, dwM);
+            }
+            return;
+        
+        default:
+            return;
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    SelectGraphicRendition
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID SelectGraphicRendition(HWND hWnd)
+--                          hWnd    - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Applies the attributes of an "ESC [ ... m" sequence. Bold is
+--              shown as the bright half of the palette.
+------------------------------------------------------------------------------*/
+static VOID SelectGraphicRendition(HWND hWnd) {
+    PWNDDATA    pwd     = NULL;
+    PESCPARSER  pEsc    = NULL;
+    DWORD       dwValue = 0;
+    DWORD       i       = 0;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pEsc    = &pwd->escParser;
+
+    // "ESC [ m" is the same as "ESC [ 0 m"
+    for (i = 0; i < max(pEsc->dwParamCount, 1)  &&  i < ESC_MAX_PARAMS; i++) {
+        dwValue = pEsc->dwParams[i];
+        
+        if (dwValue == 0) {
+            CUR_FG_COLOR    = 7;
+            CUR_BG_COLOR    = 0;
+            CUR_STYLE       = 0;
+            BRIGHTNESS      = 0;
+        } else if (dwValue == 1) {
+            BRIGHTNESS      = 8;
+            CUR_FG_COLOR    |= 8;
+        } else if (dwValue >= 30  &&  dwValue <= 37) {
+            CUR_FG_COLOR    = (BYTE) (dwValue - 30 + BRIGHTNESS);
+        } else if (dwValue >= 40  &&  dwValue <= 47) {
+            CUR_BG_COLOR    = (BYTE) (dwValue - 40);
+        } else if (dwValue == 4  ||  dwValue == 5  ||  dwValue == 7) {
+            CUR_STYLE       = (BYTE) dwValue;
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    LineFeed
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID LineFeed(HWND hWnd)
+--                          hWnd    - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Moves the cursor down a line, scrolling if it is at the bottom
+--              of the scroll region.
+------------------------------------------------------------------------------*/
+static VOID LineFeed(HWND hWnd) {
+    PWNDDATA pwd = NULL;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    if (Y == WINDOW_BOTTOM) {
+        ScrollDown(hWnd);
+    } else if (Y < LINES_PER_SCRN - 1) {
+        Y++;
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef ESCAPE_H
+#define ESCAPE_H
+
+#include <Windows.h>
+
+#define ESC_MAX_PARAMS      16
+#define ESC_MAX_PARAM_VALUE 9999
+
+#define ESC_GROUND          0       // parser states
+#define ESC_ESCAPE          1
+#define ESC_CSI_ENTRY       2
+#define ESC_CSI_PARAM       3
+#define ESC_CSI_IGNORE      4
+#define ESC_STATES          5
+
+typedef struct escParser {
+    BYTE    bState;
+    BYTE    bPrivate;
+    DWORD   dwParams[ESC_MAX_PARAMS];
+    DWORD   dwParamCount;
+    INT     cxSaved;
+    INT     cySaved;
+} ESCPARSER, *PESCPARSER;
+
+VOID    ProcessWrite(HWND hWnd, CHAR* psBuf, DWORD dwLength);
+
+#endif
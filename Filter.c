@@ -0,0 +1,401 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Filter.c - Contains the rules that decide which tag reads
+--                             are displayed.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    InitFilter(HWND);
+--              BOOL    FilterTag(PFILTER, PTAGREAD);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              UIDs are packed with PackUid().
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- Each rule in the [Filter] section is "allow" or "deny" followed by the
+-- tests a read must pass for the rule to apply:
+--
+--      type=<hex>          the tag type, e.g. 04 for ISO 15693
+--      uid=<hex>[/<mask>]  the start of the UID, as displayed (MSB first),
+--                          or the UID bits selected by the mask
+--      reader=<n>          the reader's port number
+--      rate=<n>            the tag has been read more than n times in the
+--                          last second
+--
+-- The first rule that applies decides; if none does, Default does. For
+-- example, to show only ISO 15693 tags from one manufacturer, at most 5 times
+-- a second each:
+--
+--      [Filter]
+--      Default=deny
+--      Rule1=deny rate=5
+--      Rule2=allow type=04 uid=E007
+--
+-- The rules are compiled when the program starts. A UID test is a mask and a
+-- compare on a 64-bit integer, and a table indexed by tag type holds which
+-- rules could apply to it, so a read never looks at rules for other types.
+-- The filter runs on the reader's strand right after the tag is decoded,
+-- before it is timed, displayed or handed to the block engine, and uses no
+-- memory of its own beyond the FILTER structure.
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+static BOOL     CompileRule(LPTSTR lpszRule, PFILTERRULE pRule);
+static LPCTSTR  ParseNumber(LPCTSTR lpszValue, DWORD dwBase,
+                            ULONGLONG* pullValue);
+static DWORD    CountRead(PFILTER pFilter, ULONGLONG ullUid);
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitFilter
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitFilter(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Compiles Rule1, Rule2, ... from the [Filter] section, up to the
+--              first one that is missing, and builds the table of rules for
+--              each tag type. A rule that can't be compiled is left out. With
+--              no rules and Default=allow, the filter is off. Must be called
+--              after InitConfig().
+------------------------------------------------------------------------------*/
+VOID InitFilter(HWND hWnd) {
+    PWNDDATA    pwd                         = NULL;
+    PFILTER     pFilter                     = NULL;
+    TCHAR       szKey[16]                   = {0};
+    TCHAR       szRule[FILTER_RULE_SIZE]    = {0};
+    DWORD       dwType                      = 0;
+    DWORD       i                           = 0;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pFilter = &pwd->filter;
+
+    ZeroMemory(pFilter, sizeof(FILTER));
+    ReadConfigString(hWnd, TEXT("Filter"), TEXT("Default"), TEXT("allow"),
+                     szRule, FILTER_RULE_SIZE);
+    pFilter->bDefault = (lstrcmpi(szRule, TEXT("deny")) != 0);
+
+    for (i = 1; pFilter->dwRules < FILTER_RULES; i++) {
+        wsprintf(szKey, TEXT("Rule%u"), i);
+        if (ReadConfigString(hWnd, TEXT("Filter"), szKey, TEXT(""),
+                             szRule, FILTER_RULE_SIZE) == 0) {
+            break;
+        }
+        if (!CompileRule(szRule, &pFilter->rules[pFilter->dwRules])) {
+            DISPLAY_ERROR("A rule in the [Filter] section is invalid");
+            continue;
+        }
+        if (pFilter->rules[pFilter->dwRules].dwFields & FILTER_RATE) {
+            pFilter->bRate = TRUE;
+        }
+        pFilter->dwRules++;
+    }
+
+    for (dwType = 0; dwType < 256; dwType++) {
+        for (i = 0; i < pFilter->dwRules; i++) {
+            if (!(pFilter->rules[i].dwFields & FILTER_TYPE)
+                    ||  pFilter->rules[i].bType == dwType) {
+                pFilter->dwTypeRules[dwType] |= 1u << i;
+            }
+        }
+    }
+    pFilter->bEnabled = (pFilter->dwRules > 0  ||  !pFilter->bDefault);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FilterTag
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Packs the UID with PackUid().
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL FilterTag(PFILTER pFilter, PTAGREAD pRead)
+--                          pFilter - the reader's compiled rules
+--                          pRead   - a decoded tag
+--
+-- RETURNS:     True if the read should be displayed.
+--
+-- NOTES:
+--              Finds the first rule that applies to the read. Called from the
+--              reader's strand.
+------------------------------------------------------------------------------*/
+BOOL FilterTag(PFILTER pFilter, PTAGREAD pRead) {
+    PFILTERRULE pRule   = NULL;
+    ULONGLONG   ullUid  = 0;
+    DWORD       dwRules = 0;
+    DWORD       dwReads = 0;
+    BOOL        bAllow  = FALSE;
+    DWORD       i       = 0;
+
+    if (!pFilter->bEnabled) {
+        return TRUE;
+    }
+    ullUid = PackUid(pRead);
+    if (pFilter->bRate) {
+        dwReads = CountRead(pFilter, ullUid);
+    }
+
+    bAllow  = pFilter->bDefault;
+    dwRules = pFilter->dwTypeRules[pRead->bType];
+
+    for (i = 0; dwRules != 0; i++, dwRules >>= 1) {
+        if (!(dwRules & 1)) {
+            continue;
+        }
+        pRule = &pFilter->rules[i];
+
+        if ((pRule->dwFields & FILTER_UID)
+                &&  (ullUid & pRule->ullMask) != pRule->ullUid) {
+            continue;
+        }
+        if ((pRule->dwFields & FILTER_READER)
+                &&  pRead->dwReader != pRule->dwReader) {
+            continue;
+        }
+        if ((pRule->dwFields & FILTER_RATE)  &&  dwReads <= pRule->dwRate) {
+            continue;
+        }
+        bAllow = pRule->bAllow;
+        break;
+    }
+
+    if (bAllow) {
+        pFilter->dwPassed++;
+    } else {
+        pFilter->dwRejected++;
+    }
+    return bAllow;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CompileRule
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static BOOL CompileRule(LPTSTR lpszRule, PFILTERRULE pRule)
+--                          lpszRule    - the rule, as written in the
+--                                        configuration file; it is split up
+--                                        in place
+--                          pRule       - receives the compiled rule
+--
+-- RETURNS:     False if the rule is malformed.
+--
+-- NOTES:
+--              A UID of n hex digits is compared with the top 4n bits of the
+--              read's UID. An explicit mask must have as many digits as the
+--              UID it goes with.
+------------------------------------------------------------------------------*/
+static BOOL CompileRule(LPTSTR lpszRule, PFILTERRULE pRule) {
+    LPTSTR      lpszToken   = NULL;
+    LPTSTR      lpszValue   = NULL;
+    LPCTSTR     lpszEnd     = NULL;
+    ULONGLONG   ullValue    = 0;
+    ULONGLONG   ullMask     = 0;
+    DWORD       dwDigits    = 0;
+    BOOL        bFirst      = TRUE;
+
+    ZeroMemory(pRule, sizeof(FILTERRULE));
+
+    while (*lpszRule != '\0') {
+        while (*lpszRule == ' '  ||  *lpszRule == '\t') {
+            lpszRule++;
+        }
+        if (*lpszRule == '\0') {
+            break;
+        }
+        lpszToken = lpszRule;
+        lpszValue = NULL;
+        while (*lpszRule != '\0'  &&  *lpszRule != ' '  &&  *lpszRule != '\t') {
+            if (*lpszRule == '='  &&  lpszValue == NULL) {
+                *lpszRule = '\0';
+                lpszValue = lpszRule + 1;
+            }
+            lpszRule++;
+        }
+        if (*lpszRule != '\0') {
+            *lpszRule++ = '\0';
+        }
+
+        if (bFirst) {
+            // the action comes first
+            if (lstrcmpi(lpszToken, TEXT("allow")) == 0) {
+                pRule->bAllow = TRUE;
+            } else if (lstrcmpi(lpszToken, TEXT("deny")) != 0) {
+                return FALSE;
+            }
+            bFirst = FALSE;
+            continue;
+        }
+        if (lpszValue == NULL) {
+            return FALSE;
+        }
+
+        if (lstrcmpi(lpszToken, TEXT("type")) == 0) {
+            lpszEnd = ParseNumber(lpszValue, 16, &ullValue);
+            if (lpszEnd == NULL  ||  *lpszEnd != '\0'  ||  ullValue > 0xFF) {
+                return FALSE;
+            }
+            pRule->bType     = (BYTE) ullValue;
+            pRule->dwFields |= FILTER_TYPE;
+
+        } else if (lstrcmpi(lpszToken, TEXT("uid")) == 0) {
+            lpszEnd  = ParseNumber(lpszValue, 16, &ullValue);
+            if (lpszEnd == NULL) {
+                return FALSE;
+            }
+            dwDigits = (DWORD) (lpszEnd - lpszValue);
+            if (dwDigits > MAX_UID_LENGTH * 2) {
+                return FALSE;
+            }
+            ullMask  = ~0ULL;
+            if (*lpszEnd == '/') {
+                lpszValue = (LPTSTR) lpszEnd + 1;
+                lpszEnd   = ParseNumber(lpszValue, 16, &ullMask);
+                if (lpszEnd == NULL  ||  *lpszEnd != '\0'
+                        ||  (DWORD) (lpszEnd - lpszValue) != dwDigits) {
+                    return FALSE;
+                }
+            } else if (*lpszEnd != '\0') {
+                return FALSE;
+            }
+            // line the digits up with the top of the UID
+            pRule->ullMask   = ullMask << (64 - 4 * dwDigits);
+            pRule->ullUid    = (ullValue << (64 - 4 * dwDigits))
+                             & pRule->ullMask;
+            pRule->dwFields |= FILTER_UID;
+
+        } else if (lstrcmpi(lpszToken, TEXT("reader")) == 0) {
+            lpszEnd = ParseNumber(lpszValue, 10, &ullValue);
+            if (lpszEnd == NULL  ||  *lpszEnd != '\0') {
+                return FALSE;
+            }
+            pRule->dwReader  = (DWORD) ullValue;
+            pRule->dwFields |= FILTER_READER;
+
+        } else if (lstrcmpi(lpszToken, TEXT("rate")) == 0) {
+            lpszEnd = ParseNumber(lpszValue, 10, &ullValue);
+            if (lpszEnd == NULL  ||  *lpszEnd != '\0') {
+                return FALSE;
+            }
+            pRule->dwRate    = (DWORD) ullValue;
+            pRule->dwFields |= FILTER_RATE;
+
+        } else {
+            return FALSE;
+        }
+    }
+    return !bFirst;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ParseNumber
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static LPCTSTR ParseNumber(LPCTSTR lpszValue, DWORD dwBase,
+--                                         ULONGLONG* pullValue)
+--                          lpszValue   - the digits to parse
+--                          dwBase      - 10 or 16
+--                          pullValue   - receives the number
+--
+-- RETURNS:     The character after the last digit, or NULL if there were no
+--              digits or the number doesn't fit in 64 bits.
+------------------------------------------------------------------------------*/
+static LPCTSTR ParseNumber(LPCTSTR lpszValue, DWORD dwBase,
+                           ULONGLONG* pullValue) {
+    LPCTSTR     lpszStart   = lpszValue;
+    DWORD       dwDigit     = 0;
+    TCHAR       c           = 0;
+
+    *pullValue = 0;
+    for (;; lpszValue++) {
+        c = *lpszValue;
+
+        if (c >= '0'  &&  c <= '9') {
+            dwDigit = c - '0';
+        } else if (dwBase == 16  &&  c >= 'A'  &&  c <= 'F') {
+            dwDigit = c - 'A' + 10;
+        } else if (dwBase == 16  &&  c >= 'a'  &&  c <= 'f') {
+            dwDigit = c - 'a' + 10;
+        } else {
+            break;
+        }
+        if (*pullValue > (~0ULL - dwDigit) / dwBase) {
+            return NULL;
+        }
+        *pullValue = *pullValue * dwBase + dwDigit;
+    }
+    return (lpszValue == lpszStart) ? NULL : lpszValue;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CountRead
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static DWORD CountRead(PFILTER pFilter, ULONGLONG ullUid)
+--                          pFilter - the reader's filter
+--                          ullUid  - the UID that was read
+--
+-- RETURNS:     The number of times the tag has been read in its current
+--              FILTER_WINDOW, including this read.
+--
+-- NOTES:
+--              Each UID hashes to one slot. A tag that finds another in its
+--              slot takes it over and starts counting from 1, so with more
+--              than FILTER_SLOTS tags about, rates are undercounted rather
+--              than overcounted.
+------------------------------------------------------------------------------*/
+static DWORD CountRead(PFILTER pFilter, ULONGLONG ullUid) {
+    PFILTERSLOT pSlot   = NULL;
+    DWORD       dwNow   = 0;
+
+    dwNow = GetTickCount();
+    pSlot = &pFilter->slots[(ullUid * 0x9E3779B97F4A7C15ULL) >> 56];
+
+    if (pSlot->ullUid != ullUid  ||  dwNow - pSlot->dwWindow >= FILTER_WINDOW) {
+        pSlot->ullUid   = ullUid;
+        pSlot->dwWindow = dwNow;
+        pSlot->dwReads  = 0;
+    }
+    return ++pSlot->dwReads;
+}
@@ -0,0 +1,50 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <Windows.h>
+#include "Tag.h"
+
+#define FILTER_RULES        32      // rules in the [Filter] section, at most
+#define FILTER_RULE_SIZE    128     // characters in a rule
+#define FILTER_SLOTS        256     // tags whose read rate is tracked
+#define FILTER_WINDOW       1000    // ms over which a read rate is counted
+
+#define FILTER_TYPE         0x01    // the fields a rule tests
+#define FILTER_UID          0x02
+#define FILTER_READER       0x04
+#define FILTER_RATE         0x08
+
+typedef struct filterRule {
+    DWORD       dwFields;
+    BOOL        bAllow;
+    BYTE        bType;
+    ULONGLONG   ullUid;         // the UID, MSB first in the top bytes,
+    ULONGLONG   ullMask;        // and the bits of it that are compared
+    DWORD       dwReader;
+    DWORD       dwRate;         // reads per FILTER_WINDOW
+} FILTERRULE, *PFILTERRULE;
+
+typedef struct filterSlot {
+    ULONGLONG   ullUid;
+    DWORD       dwWindow;       // GetTickCount() when its window started
+    DWORD       dwReads;
+} FILTERSLOT, *PFILTERSLOT;
+
+// dwTypeRules[t] has bit i set if rule i can match a tag of type t, so a
+// read only looks at the rules for its type, in order.
+typedef struct filter {
+    BOOL        bEnabled;
+    BOOL        bDefault;
+    BOOL        bRate;
+    FILTERRULE  rules[FILTER_RULES];
+    DWORD       dwRules;
+    DWORD       dwTypeRules[256];
+    FILTERSLOT  slots[FILTER_SLOTS];
+    DWORD       dwPassed;
+    DWORD       dwRejected;
+} FILTER, *PFILTER;
+
+VOID    InitFilter(HWND hWnd);
+BOOL    FilterTag(PFILTER pFilter, PTAGREAD pRead);
+
+#endif
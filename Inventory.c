@@ -0,0 +1,576 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Inventory.c - Contains the inventory of the tags that are
+--                                in the field, and its snapshots.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    InitInventory(HWND);
+--              VOID    UpdateInventory(PTAGREAD);
+--              VOID    ShowInventory(HWND);
+--              VOID    CloseInventory(VOID);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- Every tag that gets past the filter, from every reader, is tracked: its type,
+-- the last reader to see it, when it was first seen, when it last came into
+-- the field, when it was last seen, and how often. A tag that hasn't been read
+-- for Absent ms has left the field, and its next read is an arrival (bArrived
+-- in the TAGREAD). A tag that hasn't been read for Forget hours may be
+-- forgotten to make room for another.
+--
+-- The tags are kept in a table of INVENTORY_SLOTS slots, found by hashing the
+-- UID and looking at up to INVENTORY_PROBES slots from there. Slots are never
+-- emptied, only reused, so a lookup can stop at the first empty one.
+--
+-- Every Interval ms, if anything has changed, a thread of its own writes the
+-- whole table to Snapshot. It copies INVENTORY_CHUNK slots at a time under the
+-- lock, so the decode strands are only ever held up for a few microseconds;
+-- each slot is consistent, though the snapshot as a whole is spread over the
+-- time it takes to write. The file is written under a temporary name, flushed,
+-- and renamed over the old one, and carries a checksum of its slots, so after
+-- a crash there is always one whole snapshot. At startup the snapshot is
+-- mapped, checked, and copied straight into the table, since it has the same
+-- layout, and tags that were in the field a moment ago are still present.
+--
+--      [Inventory]
+--      Snapshot=inventory.bin
+--      Interval=10000
+--      Absent=5000
+--      Forget=24
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+static INVENTORY    inventory       = {0};
+static BOOL         bInitialized    = FALSE;
+
+static DWORD WINAPI     InventoryThreadProc(LPVOID lpParam);
+static PINVENTORYTAG    FindInventorySlot(ULONGLONG ullUid);
+static VOID             LoadSnapshot(VOID);
+static VOID             WriteSnapshot(VOID);
+static ULONGLONG        ChecksumSlots(ULONGLONG ullSum, PINVENTORYTAG pTags,
+                                      DWORD dwCount);
+static ULONGLONG        GetInventoryTime(VOID);
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitInventory
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitInventory(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Reads the [Inventory] section, loads the last snapshot and
+--              starts the snapshot thread. Only the first call does anything,
+--              so every reader window can call it. Must be called after
+--              InitConfig(), and before the readers are connected.
+------------------------------------------------------------------------------*/
+VOID InitInventory(HWND hWnd) {
+    PINVENTORY pInv = &inventory;
+
+    if (bInitialized) {
+        return;
+    }
+    bInitialized = TRUE;
+    InitializeCriticalSection(&pInv->cs);
+
+    pInv->pTags = (PINVENTORYTAG) calloc(INVENTORY_SLOTS,
+                                         sizeof(INVENTORYTAG));
+    if (pInv->pTags == NULL) {
+        DISPLAY_ERROR("Could not allocate the tag inventory");
+        return;
+    }
+    pInv->dwInterval    = max(1000, ReadConfigInt(hWnd, TEXT("Inventory"),
+                                TEXT("Interval"), INVENTORY_INTERVAL));
+    pInv->ullAbsent     = 10000ULL * ReadConfigInt(hWnd, TEXT("Inventory"),
+                                TEXT("Absent"), INVENTORY_ABSENT);
+    pInv->ullForget     = 36000000000ULL * ReadConfigInt(hWnd,
+                                TEXT("Inventory"), TEXT("Forget"),
+                                INVENTORY_FORGET);
+    pInv->bEnabled      = TRUE;
+
+    if (ReadConfigPath(hWnd, TEXT("Inventory"), TEXT("Snapshot"),
+                       pInv->szSnapshot) == 0) {
+        return;
+    }
+    LoadSnapshot();
+
+    pInv->hWake     = CreateEvent(NULL, FALSE, FALSE, NULL);
+    pInv->hThread   = (pInv->hWake == NULL) ? NULL
+                    : CreateThread(NULL, 0, InventoryThreadProc, NULL, 0,
+                                   NULL);
+    if (pInv->hThread == NULL) {
+        DISPLAY_ERROR("Could not start the inventory snapshots");
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    UpdateInventory
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID UpdateInventory(PTAGREAD pRead)
+--                          pRead - a decoded tag
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Records the read, and sets pRead->bArrived if the tag wasn't
+--              in the field. Called from any reader's strand.
+------------------------------------------------------------------------------*/
+VOID UpdateInventory(PTAGREAD pRead) {
+    PINVENTORY      pInv    = &inventory;
+    PINVENTORYTAG   pTag    = NULL;
+    ULONGLONG       ullUid  = 0;
+    ULONGLONG       ullNow  = 0;
+
+    pRead->bArrived = FALSE;
+    if (!pInv->bEnabled) {
+        return;
+    }
+    ullUid = PackUid(pRead);
+    ullNow = GetInventoryTime();
+
+    EnterCriticalSection(&pInv->cs);
+    pTag = FindInventorySlot(ullUid);
+    if (pTag->ullLastSeen == 0  ||  pTag->ullUid != ullUid) {
+        if (pTag->ullLastSeen != 0
+                &&  ullNow - pTag->ullLastSeen <= pInv->ullForget) {
+            pInv->dwEvicted++;
+        }
+        ZeroMemory(pTag, sizeof(INVENTORYTAG));
+        pTag->ullUid        = ullUid;
+        pTag->ullFirstSeen  = ullNow;
+        pRead->bArrived     = TRUE;
+    } else if (ullNow - pTag->ullLastSeen > pInv->ullAbsent) {
+        pRead->bArrived     = TRUE;
+    }
+    if (pRead->bArrived) {
+        pTag->ullArrived    = ullNow;
+        pTag->wArrivals    += (pTag->wArrivals < MAXWORD);
+        pInv->dwArrivals++;
+    }
+    pTag->ullLastSeen   = ullNow;
+    pTag->dwReads++;
+    pTag->bType         = pRead->bType;
+    pTag->bReader       = (BYTE) pRead->dwReader;
+    LeaveCriticalSection(&pInv->cs);
+
+    InterlockedIncrement(&pInv->lChanges);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ShowInventory
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID ShowInventory(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Shows how many tags are in the field and tracked, and how the
+--              last startup's snapshot went.
+------------------------------------------------------------------------------*/
+VOID ShowInventory(HWND hWnd) {
+    PINVENTORY      pInv            = &inventory;
+    PINVENTORYTAG   pTag            = NULL;
+    TCHAR           szText[512]     = {0};
+    ULONGLONG       ullNow          = 0;
+    DWORD           dwPresent       = 0;
+    DWORD           dwTracked       = 0;
+    DWORD           i               = 0;
+
+    if (!pInv->bEnabled) {
+        return;
+    }
+    ullNow = GetInventoryTime();
+
+    for (i = 0; i < INVENTORY_SLOTS; i++) {
+        if (i % INVENTORY_CHUNK == 0) {
+            EnterCriticalSection(&pInv->cs);
+        }
+        pTag = &pInv->pTags[i];
+        if (pTag->ullLastSeen != 0) {
+            dwTracked++;
+            dwPresent += (ullNow - pTag->ullLastSeen <= pInv->ullAbsent);
+        }
+        if (i % INVENTORY_CHUNK == INVENTORY_CHUNK - 1) {
+            LeaveCriticalSection(&pInv->cs);
+        }
+    }
+
+    wsprintf(szText, TEXT("%u tags in the field, %u tracked\n")
+             TEXT("%u arrivals, %u tags forgotten early for room\n\n")
+             TEXT("%u tags were loaded from the snapshot in %u ms.\n")
+             TEXT("The last snapshot was written %u s ago."),
+             dwPresent, dwTracked, pInv->dwArrivals, pInv->dwEvicted,
+             pInv->dwLoaded, pInv->dwLoadMs,
+             (pInv->ullSnapshot == 0) ? 0
+                 : (DWORD) ((ullNow - pInv->ullSnapshot) / 10000000));
+    MessageBox(hWnd, szText, TEXT("Inventory"), MB_OK);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CloseInventory
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID CloseInventory(VOID)
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Stops the snapshot thread and writes a last snapshot. The
+--              decode workers must have stopped.
+------------------------------------------------------------------------------*/
+VOID CloseInventory(VOID) {
+    PINVENTORY pInv = &inventory;
+
+    if (!bInitialized) {
+        return;
+    }
+    if (pInv->hThread != NULL) {
+        pInv->bStop = TRUE;
+        SetEvent(pInv->hWake);
+        WaitForSingleObject(pInv->hThread, INFINITE);
+        CloseHandle(pInv->hThread);
+        pInv->hThread = NULL;
+    }
+    if (pInv->hWake != NULL) {
+        CloseHandle(pInv->hWake);
+        pInv->hWake = NULL;
+    }
+    if (pInv->bEnabled  &&  pInv->lChanges > 0) {
+        WriteSnapshot();
+    }
+    pInv->bEnabled = FALSE;
+    free(pInv->pTags);
+    pInv->pTags = NULL;
+    DeleteCriticalSection(&pInv->cs);
+    bInitialized = FALSE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InventoryThreadProc
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static DWORD WINAPI InventoryThreadProc(LPVOID lpParam)
+--                          lpParam - unused
+--
+-- RETURNS:     0.
+--
+-- NOTES:
+--              Writes a snapshot every Interval ms, unless nothing has
+--              changed.
+------------------------------------------------------------------------------*/
+static DWORD WINAPI InventoryThreadProc(LPVOID lpParam) {
+    PINVENTORY pInv = &inventory;
+
+    while (!pInv->bStop) {
+        WaitForSingleObject(pInv->hWake, pInv->dwInterval);
+        if (!pInv->bStop  &&  pInv->lChanges > 0) {
+            WriteSnapshot();
+        }
+    }
+    return 0;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FindInventorySlot
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static PINVENTORYTAG FindInventorySlot(ULONGLONG ullUid)
+--                          ullUid - the packed UID
+--
+-- RETURNS:     The tag's slot, or, if it isn't tracked, the slot it should
+--              take: the one read longest ago, which is an empty one if there
+--              is one. The caller holds the lock.
+------------------------------------------------------------------------------*/
+static PINVENTORYTAG FindInventorySlot(ULONGLONG ullUid) {
+    PINVENTORY      pInv    = &inventory;
+    PINVENTORYTAG   pTag    = NULL;
+    PINVENTORYTAG   pOldest = NULL;
+    DWORD           dwSlot  = 0;
+    DWORD           i       = 0;
+
+    dwSlot = (DWORD) HashUid(ullUid);
+    for (i = 0; i < INVENTORY_PROBES; i++) {
+        pTag = &pInv->pTags[(dwSlot + i) & (INVENTORY_SLOTS - 1)];
+        if (pTag->ullLastSeen != 0  &&  pTag->ullUid == ullUid) {
+            return pTag;
+        }
+        if (pOldest == NULL  ||  pTag->ullLastSeen < pOldest->ullLastSeen) {
+            pOldest = pTag;
+        }
+        if (pTag->ullLastSeen == 0) {
+            // never used, so the tag can't be any further on
+            break;
+        }
+    }
+    return pOldest;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    LoadSnapshot
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID LoadSnapshot(VOID)
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Maps the snapshot, and copies its slots into the table if its
+--              size, header and checksum are right. Otherwise the inventory
+--              starts empty.
+------------------------------------------------------------------------------*/
+static VOID LoadSnapshot(VOID) {
+    PINVENTORY          pInv        = &inventory;
+    PINVENTORYHEADER    pHeader     = NULL;
+    PINVENTORYTAG       pSlots      = NULL;
+    HANDLE              hFile       = INVALID_HANDLE_VALUE;
+    HANDLE              hMap        = NULL;
+    BYTE*               pbBase      = NULL;
+    LARGE_INTEGER       liSize      = {0};
+    LARGE_INTEGER       liFrequency = {0};
+    LONGLONG            llStart     = 0;
+
+    llStart = TraceNow();
+    hFile = CreateFile(pInv->szSnapshot, GENERIC_READ,
+                       FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                       OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    if (GetFileSizeEx(hFile, &liSize)
+            &&  liSize.QuadPart == sizeof(INVENTORYHEADER)
+                                   + (LONGLONG) INVENTORY_SLOTS
+                                     * sizeof(INVENTORYTAG)
+            &&  (hMap = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0,
+                                          NULL)) != NULL
+            &&  (pbBase = (BYTE*) MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0))
+                != NULL) {
+        pHeader = (PINVENTORYHEADER) pbBase;
+        pSlots  = (PINVENTORYTAG) (pbBase + sizeof(INVENTORYHEADER));
+        if (pHeader->dwMagic == INVENTORY_MAGIC
+                &&  pHeader->dwVersion == INVENTORY_VERSION
+                &&  pHeader->dwSlots == INVENTORY_SLOTS
+                &&  pHeader->ullChecksum == ChecksumSlots(0, pSlots,
+                                                          INVENTORY_SLOTS)) {
+            memcpy(pInv->pTags, pSlots,
+                   INVENTORY_SLOTS * sizeof(INVENTORYTAG));
+            pInv->dwLoaded      = pHeader->dwTags;
+            pInv->ullSnapshot   = pHeader->ullWritten;
+        }
+        UnmapViewOfFile(pbBase);
+    }
+    if (hMap != NULL) {
+        CloseHandle(hMap);
+    }
+    CloseHandle(hFile);
+
+    QueryPerformanceFrequency(&liFrequency);
+    pInv->dwLoadMs = (DWORD) ((TraceNow() - llStart) * 1000
+                              / liFrequency.QuadPart);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    WriteSnapshot
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID WriteSnapshot(VOID)
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Copies the table a chunk at a time and writes it to a
+--              temporary file, then writes the header, flushes the file to the
+--              disk, and renames it over the last snapshot. If anything fails
+--              the last snapshot is left as it was.
+------------------------------------------------------------------------------*/
+static VOID WriteSnapshot(VOID) {
+    PINVENTORY      pInv                = &inventory;
+    INVENTORYHEADER header              = {0};
+    TCHAR           szTemp[MAX_PATH]    = {0};
+    HANDLE          hFile               = INVALID_HANDLE_VALUE;
+    LARGE_INTEGER   liStart             = {0};
+    DWORD           dwWritten           = 0;
+    BOOL            bResult             = TRUE;
+    DWORD           i                   = 0;
+    DWORD           j                   = 0;
+
+    if (lstrlen(pInv->szSnapshot) + 5 >= MAX_PATH) {
+        return;
+    }
+    wsprintf(szTemp, TEXT("%s.tmp"), pInv->szSnapshot);
+    hFile = CreateFile(szTemp, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                       FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    header.dwMagic      = INVENTORY_MAGIC;
+    header.dwVersion    = INVENTORY_VERSION;
+    header.dwSlots      = INVENTORY_SLOTS;
+    bResult = WriteFile(hFile, &header, sizeof(header), &dwWritten, NULL);
+    InterlockedExchange(&pInv->lChanges, 0);
+
+    for (i = 0; i < INVENTORY_SLOTS  &&  bResult; i += INVENTORY_CHUNK) {
+        EnterCriticalSection(&pInv->cs);
+        memcpy(pInv->chunk, &pInv->pTags[i],
+               INVENTORY_CHUNK * sizeof(INVENTORYTAG));
+        LeaveCriticalSection(&pInv->cs);
+
+        for (j = 0; j < INVENTORY_CHUNK; j++) {
+            header.dwTags += (pInv->chunk[j].ullLastSeen != 0);
+        }
+        header.ullChecksum = ChecksumSlots(header.ullChecksum, pInv->chunk,
+                                           INVENTORY_CHUNK);
+        bResult = WriteFile(hFile, pInv->chunk, sizeof(pInv->chunk),
+                            &dwWritten, NULL);
+    }
+
+    header.ullWritten = GetInventoryTime();
+    bResult = bResult
+           && SetFilePointerEx(hFile, liStart, NULL, FILE_BEGIN)
+           && WriteFile(hFile, &header, sizeof(header), &dwWritten, NULL)
+           && FlushFileBuffers(hFile);
+    CloseHandle(hFile);
+    bResult = bResult  &&  MoveFileEx(szTemp, pInv->szSnapshot,
+                                      MOVEFILE_REPLACE_EXISTING
+                                      | MOVEFILE_WRITE_THROUGH);
+    if (!bResult) {
+        DeleteFile(szTemp);
+        InterlockedIncrement(&pInv->lChanges);
+        return;
+    }
+    pInv->ullSnapshot = header.ullWritten;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ChecksumSlots
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static ULONGLONG ChecksumSlots(ULONGLONG ullSum,
+--                                             PINVENTORYTAG pTags,
+--                                             DWORD dwCount)
+--                          ullSum  - the checksum so far, or 0 to start
+--                          pTags   - the next slots
+--                          dwCount - the number of slots
+--
+-- RETURNS:     The checksum with the slots added.
+--
+-- NOTES:
+--              FNV-1a, a word at a time rather than a byte at a time.
+------------------------------------------------------------------------------*/
+static ULONGLONG ChecksumSlots(ULONGLONG ullSum, PINVENTORYTAG pTags,
+                               DWORD dwCount) {
+    ULONGLONG*  pullWords   = (ULONGLONG*) pTags;
+    SIZE_T      words       = 0;
+    SIZE_T      i           = 0;
+
+    if (ullSum == 0) {
+        ullSum = 0xCBF29CE484222325ULL;
+    }
+    words = (SIZE_T) dwCount * sizeof(INVENTORYTAG) / sizeof(ULONGLONG);
+    for (i = 0; i < words; i++) {
+        ullSum = (ullSum ^ pullWords[i]) * 0x100000001B3ULL;
+    }
+    return ullSum;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetInventoryTime
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static ULONGLONG GetInventoryTime(VOID)
+--
+-- RETURNS:     The current time, as a FILETIME in UTC.
+------------------------------------------------------------------------------*/
+static ULONGLONG GetInventoryTime(VOID) {
+    FILETIME        ft  = {0};
+    ULARGE_INTEGER  uli = {0};
+
+    GetSystemTimeAsFileTime(&ft);
+    uli.LowPart     = ft.dwLowDateTime;
+    uli.HighPart    = ft.dwHighDateTime;
+    return uli.QuadPart;
+}
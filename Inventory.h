@@ -0,0 +1,64 @@
+#ifndef INVENTORY_H
+#define INVENTORY_H
+
+#include <Windows.h>
+#include "Tag.h"
+
+#define INVENTORY_SLOTS     (1 << 19)   // tags tracked, at most
+#define INVENTORY_PROBES    64          // slots looked at for a tag
+#define INVENTORY_CHUNK     4096        // slots copied per lock, to snapshot
+#define INVENTORY_INTERVAL  10000       // ms between snapshots
+#define INVENTORY_ABSENT    5000        // ms unread before a tag has left
+#define INVENTORY_FORGET    24          // hours unread before it's forgotten
+#define INVENTORY_MAGIC     0x53564E49  // "INVS"
+#define INVENTORY_VERSION   1
+
+// A tag's slot. ullUid is only meaningful if ullLastSeen isn't 0. The times
+// are FILETIMEs, in UTC, so that they mean the same after a restart.
+typedef struct inventoryTag {
+    ULONGLONG   ullUid;
+    ULONGLONG   ullFirstSeen;
+    ULONGLONG   ullArrived;     // when it last came back into the field
+    ULONGLONG   ullLastSeen;
+    DWORD       dwReads;
+    WORD        wArrivals;
+    BYTE        bType;
+    BYTE        bReader;
+} INVENTORYTAG, *PINVENTORYTAG;
+
+// A snapshot file is the header, then every slot of the table.
+typedef struct inventoryHeader {
+    DWORD       dwMagic;
+    DWORD       dwVersion;
+    DWORD       dwSlots;
+    DWORD       dwTags;
+    ULONGLONG   ullWritten;
+    ULONGLONG   ullChecksum;    // of the slots
+} INVENTORYHEADER, *PINVENTORYHEADER;
+
+typedef struct inventory {
+    CRITICAL_SECTION    cs;
+    BOOL                bEnabled;
+    PINVENTORYTAG       pTags;
+    TCHAR               szSnapshot[MAX_PATH];
+    DWORD               dwInterval;
+    ULONGLONG           ullAbsent;      // in FILETIME ticks
+    ULONGLONG           ullForget;
+    HANDLE              hThread;
+    HANDLE              hWake;
+    volatile BOOL       bStop;
+    volatile LONG       lChanges;       // since the last snapshot
+    INVENTORYTAG        chunk[INVENTORY_CHUNK];
+    DWORD               dwArrivals;
+    DWORD               dwEvicted;
+    DWORD               dwLoaded;       // tags in the snapshot at startup
+    DWORD               dwLoadMs;
+    ULONGLONG           ullSnapshot;    // when the last one was written
+} INVENTORY, *PINVENTORY;
+
+VOID    InitInventory(HWND hWnd);
+VOID    UpdateInventory(PTAGREAD pRead);
+VOID    ShowInventory(HWND hWnd);
+VOID    CloseInventory(VOID);
+
+#endif
@@ -0,0 +1,1655 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Journal.c - Contains the read journal, and the index that
+--                              finds a tag's reads in it.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    InitJournal(HWND);
+--              VOID    JournalTag(PTAGREAD);
+--              DWORD   QueryJournal(ULONGLONG, ULONGLONG, PJOURNALENTRY,
+--                                   DWORD, DWORD*);
+--              VOID    ShowJournal(HWND);
+--              VOID    CloseJournal(VOID);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              The table in memory is kept sorted, and the runs are searched
+--              outside the lock.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- Every tag that gets past the filter, from every reader, is saved in the
+-- journal: one file per day (reads-YYYYMMDD.jnl) in Directory, holding a
+-- JOURNALENTRY per read in the order they were decoded. Files older than Days
+-- are deleted.
+--
+-- The journal is indexed by UID, as a log-structured merge tree. Reads are
+-- merged into a table in memory, sorted by UID and time, as they are
+-- journaled. When it holds JOURNAL_MEMTABLE reads it is written out as a run,
+-- which is never changed again. Each run has a Bloom filter, split into
+-- 64 byte blocks so that a UID's bits are all in one block, and a fence (the
+-- first UID) for every JOURNAL_GROUP entries, about a page. When a level has
+-- JOURNAL_FANIN runs they are merged into one run on the next level, dropping
+-- reads older than Days. A level n run holds JOURNAL_MEMTABLE * 4^n reads, so
+-- a billion reads take about eight levels, and a lookup checks a Bloom block
+-- in each run (one page) and reads one or two pages of entries from only the
+-- runs that hold the UID. The fences are kept in memory.
+--
+-- The decode strands only add reads to a buffer. A thread of its own writes
+-- them to the journal every JOURNAL_FLUSH ms, and does the writing and merging
+-- of runs. Each run records how far into the journal it goes, so at startup
+-- anything after the newest run is read back from the journal. A merged run
+-- records the level 0 runs it was made from, so runs left behind by a merge
+-- that was cut short are deleted then too.
+--
+-- A lookup only holds the lock while it searches the buffer (at most a
+-- second's reads) and the table in memory (a binary search), and takes a
+-- reference to each run. The runs are searched after the lock is released, so
+-- the strands are never held up by a lookup's disk reads. A run taken out of
+-- the list by a merge is freed by whichever of the journal thread and the
+-- lookups is last done with it.
+--
+--      [Journal]
+--      Directory=journal
+--      Days=30
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+static JOURNAL      journal         = {0};
+static BOOL         bInitialized    = FALSE;
+
+static DWORD WINAPI JournalThreadProc(LPVOID lpParam);
+static VOID         FlushPending(VOID);
+static VOID         AppendToJournal(PJOURNALENTRY pEntries, DWORD dwCount);
+static VOID         ReplayJournal(VOID);
+static VOID         AddToMemtable(PJOURNALENTRY pEntries, DWORD dwCount);
+static VOID         FlushMemtable(VOID);
+static VOID         CompactRuns(VOID);
+static BOOL         MergeRuns(PJOURNALRUN* ppInputs, DWORD dwInputs,
+                              DWORD dwLevel, ULONGLONG ullCutoff);
+static BOOL         OpenRunWriter(PRUNWRITER pWriter, DWORD dwLevel,
+                                  ULONGLONG ullBound);
+static VOID         AddToRun(PRUNWRITER pWriter, PJOURNALENTRY pEntry);
+static PJOURNALRUN  FinishRun(PRUNWRITER pWriter);
+static VOID         LoadRuns(VOID);
+static PJOURNALRUN  LoadRun(LPCTSTR lpszFile);
+static VOID         FreeRun(PJOURNALRUN pRun, BOOL bDelete);
+static VOID         ReleaseRun(PJOURNALRUN pRun, BOOL bDelete);
+static VOID         ReplaceRuns(PJOURNALRUN* ppOld, DWORD dwOld,
+                                PJOURNALRUN pNew);
+static VOID         FindInRun(PJOURNALRUN pRun, ULONGLONG ullUid,
+                              ULONGLONG ullSince, PJOURNALENTRY pEntries,
+                              DWORD dwMax, DWORD* pdwFound, DWORD* pdwTotal);
+static VOID         AddResult(PJOURNALENTRY pEntries, DWORD dwMax,
+                              DWORD* pdwFound, PJOURNALENTRY pEntry);
+static ULONGLONG    GetBloomBlock(ULONGLONG ullUid, DWORD dwShift,
+                                  ULONGLONG* pullBits);
+static VOID         GetJournalName(DWORD dwDay, LPTSTR lpszName);
+static VOID         DeleteOldJournals(DWORD dwDay);
+static ULONGLONG    GetUtcNow(VOID);
+static INT          CompareEntries(const VOID* pA, const VOID* pB);
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitJournal
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitJournal(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Reads the [Journal] section, maps the runs already in the
+--              directory, and starts the journal thread. Only the first call
+--              does anything, so every reader window can call it. Must be
+--              called after InitConfig().
+------------------------------------------------------------------------------*/
+VOID InitJournal(HWND hWnd) {
+    PJOURNAL pJournal = &journal;
+
+    if (bInitialized) {
+        return;
+    }
+    bInitialized = TRUE;
+    InitializeCriticalSection(&pJournal->cs);
+    pJournal->hJournal = INVALID_HANDLE_VALUE;
+
+    if (ReadConfigPath(hWnd, TEXT("Journal"), TEXT("Directory"),
+                       pJournal->szDirectory) == 0) {
+        return;
+    }
+    pJournal->dwDays = max(1, ReadConfigInt(hWnd, TEXT("Journal"),
+                                            TEXT("Days"), JOURNAL_DAYS));
+    CreateDirectory(pJournal->szDirectory, NULL);
+
+    pJournal->pMemtable = (PJOURNALENTRY) malloc(JOURNAL_MEMTABLE
+                                                 * sizeof(JOURNALENTRY));
+    pJournal->pSpare    = (PJOURNALENTRY) malloc(JOURNAL_MEMTABLE
+                                                 * sizeof(JOURNALENTRY));
+    pJournal->hWake     = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (pJournal->pMemtable == NULL  ||  pJournal->pSpare == NULL
+            ||  pJournal->hWake == NULL) {
+        DISPLAY_ERROR("Could not start the read journal");
+        return;
+    }
+
+    LoadRuns();
+    pJournal->hThread = CreateThread(NULL, 0, JournalThreadProc, NULL, 0,
+                                     NULL);
+    if (pJournal->hThread == NULL) {
+        DISPLAY_ERROR("Could not start the read journal");
+        return;
+    }
+    pJournal->bEnabled = TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    JournalTag
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID JournalTag(PTAGREAD pRead)
+--                          pRead - a decoded tag, matched against the UID lists
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Adds the read to the buffer the journal thread writes out.
+--              Called from any reader's strand, which never waits for the
+--              disk; if the thread falls so far behind that the buffer is
+--              full, the read is dropped and counted.
+------------------------------------------------------------------------------*/
+VOID JournalTag(PTAGREAD pRead) {
+    PJOURNAL        pJournal    = &journal;
+    JOURNALENTRY    entry       = {0};
+
+    if (!pJournal->bEnabled) {
+        return;
+    }
+    entry.ullUid    = PackUid(pRead);
+    entry.ullTime   = GetUtcNow();
+    entry.dwReader  = pRead->dwReader;
+    entry.bType     = pRead->bType;
+    entry.bMatch    = pRead->bMatch;
+
+    EnterCriticalSection(&pJournal->cs);
+    if (pJournal->dwPending == JOURNAL_PENDING) {
+        pJournal->dwDropped++;
+    } else {
+        pJournal->pending[pJournal->dwPending++] = entry;
+        if (pJournal->dwPending == JOURNAL_PENDING / 2) {
+            SetEvent(pJournal->hWake);
+        }
+    }
+    pJournal->ullLastUid    = entry.ullUid;
+    pJournal->bHaveLast     = TRUE;
+    LeaveCriticalSection(&pJournal->cs);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    QueryJournal
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Binary searches the table in memory, and searches the runs
+--              after releasing the lock.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   DWORD QueryJournal(ULONGLONG ullUid, ULONGLONG ullSince,
+--                                 PJOURNALENTRY pEntries, DWORD dwMax,
+--                                 DWORD* pdwTotal)
+--                          ullUid      - the packed UID to look for
+--                          ullSince    - the earliest read wanted, as a
+--                                        FILETIME
+--                          pEntries    - receives the latest dwMax reads,
+--                                        oldest first
+--                          dwMax       - the size of pEntries
+--                          pdwTotal    - receives the number of reads found
+--
+-- RETURNS:     The number of reads copied to pEntries.
+--
+-- NOTES:
+--              Looks in the buffer, the table in memory, and each run. May be
+--              called from any thread. The lock is only held for the buffer
+--              and the table; each run is referenced under it, and searched
+--              and released after it.
+------------------------------------------------------------------------------*/
+DWORD QueryJournal(ULONGLONG ullUid, ULONGLONG ullSince,
+                   PJOURNALENTRY pEntries, DWORD dwMax, DWORD* pdwTotal) {
+    PJOURNAL        pJournal                    = &journal;
+    PJOURNALRUN     pRuns[JOURNAL_MAX_RUNS]     = {0};
+    PJOURNALENTRY   pEntry                      = NULL;
+    JOURNALENTRY    first                       = {0};
+    DWORD           dwRuns                      = 0;
+    DWORD           dwFound                     = 0;
+    DWORD           dwLow                       = 0;
+    DWORD           dwHigh                      = 0;
+    DWORD           dwMid                       = 0;
+    DWORD           i                           = 0;
+
+    *pdwTotal = 0;
+    if (!pJournal->bEnabled) {
+        return 0;
+    }
+    first.ullUid    = ullUid;
+    first.ullTime   = ullSince;
+
+    EnterCriticalSection(&pJournal->cs);
+    for (i = 0; i < pJournal->dwPending; i++) {
+        pEntry = &pJournal->pending[i];
+        if (pEntry->ullUid == ullUid  &&  pEntry->ullTime >= ullSince) {
+            (*pdwTotal)++;
+            AddResult(pEntries, dwMax, &dwFound, pEntry);
+        }
+    }
+
+    // the table is sorted, so the UID's reads since ullSince follow the first
+    dwHigh = pJournal->dwMemtable;
+    while (dwLow < dwHigh) {
+        dwMid = (dwLow + dwHigh) / 2;
+        if (CompareEntries(&pJournal->pMemtable[dwMid], &first) < 0) {
+            dwLow = dwMid + 1;
+        } else {
+            dwHigh = dwMid;
+        }
+    }
+    for (i = dwLow; i < pJournal->dwMemtable
+                    &&  pJournal->pMemtable[i].ullUid == ullUid; i++) {
+        (*pdwTotal)++;
+        AddResult(pEntries, dwMax, &dwFound, &pJournal->pMemtable[i]);
+    }
+
+    dwRuns = pJournal->dwRuns;
+    for (i = 0; i < dwRuns; i++) {
+        pRuns[i] = pJournal->pRuns[i];
+        InterlockedIncrement(&pRuns[i]->lRefs);
+    }
+    LeaveCriticalSection(&pJournal->cs);
+
+    for (i = 0; i < dwRuns; i++) {
+        FindInRun(pRuns[i], ullUid, ullSince, pEntries, dwMax, &dwFound,
+                  pdwTotal);
+        ReleaseRun(pRuns[i], FALSE);
+    }
+
+    qsort(pEntries, dwFound, sizeof(JOURNALENTRY), CompareEntries);
+    return dwFound;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ShowJournal
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID ShowJournal(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Shows where and when the last tag read was seen in the days
+--              the journal keeps.
+------------------------------------------------------------------------------*/
+VOID ShowJournal(HWND hWnd) {
+    PJOURNAL        pJournal                = &journal;
+    JOURNALENTRY    entries[JOURNAL_SHOWN]  = {0};
+    TCHAR           szText[1024]            = {0};
+    ULARGE_INTEGER  uli                     = {0};
+    FILETIME        ftUtc                   = {0};
+    FILETIME        ftLocal                 = {0};
+    SYSTEMTIME      st                      = {0};
+    ULONGLONG       ullUid                  = 0;
+    BOOL            bHaveLast               = FALSE;
+    DWORD           dwLength                = 0;
+    DWORD           dwFound                 = 0;
+    DWORD           dwTotal                 = 0;
+    DWORD           i                       = 0;
+
+    if (!pJournal->bEnabled) {
+        MessageBox(hWnd, TEXT("The journal is off. Set a directory for it in ")
+                   TEXT("the [Journal] section of the configuration file."),
+                   TEXT("Tag History"), MB_OK);
+        return;
+    }
+    EnterCriticalSection(&pJournal->cs);
+    ullUid      = pJournal->ullLastUid;
+    bHaveLast   = pJournal->bHaveLast;
+    LeaveCriticalSection(&pJournal->cs);
+    if (!bHaveLast) {
+        MessageBox(hWnd, TEXT("No tags have been read yet."),
+                   TEXT("Tag History"), MB_OK);
+        return;
+    }
+
+    dwFound  = QueryJournal(ullUid, GetUtcNow() - pJournal->dwDays
+                                                  * JOURNAL_DAY,
+                            entries, JOURNAL_SHOWN, &dwTotal);
+    dwLength = wsprintf(szText, TEXT("%08X%08X was read %u times in the last ")
+                        TEXT("%u days. The last %u:\n\n"),
+                        (DWORD) (ullUid >> 32), (DWORD) ullUid, dwTotal,
+                        pJournal->dwDays, dwFound);
+    for (i = 0; i < dwFound; i++) {
+        uli.QuadPart            = entries[i].ullTime;
+        ftUtc.dwLowDateTime     = uli.LowPart;
+        ftUtc.dwHighDateTime    = uli.HighPart;
+        FileTimeToLocalFileTime(&ftUtc, &ftLocal);
+        FileTimeToSystemTime(&ftLocal, &st);
+        dwLength += wsprintf(szText + dwLength,
+                             TEXT("%04u-%02u-%02u %02u:%02u:%02u\tCOM%u\n"),
+                             st.wYear, st.wMonth, st.wDay, st.wHour,
+                             st.wMinute, st.wSecond, entries[i].dwReader);
+    }
+    MessageBox(hWnd, szText, TEXT("Tag History"), MB_OK);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CloseJournal
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID CloseJournal(VOID)
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Stops the journal thread, which writes out everything still in
+--              memory first, and unmaps the runs. The decode workers must have
+--              stopped.
+------------------------------------------------------------------------------*/
+VOID CloseJournal(VOID) {
+    PJOURNAL    pJournal    = &journal;
+    DWORD       i           = 0;
+
+    if (!bInitialized) {
+        return;
+    }
+    if (pJournal->hThread != NULL) {
+        pJournal->bStop = TRUE;
+        SetEvent(pJournal->hWake);
+        WaitForSingleObject(pJournal->hThread, INFINITE);
+        CloseHandle(pJournal->hThread);
+        pJournal->hThread = NULL;
+    }
+    pJournal->bEnabled = FALSE;
+    if (pJournal->hWake != NULL) {
+        CloseHandle(pJournal->hWake);
+        pJournal->hWake = NULL;
+    }
+    if (pJournal->hJournal != INVALID_HANDLE_VALUE) {
+        CloseHandle(pJournal->hJournal);
+        pJournal->hJournal = INVALID_HANDLE_VALUE;
+    }
+    for (i = 0; i < pJournal->dwRuns; i++) {
+        FreeRun(pJournal->pRuns[i], FALSE);
+    }
+    pJournal->dwRuns = 0;
+    free(pJournal->pMemtable);
+    free(pJournal->pSpare);
+    pJournal->pMemtable = NULL;
+    pJournal->pSpare    = NULL;
+    DeleteCriticalSection(&pJournal->cs);
+    bInitialized = FALSE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    JournalThreadProc
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static DWORD WINAPI JournalThreadProc(LPVOID lpParam)
+--                          lpParam - unused
+--
+-- RETURNS:     0.
+--
+-- NOTES:
+--              Catches the index up with the journal, then writes out the
+--              buffer every JOURNAL_FLUSH ms, or sooner if it is half full.
+--              Only this thread changes the table in memory and the list of
+--              runs, so it reads them without the lock; it takes the lock to
+--              change them, for QueryJournal().
+------------------------------------------------------------------------------*/
+static DWORD WINAPI JournalThreadProc(LPVOID lpParam) {
+    PJOURNAL pJournal = &journal;
+
+    ReplayJournal();
+    CompactRuns();
+
+    while (!pJournal->bStop) {
+        WaitForSingleObject(pJournal->hWake, JOURNAL_FLUSH);
+        FlushPending();
+    }
+    FlushPending();
+    FlushMemtable();
+    return 0;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FlushPending
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID FlushPending(VOID)
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Takes the buffered reads, and journals and indexes them. They
+--              are split where the table in memory fills, so that a run never
+--              claims to cover a read it doesn't hold.
+------------------------------------------------------------------------------*/
+static VOID FlushPending(VOID) {
+    PJOURNAL    pJournal    = &journal;
+    DWORD       dwCount     = 0;
+    DWORD       dwPiece     = 0;
+    DWORD       i           = 0;
+
+    EnterCriticalSection(&pJournal->cs);
+    dwCount = pJournal->dwPending;
+    memcpy(pJournal->batch, pJournal->pending,
+           dwCount * sizeof(JOURNALENTRY));
+    pJournal->dwPending = 0;
+    LeaveCriticalSection(&pJournal->cs);
+
+    for (i = 0; i < dwCount; i += dwPiece) {
+        dwPiece = min(dwCount - i, JOURNAL_MEMTABLE - pJournal->dwMemtable);
+        AppendToJournal(&pJournal->batch[i], dwPiece);
+        AddToMemtable(&pJournal->batch[i], dwPiece);
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    AppendToJournal
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID AppendToJournal(PJOURNALENTRY pEntries,
+--                                          DWORD dwCount)
+--                          pEntries    - reads, in the order they were decoded
+--                          dwCount     - the number of reads
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Writes the reads to the file of the day they were read on,
+--              opening the next day's file (and deleting expired ones) as
+--              midnight passes. A partial entry left at the end of a file by a
+--              crash is cut off before appending.
+------------------------------------------------------------------------------*/
+static VOID AppendToJournal(PJOURNALENTRY pEntries, DWORD dwCount) {
+    PJOURNAL        pJournal            = &journal;
+    TCHAR           szName[32]          = {0};
+    TCHAR           szFile[MAX_PATH]    = {0};
+    LARGE_INTEGER   liSize              = {0};
+    DWORD           dwDay               = 0;
+    DWORD           dwWritten           = 0;
+    DWORD           dwStart             = 0;
+    DWORD           i                   = 0;
+
+    for (i = 0; i <= dwCount; i++) {
+        dwDay = (i < dwCount) ? (DWORD) (pEntries[i].ullTime / JOURNAL_DAY)
+                              : 0;
+        if (i < dwCount  &&  pJournal->hJournal != INVALID_HANDLE_VALUE
+                &&  dwDay <= pJournal->dwJournalDay) {
+            continue;
+        }
+        if (i > dwStart  &&  pJournal->hJournal != INVALID_HANDLE_VALUE) {
+            WriteFile(pJournal->hJournal, &pEntries[dwStart],
+                      (i - dwStart) * sizeof(JOURNALENTRY), &dwWritten, NULL);
+            pJournal->ullJournalOffset += dwWritten;
+        }
+        dwStart = i;
+        if (i == dwCount) {
+            break;
+        }
+
+        if (pJournal->hJournal != INVALID_HANDLE_VALUE) {
+            CloseHandle(pJournal->hJournal);
+        }
+        GetJournalName(dwDay, szName);
+        wsprintf(szFile, TEXT("%s\\%s"), pJournal->szDirectory, szName);
+        pJournal->hJournal = CreateFile(szFile, GENERIC_WRITE,
+                                        FILE_SHARE_READ, NULL, OPEN_ALWAYS,
+                                        FILE_ATTRIBUTE_NORMAL, NULL);
+        pJournal->dwJournalDay      = dwDay;
+        pJournal->ullJournalOffset  = 0;
+        if (pJournal->hJournal != INVALID_HANDLE_VALUE
+                &&  GetFileSizeEx(pJournal->hJournal, &liSize)) {
+            liSize.QuadPart -= liSize.QuadPart % sizeof(JOURNALENTRY);
+            SetFilePointerEx(pJournal->hJournal, liSize, NULL, FILE_BEGIN);
+            SetEndOfFile(pJournal->hJournal);
+            pJournal->ullJournalOffset = liSize.QuadPart;
+        }
+        DeleteOldJournals(dwDay);
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ReplayJournal
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID ReplayJournal(VOID)
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Indexes the part of the journal that no run covers: the reads
+--              that were only in memory when the program last stopped, or the
+--              whole journal if there are no runs yet.
+------------------------------------------------------------------------------*/
+static VOID ReplayJournal(VOID) {
+    PJOURNAL            pJournal            = &journal;
+    PJOURNALRUNHEADER   pHeader             = NULL;
+    TCHAR               szName[32]          = {0};
+    TCHAR               szFile[MAX_PATH]    = {0};
+    LARGE_INTEGER       liOffset            = {0};
+    HANDLE              hFile               = INVALID_HANDLE_VALUE;
+    DWORD               dwToday             = 0;
+    DWORD               dwDay               = 0;
+    ULONGLONG           ullOffset           = 0;
+    DWORD               dwWant              = 0;
+    DWORD               dwRead              = 0;
+    DWORD               i                   = 0;
+
+    dwToday = (DWORD) (GetUtcNow() / JOURNAL_DAY);
+    dwDay   = dwToday - pJournal->dwDays;
+    for (i = 0; i < pJournal->dwRuns; i++) {
+        pHeader = pJournal->pRuns[i]->pHeader;
+        if (pHeader->dwJournalDay > dwDay
+                ||  (pHeader->dwJournalDay == dwDay
+                     &&  pHeader->ullJournalOffset > ullOffset)) {
+            dwDay       = pHeader->dwJournalDay;
+            ullOffset   = pHeader->ullJournalOffset;
+        }
+    }
+
+    for (; dwDay <= dwToday  &&  !pJournal->bStop; dwDay++, ullOffset = 0) {
+        GetJournalName(dwDay, szName);
+        wsprintf(szFile, TEXT("%s\\%s"), pJournal->szDirectory, szName);
+        hFile = CreateFile(szFile, GENERIC_READ,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (hFile == INVALID_HANDLE_VALUE) {
+            continue;
+        }
+        liOffset.QuadPart = ullOffset;
+        SetFilePointerEx(hFile, liOffset, NULL, FILE_BEGIN);
+        pJournal->dwJournalDay      = dwDay;
+        pJournal->ullJournalOffset  = ullOffset;
+
+        for (;;) {
+            dwWant = min(JOURNAL_PENDING,
+                         JOURNAL_MEMTABLE - pJournal->dwMemtable);
+            if (!ReadFile(hFile, pJournal->batch,
+                          dwWant * sizeof(JOURNALENTRY), &dwRead, NULL)
+                    ||  dwRead < sizeof(JOURNALENTRY)) {
+                break;
+            }
+            dwRead /= sizeof(JOURNALENTRY);
+            pJournal->ullJournalOffset += dwRead * sizeof(JOURNALENTRY);
+            AddToMemtable(pJournal->batch, dwRead);
+        }
+        CloseHandle(hFile);
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    AddToMemtable
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Merges the reads in, so the table stays sorted.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID AddToMemtable(PJOURNALENTRY pEntries,
+--                                        DWORD dwCount)
+--                          pEntries    - reads that have been journaled;
+--                                        they are sorted in place
+--                          dwCount     - the number of reads, which must fit
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Sorts the reads and merges them with the table in memory into
+--              the spare table, which then becomes the table. Lookups may be
+--              reading the old table, so only the swap is done under the lock.
+--              Writes the table out as a run if that fills it.
+------------------------------------------------------------------------------*/
+static VOID AddToMemtable(PJOURNALENTRY pEntries, DWORD dwCount) {
+    PJOURNAL        pJournal    = &journal;
+    PJOURNALENTRY   pOld        = journal.pMemtable;
+    PJOURNALENTRY   pNew        = journal.pSpare;
+    DWORD           dwOld       = journal.dwMemtable;
+    DWORD           i           = 0;
+    DWORD           j           = 0;
+    DWORD           k           = 0;
+
+    qsort(pEntries, dwCount, sizeof(JOURNALENTRY), CompareEntries);
+    while (i < dwOld  ||  j < dwCount) {
+        if (j == dwCount  ||  (i < dwOld  &&  
+                               CompareEntries(&pOld[i], &pEntries[j]) <= 0)) {
+            pNew[k++] = pOld[i++];
+        } else {
+            pNew[k++] = pEntries[j++];
+        }
+    }
+
+    EnterCriticalSection(&pJournal->cs);
+    pJournal->pMemtable     = pNew;
+    pJournal->pSpare        = pOld;
+    pJournal->dwMemtable    = k;
+    LeaveCriticalSection(&pJournal->cs);
+
+    if (pJournal->dwMemtable == JOURNAL_MEMTABLE) {
+        FlushMemtable();
+        CompactRuns();
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FlushMemtable
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              The table is already sorted, so it is written as it is.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID FlushMemtable(VOID)
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Writes the table in memory as a level 0 run. Lookups only read
+--              the table, so they go on using it meanwhile. The table is
+--              emptied even if the run can't be written. Its reads then stay
+--              in the journal, but are left out of the index, since the next
+--              run covers the journal past them.
+------------------------------------------------------------------------------*/
+static VOID FlushMemtable(VOID) {
+    PJOURNAL    pJournal    = &journal;
+    PRUNWRITER  pWriter     = &journal.writer;
+    PJOURNALRUN pRun        = NULL;
+    DWORD       i           = 0;
+
+    if (pJournal->dwMemtable == 0) {
+        return;
+    }
+    if (pJournal->dwRuns < JOURNAL_MAX_RUNS
+            &&  OpenRunWriter(pWriter, 0, pJournal->dwMemtable)) {
+        for (i = 0; i < pJournal->dwMemtable; i++) {
+            AddToRun(pWriter, &pJournal->pMemtable[i]);
+        }
+        pWriter->header.ullFirstRun         = pJournal->ullNextRun;
+        pWriter->header.ullLastRun          = pJournal->ullNextRun;
+        pWriter->header.dwJournalDay        = pJournal->dwJournalDay;
+        pWriter->header.ullJournalOffset    = pJournal->ullJournalOffset;
+        if ((pRun = FinishRun(pWriter)) != NULL) {
+            pJournal->ullNextRun++;
+        }
+    }
+
+    EnterCriticalSection(&pJournal->cs);
+    if (pRun != NULL) {
+        pJournal->pRuns[pJournal->dwRuns++] = pRun;
+    }
+    pJournal->dwMemtable = 0;
+    LeaveCriticalSection(&pJournal->cs);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CompactRuns
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Releases expired runs rather than freeing them, since a
+--              lookup may be reading one.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID CompactRuns(VOID)
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Deletes runs that only hold expired reads, then merges the
+--              oldest JOURNAL_FANIN runs of the lowest level that has that
+--              many, until no level does. Runs reach a level in the order of
+--              the level 0 runs they came from, so the runs merged always
+--              cover a continuous stretch of the journal.
+------------------------------------------------------------------------------*/
+static VOID CompactRuns(VOID) {
+    PJOURNAL    pJournal                    = &journal;
+    PJOURNALRUN pInputs[JOURNAL_FANIN]      = {0};
+    PJOURNALRUN pRun                        = NULL;
+    ULONGLONG   ullCutoff                   = 0;
+    DWORD       dwLevel                     = 0;
+    DWORD       dwInputs                    = 0;
+    DWORD       i                           = 0;
+    DWORD       j                           = 0;
+
+    ullCutoff = GetUtcNow() - pJournal->dwDays * JOURNAL_DAY;
+    for (i = 0; i < pJournal->dwRuns; i++) {
+        pRun = pJournal->pRuns[i];
+        if (pRun->pHeader->ullNewest < ullCutoff) {
+            ReplaceRuns(&pRun, 1, NULL);
+            ReleaseRun(pRun, TRUE);
+            i--;
+        }
+    }
+
+    for (dwLevel = 0; dwLevel < 32  &&  !pJournal->bStop; dwLevel++) {
+        dwInputs = 0;
+        for (i = 0; i < pJournal->dwRuns; i++) {
+            pRun = pJournal->pRuns[i];
+            if (pRun->pHeader->dwLevel != dwLevel) {
+                continue;
+            }
+            // keep the JOURNAL_FANIN oldest, in order
+            for (j = dwInputs; j > 0  &&  pInputs[j - 1]->pHeader->ullFirstRun
+                                          > pRun->pHeader->ullFirstRun; j--) {
+                if (j < JOURNAL_FANIN) {
+                    pInputs[j] = pInputs[j - 1];
+                }
+            }
+            if (j < JOURNAL_FANIN) {
+                pInputs[j] = pRun;
+                dwInputs = min(dwInputs + 1, JOURNAL_FANIN);
+            }
+        }
+        if (dwInputs < JOURNAL_FANIN) {
+            continue;
+        }
+        if (!MergeRuns(pInputs, dwInputs, dwLevel + 1, ullCutoff)) {
+            return;
+        }
+        // start again from level 0, since a level may have had more
+        dwLevel = MAXDWORD;
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    MergeRuns
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Releases the old runs rather than freeing them, since a
+--              lookup may be reading one.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static BOOL MergeRuns(PJOURNALRUN* ppInputs, DWORD dwInputs,
+--                                    DWORD dwLevel, ULONGLONG ullCutoff)
+--                          ppInputs    - the runs to merge
+--                          dwInputs    - the number of runs
+--                          dwLevel     - the level of the new run
+--                          ullCutoff   - reads before this are dropped
+--
+-- RETURNS:     False if the new run couldn't be written.
+--
+-- NOTES:
+--              Merges the sorted runs into one, and swaps it in for them. The
+--              old runs are deleted once the new one is in place; if that is
+--              cut short, LoadRuns() finishes it.
+------------------------------------------------------------------------------*/
+static BOOL MergeRuns(PJOURNALRUN* ppInputs, DWORD dwInputs, DWORD dwLevel,
+                      ULONGLONG ullCutoff) {
+    PRUNWRITER          pWriter                 = &journal.writer;
+    PJOURNALRUNHEADER   pHeader                 = NULL;
+    PJOURNALRUNHEADER   pOut                    = NULL;
+    PJOURNALENTRY       pNext                   = NULL;
+    PJOURNALENTRY       pHead                   = NULL;
+    PJOURNALRUN         pRun                    = NULL;
+    ULONGLONG           ullPos[JOURNAL_FANIN]   = {0};
+    ULONGLONG           ullBound                = 0;
+    DWORD               dwNext                  = 0;
+    DWORD               i                       = 0;
+
+    for (i = 0; i < dwInputs; i++) {
+        ullBound += ppInputs[i]->pHeader->ullCount;
+    }
+    if (!OpenRunWriter(pWriter, dwLevel, ullBound)) {
+        return FALSE;
+    }
+
+    for (;;) {
+        pNext = NULL;
+        for (i = 0; i < dwInputs; i++) {
+            if (ullPos[i] == ppInputs[i]->pHeader->ullCount) {
+                continue;
+            }
+            pHead = &ppInputs[i]->pEntries[ullPos[i]];
+            if (pNext == NULL  ||  CompareEntries(pHead, pNext) < 0) {
+                pNext   = pHead;
+                dwNext  = i;
+            }
+        }
+        if (pNext == NULL) {
+            break;
+        }
+        ullPos[dwNext]++;
+        if (pNext->ullTime >= ullCutoff) {
+            AddToRun(pWriter, pNext);
+        }
+    }
+
+    pOut = &pWriter->header;
+    pOut->ullFirstRun = MAXUINT64;
+    for (i = 0; i < dwInputs; i++) {
+        pHeader = ppInputs[i]->pHeader;
+        pOut->ullFirstRun = min(pOut->ullFirstRun, pHeader->ullFirstRun);
+        pOut->ullLastRun  = max(pOut->ullLastRun, pHeader->ullLastRun);
+        if (pHeader->dwJournalDay > pOut->dwJournalDay
+                ||  (pHeader->dwJournalDay == pOut->dwJournalDay
+                     &&  pHeader->ullJournalOffset > pOut->ullJournalOffset)) {
+            pOut->dwJournalDay      = pHeader->dwJournalDay;
+            pOut->ullJournalOffset  = pHeader->ullJournalOffset;
+        }
+    }
+    if (pOut->ullCount > 0) {
+        if ((pRun = FinishRun(pWriter)) == NULL) {
+            return FALSE;
+        }
+    } else {
+        // everything had expired
+        FinishRun(pWriter);
+    }
+
+    ReplaceRuns(ppInputs, dwInputs, pRun);
+    for (i = 0; i < dwInputs; i++) {
+        ReleaseRun(ppInputs[i], TRUE);
+    }
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    OpenRunWriter
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static BOOL OpenRunWriter(PRUNWRITER pWriter, DWORD dwLevel,
+--                                        ULONGLONG ullBound)
+--                          pWriter     - the writer to start
+--                          dwLevel     - the level of the new run
+--                          ullBound    - the most entries it will hold
+--
+-- RETURNS:     False if the temporary file couldn't be created.
+--
+-- NOTES:
+--              Sizes the Bloom filter for JOURNAL_BLOOM_BITS bits per entry,
+--              rounded up to a power of two blocks, and leaves room for it and
+--              the header at the start of the file.
+------------------------------------------------------------------------------*/
+static BOOL OpenRunWriter(PRUNWRITER pWriter, DWORD dwLevel,
+                          ULONGLONG ullBound) {
+    LARGE_INTEGER   liStart = {0};
+
+    ZeroMemory(&pWriter->header, sizeof(JOURNALRUNHEADER));
+    pWriter->header.dwMagic     = JOURNAL_MAGIC;
+    pWriter->header.dwVersion   = JOURNAL_VERSION;
+    pWriter->header.dwLevel     = dwLevel;
+    pWriter->header.ullOldest   = MAXUINT64;
+    while (pWriter->header.dwBloomShift < JOURNAL_MAX_SHIFT
+            &&  (JOURNAL_BLOCK * 8ULL << pWriter->header.dwBloomShift)
+                < ullBound * JOURNAL_BLOOM_BITS) {
+        pWriter->header.dwBloomShift++;
+    }
+    pWriter->dwBuffered = 0;
+    pWriter->bFailed    = FALSE;
+
+    pWriter->pbBloom    = (BYTE*) calloc((SIZE_T) JOURNAL_BLOCK
+                                         << pWriter->header.dwBloomShift, 1);
+    pWriter->pullFences = (ULONGLONG*) malloc((SIZE_T) (ullBound
+                                                        / JOURNAL_GROUP + 1)
+                                              * sizeof(ULONGLONG));
+    wsprintf(pWriter->szTemp, TEXT("%s\\run.tmp"), journal.szDirectory);
+    pWriter->hFile = CreateFile(pWriter->szTemp, GENERIC_WRITE, 0, NULL,
+                                CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (pWriter->pbBloom == NULL  ||  pWriter->pullFences == NULL
+            ||  pWriter->hFile == INVALID_HANDLE_VALUE) {
+        pWriter->bFailed = TRUE;
+        FinishRun(pWriter);
+        return FALSE;
+    }
+    liStart.QuadPart = sizeof(JOURNALRUNHEADER)
+                     + ((LONGLONG) JOURNAL_BLOCK
+                        << pWriter->header.dwBloomShift);
+    SetFilePointerEx(pWriter->hFile, liStart, NULL, FILE_BEGIN);
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    AddToRun
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID AddToRun(PRUNWRITER pWriter, PJOURNALENTRY pEntry)
+--                          pWriter - an open writer
+--                          pEntry  - the next entry, in UID and time order
+--
+-- RETURNS:     VOID.
+------------------------------------------------------------------------------*/
+static VOID AddToRun(PRUNWRITER pWriter, PJOURNALENTRY pEntry) {
+    PJOURNALRUNHEADER   pHeader     = &pWriter->header;
+    BYTE*               pbBlock     = NULL;
+    ULONGLONG           ullBits     = 0;
+    DWORD               dwBit       = 0;
+    DWORD               dwWritten   = 0;
+    DWORD               i           = 0;
+
+    if (pHeader->ullCount % JOURNAL_GROUP == 0) {
+        pWriter->pullFences[pHeader->ullGroups++] = pEntry->ullUid;
+    }
+    pbBlock = pWriter->pbBloom + JOURNAL_BLOCK
+            * GetBloomBlock(pEntry->ullUid, pHeader->dwBloomShift, &ullBits);
+    for (i = 0; i < JOURNAL_HASHES; i++) {
+        dwBit = (DWORD) (ullBits >> (9 * i)) & (JOURNAL_BLOCK * 8 - 1);
+        pbBlock[dwBit >> 3] |= 1 << (dwBit & 7);
+    }
+    pHeader->ullOldest = min(pHeader->ullOldest, pEntry->ullTime);
+    pHeader->ullNewest = max(pHeader->ullNewest, pEntry->ullTime);
+    pHeader->ullCount++;
+
+    pWriter->buffer[pWriter->dwBuffered++] = *pEntry;
+    if (pWriter->dwBuffered == JOURNAL_WRITE_BUF) {
+        if (!WriteFile(pWriter->hFile, pWriter->buffer,
+                       sizeof(pWriter->buffer), &dwWritten, NULL)) {
+            pWriter->bFailed = TRUE;
+        }
+        pWriter->dwBuffered = 0;
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FinishRun
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static PJOURNALRUN FinishRun(PRUNWRITER pWriter)
+--                          pWriter - a writer, open or failed
+--
+-- RETURNS:     The new run, mapped, or NULL if it failed or is empty.
+--
+-- NOTES:
+--              Writes the fences, the header and the Bloom filter, and renames
+--              the file into place, as L<level>-<last level 0 run>.idx.
+------------------------------------------------------------------------------*/
+static PJOURNALRUN FinishRun(PRUNWRITER pWriter) {
+    PJOURNALRUNHEADER   pHeader             = &pWriter->header;
+    TCHAR               szFile[MAX_PATH]    = {0};
+    LARGE_INTEGER       liStart             = {0};
+    DWORD               dwBloom             = 0;
+    DWORD               dwWritten           = 0;
+    BOOL                bResult             = !pWriter->bFailed;
+
+    dwBloom = JOURNAL_BLOCK << pHeader->dwBloomShift;
+    if (pWriter->hFile != INVALID_HANDLE_VALUE) {
+        pHeader->ullFences = sizeof(JOURNALRUNHEADER) + dwBloom
+                           + pHeader->ullCount * sizeof(JOURNALENTRY);
+        bResult = bResult
+               && WriteFile(pWriter->hFile, pWriter->buffer,
+                            pWriter->dwBuffered * sizeof(JOURNALENTRY),
+                            &dwWritten, NULL)
+               && WriteFile(pWriter->hFile, pWriter->pullFences,
+                            (DWORD) (pHeader->ullGroups * sizeof(ULONGLONG)),
+                            &dwWritten, NULL)
+               && SetFilePointerEx(pWriter->hFile, liStart, NULL, FILE_BEGIN)
+               && WriteFile(pWriter->hFile, pHeader, sizeof(JOURNALRUNHEADER),
+                            &dwWritten, NULL)
+               && WriteFile(pWriter->hFile, pWriter->pbBloom, dwBloom,
+                            &dwWritten, NULL);
+        CloseHandle(pWriter->hFile);
+        pWriter->hFile = INVALID_HANDLE_VALUE;
+    }
+    free(pWriter->pbBloom);
+    free(pWriter->pullFences);
+    pWriter->pbBloom    = NULL;
+    pWriter->pullFences = NULL;
+
+    wsprintf(szFile, TEXT("%s\\L%u-%08X%08X.idx"), journal.szDirectory,
+             pHeader->dwLevel, (DWORD) (pHeader->ullLastRun >> 32),
+             (DWORD) pHeader->ullLastRun);
+    if (!bResult  ||  pHeader->ullCount == 0
+            ||  !MoveFileEx(pWriter->szTemp, szFile,
+                            MOVEFILE_REPLACE_EXISTING
+                            | MOVEFILE_WRITE_THROUGH)) {
+        DeleteFile(pWriter->szTemp);
+        return NULL;
+    }
+    return LoadRun(szFile);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    LoadRuns
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID LoadRuns(VOID)
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Maps every run in the directory. A run made from level 0 runs
+--              that another run was also made from, by a later merge, was that
+--              merge's input, and is deleted.
+------------------------------------------------------------------------------*/
+static VOID LoadRuns(VOID) {
+    PJOURNAL            pJournal            = &journal;
+    WIN32_FIND_DATA     fd                  = {0};
+    HANDLE              hFind               = INVALID_HANDLE_VALUE;
+    TCHAR               szFile[MAX_PATH]    = {0};
+    PJOURNALRUN         pRun                = NULL;
+    PJOURNALRUNHEADER   pA                  = NULL;
+    PJOURNALRUNHEADER   pB                  = NULL;
+    DWORD               i                   = 0;
+    DWORD               j                   = 0;
+
+    wsprintf(szFile, TEXT("%s\\run.tmp"), pJournal->szDirectory);
+    DeleteFile(szFile);
+    wsprintf(szFile, TEXT("%s\\L*.idx"), pJournal->szDirectory);
+    if ((hFind = FindFirstFile(szFile, &fd)) != INVALID_HANDLE_VALUE) {
+        do {
+            wsprintf(szFile, TEXT("%s\\%s"), pJournal->szDirectory,
+                     fd.cFileName);
+            if (pJournal->dwRuns < JOURNAL_MAX_RUNS
+                    &&  (pRun = LoadRun(szFile)) != NULL) {
+                pJournal->pRuns[pJournal->dwRuns++] = pRun;
+            }
+        } while (FindNextFile(hFind, &fd));
+        FindClose(hFind);
+    }
+
+    for (i = 0; i < pJournal->dwRuns; i++) {
+        pA = pJournal->pRuns[i]->pHeader;
+        for (j = 0; j < pJournal->dwRuns; j++) {
+            pB = pJournal->pRuns[j]->pHeader;
+            if (pB->dwLevel > pA->dwLevel
+                    &&  pB->ullFirstRun <= pA->ullFirstRun
+                    &&  pB->ullLastRun >= pA->ullLastRun) {
+                break;
+            }
+        }
+        if (j < pJournal->dwRuns) {
+            FreeRun(pJournal->pRuns[i], TRUE);
+            pJournal->pRuns[i--] = pJournal->pRuns[--pJournal->dwRuns];
+        }
+    }
+    for (i = 0; i < pJournal->dwRuns; i++) {
+        pJournal->ullNextRun = max(pJournal->ullNextRun,
+                                   pJournal->pRuns[i]->pHeader->ullLastRun + 1);
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    LoadRun
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Starts the run with the list's reference.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static PJOURNALRUN LoadRun(LPCTSTR lpszFile)
+--                          lpszFile - the run file
+--
+-- RETURNS:     The mapped run, or NULL if it couldn't be mapped or isn't a
+--              valid run.
+--
+-- NOTES:
+--              Maps the whole file read-only, checks its size against its
+--              header, and copies the fences.
+------------------------------------------------------------------------------*/
+static PJOURNALRUN LoadRun(LPCTSTR lpszFile) {
+    PJOURNALRUN         pRun        = NULL;
+    PJOURNALRUNHEADER   pHeader     = NULL;
+    LARGE_INTEGER       liSize      = {0};
+    ULONGLONG           ullBloom    = 0;
+
+    if ((pRun = (PJOURNALRUN) calloc(1, sizeof(JOURNALRUN))) == NULL) {
+        return NULL;
+    }
+    lstrcpyn(pRun->szFile, lpszFile, MAX_PATH);
+    pRun->hFile = CreateFile(lpszFile, GENERIC_READ,
+                             FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (pRun->hFile == INVALID_HANDLE_VALUE
+            ||  !GetFileSizeEx(pRun->hFile, &liSize)
+            ||  liSize.QuadPart < sizeof(JOURNALRUNHEADER)) {
+        FreeRun(pRun, FALSE);
+        return NULL;
+    }
+    pRun->hMap = CreateFileMapping(pRun->hFile, NULL, PAGE_READONLY, 0, 0,
+                                   NULL);
+    if (pRun->hMap == NULL  ||  (pRun->pbBase = (BYTE*) MapViewOfFile(
+                                     pRun->hMap, FILE_MAP_READ, 0, 0, 0))
+                                == NULL) {
+        FreeRun(pRun, FALSE);
+        return NULL;
+    }
+
+    pHeader  = (PJOURNALRUNHEADER) pRun->pbBase;
+    ullBloom = (ULONGLONG) JOURNAL_BLOCK
+             << min(pHeader->dwBloomShift, JOURNAL_MAX_SHIFT);
+    if (pHeader->dwMagic != JOURNAL_MAGIC
+            ||  pHeader->dwVersion != JOURNAL_VERSION
+            ||  pHeader->dwBloomShift > JOURNAL_MAX_SHIFT
+            ||  pHeader->ullGroups != (pHeader->ullCount + JOURNAL_GROUP - 1)
+                                      / JOURNAL_GROUP
+            ||  pHeader->ullFences != sizeof(JOURNALRUNHEADER) + ullBloom
+                                      + pHeader->ullCount
+                                        * sizeof(JOURNALENTRY)
+            ||  (ULONGLONG) liSize.QuadPart != pHeader->ullFences
+                                      + pHeader->ullGroups
+                                        * sizeof(ULONGLONG)) {
+        FreeRun(pRun, FALSE);
+        return NULL;
+    }
+    pRun->pullFences = (ULONGLONG*) malloc((SIZE_T) pHeader->ullGroups
+                                           * sizeof(ULONGLONG) + 1);
+    if (pRun->pullFences == NULL) {
+        FreeRun(pRun, FALSE);
+        return NULL;
+    }
+    memcpy(pRun->pullFences, pRun->pbBase + pHeader->ullFences,
+           (SIZE_T) pHeader->ullGroups * sizeof(ULONGLONG));
+
+    pRun->pHeader   = pHeader;
+    pRun->pbBloom   = pRun->pbBase + sizeof(JOURNALRUNHEADER);
+    pRun->pEntries  = (PJOURNALENTRY) (pRun->pbBloom + ullBloom);
+    pRun->lRefs     = 1;
+    return pRun;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FreeRun
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID FreeRun(PJOURNALRUN pRun, BOOL bDelete)
+--                          pRun    - a run from LoadRun(), or NULL
+--                          bDelete - whether to delete its file too
+--
+-- RETURNS:     VOID.
+------------------------------------------------------------------------------*/
+static VOID FreeRun(PJOURNALRUN pRun, BOOL bDelete) {
+    if (pRun == NULL) {
+        return;
+    }
+    if (pRun->pbBase != NULL) {
+        UnmapViewOfFile(pRun->pbBase);
+    }
+    if (pRun->hMap != NULL) {
+        CloseHandle(pRun->hMap);
+    }
+    if (pRun->hFile != INVALID_HANDLE_VALUE  &&  pRun->hFile != NULL) {
+        CloseHandle(pRun->hFile);
+    }
+    if (bDelete) {
+        DeleteFile(pRun->szFile);
+    }
+    free(pRun->pullFences);
+    free(pRun);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ReleaseRun
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID ReleaseRun(PJOURNALRUN pRun, BOOL bDelete)
+--                          pRun    - a run with a reference held on it
+--                          bDelete - whether its file should be deleted once
+--                                    it is freed
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Drops a reference. The list holds one while the run is in it,
+--              and QueryJournal() holds one while it searches it. The last
+--              one frees the run, deleting its file if anyone asked to.
+------------------------------------------------------------------------------*/
+static VOID ReleaseRun(PJOURNALRUN pRun, BOOL bDelete) {
+    if (bDelete) {
+        pRun->bDelete = TRUE;
+    }
+    if (InterlockedDecrement(&pRun->lRefs) == 0) {
+        FreeRun(pRun, pRun->bDelete);
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ReplaceRuns
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              No longer frees anything; see ReleaseRun().
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID ReplaceRuns(PJOURNALRUN* ppOld, DWORD dwOld,
+--                                      PJOURNALRUN pNew)
+--                          ppOld   - the runs to take out of the list
+--                          dwOld   - the number of runs
+--                          pNew    - the run to put in, or NULL
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Changes the list under the lock. The list's reference to each
+--              old run is the caller's to release; a lookup may still be
+--              reading it.
+------------------------------------------------------------------------------*/
+static VOID ReplaceRuns(PJOURNALRUN* ppOld, DWORD dwOld, PJOURNALRUN pNew) {
+    PJOURNAL    pJournal    = &journal;
+    DWORD       i           = 0;
+    DWORD       j           = 0;
+
+    EnterCriticalSection(&pJournal->cs);
+    for (i = 0; i < pJournal->dwRuns; i++) {
+        for (j = 0; j < dwOld; j++) {
+            if (pJournal->pRuns[i] == ppOld[j]) {
+                pJournal->pRuns[i--] = pJournal->pRuns[--pJournal->dwRuns];
+                break;
+            }
+        }
+    }
+    if (pNew != NULL) {
+        pJournal->pRuns[pJournal->dwRuns++] = pNew;
+    }
+    LeaveCriticalSection(&pJournal->cs);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FindInRun
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID FindInRun(PJOURNALRUN pRun, ULONGLONG ullUid,
+--                                    ULONGLONG ullSince,
+--                                    PJOURNALENTRY pEntries, DWORD dwMax,
+--                                    DWORD* pdwFound, DWORD* pdwTotal)
+--                          pRun        - the run to look in
+--                          ullUid      - the packed UID
+--                          ullSince    - the earliest read wanted
+--                          pEntries    - the latest reads found so far
+--                          dwMax       - the size of pEntries
+--                          pdwFound    - the number in pEntries
+--                          pdwTotal    - the number of reads found
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Skips the run if it is too old or its Bloom filter rules the
+--              UID out. Otherwise the fences give the group the UID's entries
+--              start in, and they are read from there.
+------------------------------------------------------------------------------*/
+static VOID FindInRun(PJOURNALRUN pRun, ULONGLONG ullUid, ULONGLONG ullSince,
+                      PJOURNALENTRY pEntries, DWORD dwMax, DWORD* pdwFound,
+                      DWORD* pdwTotal) {
+    PJOURNALRUNHEADER   pHeader = pRun->pHeader;
+    PJOURNALENTRY       pEntry  = NULL;
+    BYTE*               pbBlock = NULL;
+    ULONGLONG           ullBits = 0;
+    ULONGLONG           ullLow  = 0;
+    ULONGLONG           ullHigh = 0;
+    ULONGLONG           ullMid  = 0;
+    ULONGLONG           i       = 0;
+    DWORD               dwBit   = 0;
+
+    if (pHeader->ullNewest < ullSince) {
+        return;
+    }
+    pbBlock = pRun->pbBloom + JOURNAL_BLOCK
+            * GetBloomBlock(ullUid, pHeader->dwBloomShift, &ullBits);
+    for (i = 0; i < JOURNAL_HASHES; i++) {
+        dwBit = (DWORD) (ullBits >> (9 * i)) & (JOURNAL_BLOCK * 8 - 1);
+        if (!(pbBlock[dwBit >> 3] & (1 << (dwBit & 7)))) {
+            return;
+        }
+    }
+
+    // the first group that starts at or after the UID
+    ullHigh = pHeader->ullGroups;
+    while (ullLow < ullHigh) {
+        ullMid = (ullLow + ullHigh) / 2;
+        if (pRun->pullFences[ullMid] < ullUid) {
+            ullLow = ullMid + 1;
+        } else {
+            ullHigh = ullMid;
+        }
+    }
+    // the UID's entries may start at the end of the group before it
+    i = (ullLow > 0) ? (ullLow - 1) * JOURNAL_GROUP : 0;
+    for (; i < pHeader->ullCount; i++) {
+        pEntry = &pRun->pEntries[i];
+        if (pEntry->ullUid < ullUid) {
+            continue;
+        }
+        if (pEntry->ullUid > ullUid) {
+            break;
+        }
+        if (pEntry->ullTime >= ullSince) {
+            (*pdwTotal)++;
+            AddResult(pEntries, dwMax, pdwFound, pEntry);
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    AddResult
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID AddResult(PJOURNALENTRY pEntries, DWORD dwMax,
+--                                    DWORD* pdwFound, PJOURNALENTRY pEntry)
+--                          pEntries    - the latest reads found so far
+--                          dwMax       - the size of pEntries
+--                          pdwFound    - the number in pEntries
+--                          pEntry      - another read of the UID
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Keeps the read if there is room, or if it is later than the
+--              earliest one kept, which it replaces.
+------------------------------------------------------------------------------*/
+static VOID AddResult(PJOURNALENTRY pEntries, DWORD dwMax, DWORD* pdwFound,
+                      PJOURNALENTRY pEntry) {
+    DWORD dwOldest  = 0;
+    DWORD i         = 0;
+
+    if (*pdwFound < dwMax) {
+        pEntries[(*pdwFound)++] = *pEntry;
+        return;
+    }
+    for (i = 1; i < dwMax; i++) {
+        if (pEntries[i].ullTime < pEntries[dwOldest].ullTime) {
+            dwOldest = i;
+        }
+    }
+    if (dwMax > 0  &&  pEntry->ullTime > pEntries[dwOldest].ullTime) {
+        pEntries[dwOldest] = *pEntry;
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetBloomBlock
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static ULONGLONG GetBloomBlock(ULONGLONG ullUid,
+--                                             DWORD dwShift,
+--                                             ULONGLONG* pullBits)
+--                          ullUid      - the packed UID
+--                          dwShift     - log2 of the blocks in the filter
+--                          pullBits    - receives the UID's bits in the block,
+--                                        9 bits each
+--
+-- RETURNS:     The UID's block.
+------------------------------------------------------------------------------*/
+static ULONGLONG GetBloomBlock(ULONGLONG ullUid, DWORD dwShift,
+                               ULONGLONG* pullBits) {
+    ULONGLONG ullHash = HashUid(ullUid);
+
+    *pullBits = HashUid(ullHash);
+    return (ullHash >> 32) & ((1ULL << dwShift) - 1);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetJournalName
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID GetJournalName(DWORD dwDay, LPTSTR lpszName)
+--                          dwDay       - days since 1601, in UTC
+--                          lpszName    - receives the day's journal file name
+--
+-- RETURNS:     VOID.
+------------------------------------------------------------------------------*/
+static VOID GetJournalName(DWORD dwDay, LPTSTR lpszName) {
+    ULARGE_INTEGER  uli = {0};
+    FILETIME        ft  = {0};
+    SYSTEMTIME      st  = {0};
+
+    uli.QuadPart        = dwDay * JOURNAL_DAY;
+    ft.dwLowDateTime    = uli.LowPart;
+    ft.dwHighDateTime   = uli.HighPart;
+    FileTimeToSystemTime(&ft, &st);
+    wsprintf(lpszName, TEXT("reads-%04u%02u%02u.jnl"), st.wYear, st.wMonth,
+             st.wDay);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    DeleteOldJournals
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID DeleteOldJournals(DWORD dwDay)
+--                          dwDay - today
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Deletes the journal files more than Days old. The names sort
+--              by date, so they are compared as strings.
+------------------------------------------------------------------------------*/
+static VOID DeleteOldJournals(DWORD dwDay) {
+    PJOURNAL        pJournal            = &journal;
+    WIN32_FIND_DATA fd                  = {0};
+    HANDLE          hFind               = INVALID_HANDLE_VALUE;
+    TCHAR           szOldest[32]        = {0};
+    TCHAR           szFile[MAX_PATH]    = {0};
+
+    GetJournalName(dwDay - pJournal->dwDays, szOldest);
+    wsprintf(szFile, TEXT("%s\\reads-*.jnl"), pJournal->szDirectory);
+    if ((hFind = FindFirstFile(szFile, &fd)) == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    do {
+        if (lstrcmpi(fd.cFileName, szOldest) < 0) {
+            wsprintf(szFile, TEXT("%s\\%s"), pJournal->szDirectory,
+                     fd.cFileName);
+            DeleteFile(szFile);
+        }
+    } while (FindNextFile(hFind, &fd));
+    FindClose(hFind);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetUtcNow
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static ULONGLONG GetUtcNow(VOID)
+--
+-- RETURNS:     The current time, as a FILETIME in UTC.
+------------------------------------------------------------------------------*/
+static ULONGLONG GetUtcNow(VOID) {
+    FILETIME        ft  = {0};
+    ULARGE_INTEGER  uli = {0};
+
+    GetSystemTimeAsFileTime(&ft);
+    uli.LowPart     = ft.dwLowDateTime;
+    uli.HighPart    = ft.dwHighDateTime;
+    return uli.QuadPart;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CompareEntries
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static INT CompareEntries(const VOID* pA, const VOID* pB)
+--                          pA  - a journal entry
+--                          pB  - another journal entry
+--
+-- RETURNS:     Less than, equal to, or greater than 0 as pA's UID, and then
+--              time, is less than, equal to, or greater than pB's.
+------------------------------------------------------------------------------*/
+static INT CompareEntries(const VOID* pA, const VOID* pB) {
+    const JOURNALENTRY* pEntryA = (const JOURNALENTRY*) pA;
+    const JOURNALENTRY* pEntryB = (const JOURNALENTRY*) pB;
+
+    if (pEntryA->ullUid != pEntryB->ullUid) {
+        return (pEntryA->ullUid < pEntryB->ullUid) ? -1 : 1;
+    }
+    return (pEntryA->ullTime > pEntryB->ullTime)
+         - (pEntryA->ullTime < pEntryB->ullTime);
+}
@@ -0,0 +1,110 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <Windows.h>
+#include "Tag.h"
+
+#define JOURNAL_PENDING     16384   // reads waiting to be written
+#define JOURNAL_MEMTABLE    65536   // reads indexed in memory before a run
+#define JOURNAL_FLUSH       1000    // ms between writes to the journal
+#define JOURNAL_DAYS        30      // days of reads kept
+#define JOURNAL_DAY         864000000000ULL     // FILETIME ticks in a day
+#define JOURNAL_MAX_RUNS    64
+#define JOURNAL_FANIN       4       // runs on a level that are compacted
+#define JOURNAL_GROUP       170     // entries per fence, about one page
+#define JOURNAL_BLOOM_BITS  10      // Bloom filter bits per entry
+#define JOURNAL_HASHES      7       // Bloom filter bits set per UID
+#define JOURNAL_BLOCK       64      // bytes in a Bloom filter block
+#define JOURNAL_MAX_SHIFT   25      // the most blocks, 2^25 (2 GB)
+#define JOURNAL_WRITE_BUF   1024    // entries buffered by a run writer
+#define JOURNAL_SHOWN       20
+#define JOURNAL_MAGIC       0x58444955  // "UIDX"
+#define JOURNAL_VERSION     1
+
+// A read, as it is written to the journal and to the index.
+typedef struct journalEntry {
+    ULONGLONG   ullUid;         // see PackUid()
+    ULONGLONG   ullTime;        // a FILETIME, in UTC
+    DWORD       dwReader;
+    BYTE        bType;
+    BYTE        bMatch;
+    WORD        wReserved;
+} JOURNALENTRY, *PJOURNALENTRY;
+
+// A run file is the header, the Bloom filter, the entries sorted by UID and
+// time, and then the first UID of every JOURNAL_GROUP entries.
+typedef struct journalRunHeader {
+    DWORD       dwMagic;
+    DWORD       dwVersion;
+    DWORD       dwLevel;
+    DWORD       dwBloomShift;       // log2 of the blocks in the Bloom filter
+    ULONGLONG   ullCount;
+    ULONGLONG   ullGroups;
+    ULONGLONG   ullFences;          // the offset of the fences
+    ULONGLONG   ullOldest;
+    ULONGLONG   ullNewest;
+    ULONGLONG   ullFirstRun;        // the level 0 runs it was made from
+    ULONGLONG   ullLastRun;
+    DWORD       dwJournalDay;       // the journal up to here is in the run,
+    DWORD       dwReserved;         // or in an older one
+    ULONGLONG   ullJournalOffset;
+} JOURNALRUNHEADER, *PJOURNALRUNHEADER;
+
+typedef struct journalRun {
+    TCHAR               szFile[MAX_PATH];
+    HANDLE              hFile;
+    HANDLE              hMap;
+    BYTE*               pbBase;
+    PJOURNALRUNHEADER   pHeader;
+    BYTE*               pbBloom;
+    PJOURNALENTRY       pEntries;
+    LONG                lRefs;          // the list's, and each lookup's
+    BOOL                bDelete;        // delete the file with the last one
+    ULONGLONG*          pullFences;     // copied, so a lookup only touches
+} JOURNALRUN, *PJOURNALRUN;             // the Bloom filter and the entries
+
+typedef struct runWriter {
+    TCHAR               szTemp[MAX_PATH];
+    HANDLE              hFile;
+    JOURNALRUNHEADER    header;
+    BYTE*               pbBloom;
+    ULONGLONG*          pullFences;
+    JOURNALENTRY        buffer[JOURNAL_WRITE_BUF];
+    DWORD               dwBuffered;
+    BOOL                bFailed;
+} RUNWRITER, *PRUNWRITER;
+
+typedef struct journal {
+    CRITICAL_SECTION    cs;
+    BOOL                bEnabled;
+    TCHAR               szDirectory[MAX_PATH];
+    DWORD               dwDays;
+    HANDLE              hThread;
+    HANDLE              hWake;
+    volatile BOOL       bStop;
+    JOURNALENTRY        pending[JOURNAL_PENDING];   // from the strands
+    DWORD               dwPending;
+    JOURNALENTRY        batch[JOURNAL_PENDING];     // the thread's copy
+    PJOURNALENTRY       pMemtable;      // sorted by UID and time
+    DWORD               dwMemtable;
+    PJOURNALENTRY       pSpare;         // what the next table is merged into
+    RUNWRITER           writer;
+    HANDLE              hJournal;
+    DWORD               dwJournalDay;
+    ULONGLONG           ullJournalOffset;
+    PJOURNALRUN         pRuns[JOURNAL_MAX_RUNS];
+    DWORD               dwRuns;
+    ULONGLONG           ullNextRun;
+    ULONGLONG           ullLastUid;
+    BOOL                bHaveLast;
+    DWORD               dwDropped;
+} JOURNAL, *PJOURNAL;
+
+VOID    InitJournal(HWND hWnd);
+VOID    JournalTag(PTAGREAD pRead);
+DWORD   QueryJournal(ULONGLONG ullUid, ULONGLONG ullSince,
+                     PJOURNALENTRY pEntries, DWORD dwMax, DWORD* pdwTotal);
+VOID    ShowJournal(HWND hWnd);
+VOID    CloseJournal(VOID);
+
+#endif
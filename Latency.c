@@ -0,0 +1,240 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Latency.c - Contains the port settings that trade 
+--                              throughput for latency.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    InitLatencyProfile(HWND);
+--              BOOL    ApplyLatencyProfile(HWND);
+--              DWORD   GetReadLength(PLATENCY, DWORD, DWORD);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- The read thread normally asks for a whole buffer, and relies on the port's
+-- ReadIntervalTimeout to end the read once the line goes quiet. That batches
+-- bytes well, but every frame waits an extra interval (10 ms) before it is
+-- seen. There are two profiles, set in the [Latency] section of the 
+-- configuration file:
+--
+--      [Latency]
+--      Profile=throughput
+--      Interval=10
+--      LatencyTimer=1
+--
+-- "throughput" is the behaviour described above, with Interval as the
+-- ReadIntervalTimeout. "low" turns the read timeouts off, so a read only
+-- completes once it has every byte it asked for (like VMIN with VTIME=0), and
+-- sizes each read from the frame header: first the SOF and length bytes, then
+-- exactly the rest of the frame. A frame is then handed on as soon as its last
+-- byte is in, with a single read posted at a time.
+--
+-- USB-serial adapters hold on to received bytes too; FTDI's driver waits up to
+-- its latency timer (16 ms by default) before passing them on. In the "low"
+-- profile the LatencyTimer value is written to the adapter's device
+-- parameters, which needs administrator rights and takes effect the next time
+-- the driver loads the port (e.g. when the adapter is plugged in again).
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+#include <SetupAPI.h>
+
+#pragma comment(lib, "setupapi.lib")
+
+static DWORD SetLatencyTimer(LPCTSTR lpszPort, DWORD dwTimer);
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitLatencyProfile
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitLatencyProfile(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Reads the [Latency] settings from the configuration file.
+------------------------------------------------------------------------------*/
+VOID InitLatencyProfile(HWND hWnd) {
+    PWNDDATA    pwd             = NULL;
+    PLATENCY    pLatency        = NULL;
+    TCHAR       szProfile[16]   = {0};
+    pwd         = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pLatency    = &pwd->latency;
+
+    ReadConfigString(hWnd, TEXT("Latency"), TEXT("Profile"), 
+                     TEXT("throughput"), szProfile, 16);
+    
+    pLatency->bLowLatency   = (lstrcmpi(szProfile, TEXT("low")) == 0);
+    pLatency->dwInterval    = ReadConfigInt(hWnd, TEXT("Latency"), 
+                                            TEXT("Interval"), 
+                                            LATENCY_INTERVAL);
+    pLatency->dwTimer       = ReadConfigInt(hWnd, TEXT("Latency"),
+                                            TEXT("LatencyTimer"), 
+                                            LATENCY_TIMER);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ApplyLatencyProfile
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL ApplyLatencyProfile(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     False if the timeouts could not be set.
+--
+-- NOTES:
+--              Sets the port's read timeouts for the profile. This is done 
+--              just before the read thread starts, since NegotiateBaudRate()
+--              needs reads that end when the line goes quiet.
+------------------------------------------------------------------------------*/
+BOOL ApplyLatencyProfile(HWND hWnd) {
+    PWNDDATA        pwd         = NULL;
+    PLATENCY        pLatency    = NULL;
+    COMMTIMEOUTS    timeOut     = {0};
+    pwd         = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pLatency    = &pwd->latency;
+
+    timeOut.WriteTotalTimeoutConstant   = 5000;
+    if (!pLatency->bLowLatency) {
+        timeOut.ReadIntervalTimeout     = pLatency->dwInterval;
+    } else {
+        pLatency->dwDriverTimer = SetLatencyTimer(pwd->lpszCommName, 
+                                                  pLatency->dwTimer);
+    }
+    return SetCommTimeouts(pwd->hPort, &timeOut);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetReadLength
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   DWORD GetReadLength(PLATENCY pLatency, DWORD dwQueued,
+--                                  DWORD dwFrameLength)
+--                          pLatency        - the reader's latency profile
+--                          dwQueued        - bytes of the next frame already
+--                                            read
+--                          dwFrameLength   - the frame's length byte, if
+--                                            dwQueued covers it
+--
+-- RETURNS:     The number of bytes the next read should ask for.
+------------------------------------------------------------------------------*/
+DWORD GetReadLength(PLATENCY pLatency, DWORD dwQueued, DWORD dwFrameLength) {
+
+    if (!pLatency->bLowLatency) {
+        return TRANSPORT_BUFSIZE;
+    }
+    if (dwQueued < FRAME_HEADER_BYTES) {
+        return FRAME_HEADER_BYTES - dwQueued;
+    }
+    if (dwFrameLength <= dwQueued) {
+        // not a real frame; the read thread will skip past it
+        return 1;
+    }
+    return min(dwFrameLength - dwQueued, TRANSPORT_BUFSIZE);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    SetLatencyTimer
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static DWORD SetLatencyTimer(LPCTSTR lpszPort, DWORD dwTimer)
+--                          lpszPort    - the name of the port, e.g. "COM3"
+--                          dwTimer     - the latency timer to ask for, in ms
+--
+-- RETURNS:     The adapter's latency timer once this is done, or 0 if the port
+--              isn't on an FTDI adapter.
+--
+-- NOTES:
+--              Looks through the FTDI devices for the one whose PortName is
+--              lpszPort, and sets its LatencyTimer device parameter.
+------------------------------------------------------------------------------*/
+static DWORD SetLatencyTimer(LPCTSTR lpszPort, DWORD dwTimer) {
+    HDEVINFO        hDevInfo            = NULL;
+    SP_DEVINFO_DATA did                 = {0};
+    HKEY            hKey                = NULL;
+    TCHAR           szPortName[16]      = {0};
+    DWORD           dwSize              = 0;
+    DWORD           dwType              = 0;
+    DWORD           dwCurrent           = 0;
+    DWORD           i                   = 0;
+
+    hDevInfo = SetupDiGetClassDevs(NULL, TEXT("FTDIBUS"), NULL, 
+                                   DIGCF_ALLCLASSES | DIGCF_PRESENT);
+    if (hDevInfo == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    did.cbSize = sizeof(SP_DEVINFO_DATA);
+
+    for (i = 0; SetupDiEnumDeviceInfo(hDevInfo, i, &did); i++) {
+        
+        hKey = SetupDiOpenDevRegKey(hDevInfo, &did, DICS_FLAG_GLOBAL, 0,
+                                    DIREG_DEV, KEY_READ | KEY_SET_VALUE);
+        if (hKey == INVALID_HANDLE_VALUE) {
+            // not an administrator; we can still see what it's set to
+            hKey = SetupDiOpenDevRegKey(hDevInfo, &did, DICS_FLAG_GLOBAL, 0,
+                                        DIREG_DEV, KEY_READ);
+        }
+        if (hKey == INVALID_HANDLE_VALUE) {
+            continue;
+        }
+        dwSize = sizeof(szPortName) - sizeof(TCHAR);
+        ZeroMemory(szPortName, sizeof(szPortName));
+        
+        if (RegQueryValueEx(hKey, TEXT("PortName"), NULL, &dwType, 
+                            (LPBYTE) szPortName, &dwSize) == ERROR_SUCCESS  &&
+                lstrcmpi(szPortName, lpszPort) == 0) {
+            
+            dwSize = sizeof(DWORD);
+            RegQueryValueEx(hKey, TEXT("LatencyTimer"), NULL, &dwType,
+                            (LPBYTE) &dwCurrent, &dwSize);
+            if (dwCurrent != dwTimer  &&  
+                    RegSetValueEx(hKey, TEXT("LatencyTimer"), 0, REG_DWORD,
+                                  (const BYTE*) &dwTimer, sizeof(DWORD)) 
+                    == ERROR_SUCCESS) {
+                dwCurrent = dwTimer;
+            }
+            RegCloseKey(hKey);
+            break;
+        }
+        RegCloseKey(hKey);
+    }
+    SetupDiDestroyDeviceInfoList(hDevInfo);
+    return dwCurrent;
+}
@@ -0,0 +1,21 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <Windows.h>
+
+#define LATENCY_INTERVAL    10      // ms, ReadIntervalTimeout for throughput
+#define LATENCY_TIMER       1       // ms, the FTDI latency timer to ask for
+#define FRAME_HEADER_BYTES  3       // SOF and the two length bytes
+
+typedef struct latency {
+    BOOL    bLowLatency;
+    DWORD   dwInterval;
+    DWORD   dwTimer;
+    DWORD   dwDriverTimer;
+} LATENCY, *PLATENCY;
+
+VOID    InitLatencyProfile(HWND hWnd);
+BOOL    ApplyLatencyProfile(HWND hWnd);
+DWORD   GetReadLength(PLATENCY pLatency, DWORD dwQueued, DWORD dwFrameLength);
+
+#endif
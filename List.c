@@ -5,14 +5,25 @@
 -- PROGRAM:     RFID Reader - Enterprise Edition
 --
 -- FUNCTIONS:
---              DWORD   AddToBack(CHAR_LIST**, CHAR*, DWORD);
+--              DWORD   AddToBack(CHAR_LIST**, CHAR_LIST**, CHAR*, DWORD,
+--                                PARENA);
 --              DWORD   GetFromList(CHAR_LIST*, UINT);
---              CHAR*   RemoveFromFront(CHAR_LIST**, DWORD); 
+--              DWORD   FindInList(CHAR_LIST*, CHAR);
+--              CHAR*   RemoveFromFront(CHAR_LIST**, CHAR_LIST**, DWORD,
+--                                      PARENA);
+--              VOID    FreeList(CHAR_LIST**);
 --
 --
 -- DATE:        Nov 06, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              Nodes are recycled through a free list instead of being freed,
+--              and removed characters are returned in arena memory. Added
+--              FreeList().
+--              Oct 19, 2026
+--              Added FindInList().
+--              Oct 19, 2026
+--              A failed allocation no longer writes through a NULL pointer.
 --
 -- DESIGNER:    Dean Morin
 --
@@ -23,6 +34,10 @@
 -- buffer. The functions take or return entire strings of characters, and handle
 -- the conversion to a linked list internally. More specifically, the functions
 -- will treat the lists as queues.
+--
+-- Nodes removed from a list are pushed onto a second "free" list, and nodes
+-- are only allocated when that list is empty. Once the queue has reached its
+-- largest size, no further heap allocations are made.
 ------------------------------------------------------------------------------*/
 
 #include "List.h"
@@ -32,24 +47,34 @@
 --
 -- DATE:        Nov 06, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              Nodes are taken from pFree when possible.
+--              Oct 19, 2026
+--              Stops adding characters if a node can't be allocated.
 --
 -- DESIGNER:    Dean Morin
 --
 -- PROGRAMMER:  Dean Morin
 --
--- INTERFACE:   DWORD AddToBack(CHAR_LIST** pHead, CHAR* psBuf, DWORD dwLength)
+-- INTERFACE:   DWORD AddToBack(CHAR_LIST** pHead, CHAR_LIST** pFree, 
+--                              CHAR* psBuf, DWORD dwLength, PARENA pArena)
 --                          pHead       - the first node in the list
+--                          pFree       - the first node in the free list
 --                          psBuf       - the characters to be added
 --                          dwLength    - the length of psBuf
+--                          pArena      - the arena whose heap allocation
+--                                        and failure counts are updated
 --
 -- RETURNS:     The length of the linked-list.
 --
 -- NOTES:
---              Adds the contents of psBuf to the end of the list.
+--              Adds the contents of psBuf to the end of the list. A node is
+--              only allocated when the free list is empty. If that fails, the
+--              rest of psBuf is lost and counted in pArena's dwFailures.
 ------------------------------------------------------------------------------*/
 
-DWORD AddToBack(CHAR_LIST** pHead, CHAR* psBuf, DWORD dwLength) {
+DWORD AddToBack(CHAR_LIST** pHead, CHAR_LIST** pFree, CHAR* psBuf, 
+                DWORD dwLength, PARENA pArena) {
     CHAR_LIST*  newNode = NULL;
     CHAR_LIST*  p       = NULL;
     DWORD       dwCount = 0;
@@ -57,27 +82,34 @@ DWORD AddToBack(CHAR_LIST** pHead, CHAR* psBuf, DWORD dwLength) {
 
     p = *pHead;
 
-    if (p == NULL) {
-        newNode         = (CHAR_LIST*) malloc(sizeof(CHAR_LIST));
-        newNode->c      = psBuf[i++];
-        newNode->next   = NULL;
-        p               = newNode;
-        *pHead			= newNode;
-    } else {
-
+    if (p != NULL) {
+        dwCount++;
         while (p->next != NULL) {
             p = p->next;
             dwCount++;
         }
     }
-	dwCount++;
         
-    for (i; i < dwLength; i++) {
-        newNode         = (CHAR_LIST*) malloc(sizeof(CHAR_LIST));
+    for (i = 0; i < dwLength; i++) {
+        if (*pFree != NULL) {
+            newNode = *pFree;
+            *pFree  = newNode->next;
+        } else {
+            if ((newNode = (CHAR_LIST*) malloc(sizeof(CHAR_LIST))) == NULL) {
+                pArena->dwFailures++;
+                break;
+            }
+            pArena->dwHeapAllocs++;
+        }
         newNode->c      = psBuf[i];
         newNode->next   = NULL;
-        p->next         = newNode;
-        p               = p->next;
+
+        if (p == NULL) {
+            *pHead  = newNode;
+        } else {
+            p->next = newNode;
+        }
+        p = newNode;
         dwCount++;
     }
 
@@ -116,9 +148,9 @@ DWORD GetFromList(CHAR_LIST* p, UINT uiOrdinal) {
 }
 
 /*------------------------------------------------------------------------------
--- FUNCTION:    AddToBack
+-- FUNCTION:    FindInList
 --
--- DATE:        Nov 06, 2010
+-- DATE:        Oct 19, 2026
 --
 -- REVISIONS:   (Date and Description)
 --
@@ -126,32 +158,104 @@ DWORD GetFromList(CHAR_LIST* p, UINT uiOrdinal) {
 --
 -- PROGRAMMER:  Dean Morin
 --
--- INTERFACE:   CHAR* RemoveFromFront(CHAR_LIST** pHead, DWORD dwLength)
+-- INTERFACE:   DWORD FindInList(CHAR_LIST* p, CHAR c)
+--                          p   - the first node in the list
+--                          c   - the value to look for
+--
+-- RETURNS:     The number of nodes before the first one holding c, or the 
+--              length of the list if there isn't one.
+------------------------------------------------------------------------------*/
+DWORD FindInList(CHAR_LIST* p, CHAR c) {
+    DWORD i = 0;
+
+    for (i = 0; p != NULL  &&  p->c != c; i++) {
+        p = p->next;
+    }
+    return i;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    RemoveFromFront
+--
+-- DATE:        Nov 06, 2010
+--
+-- REVISIONS:   Oct 19, 2026
+--              The removed characters are now allocated from pArena, and the
+--              removed nodes are moved to pFree rather than freed.
+--              Oct 19, 2026
+--              The nodes are still removed if the array can't be allocated.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   CHAR* RemoveFromFront(CHAR_LIST** pHead, CHAR_LIST** pFree,
+--                                    DWORD dwLength, PARENA pArena)
 --                          pHead       - the first node in the list
+--                          pFree       - the first node in the free list
 --                          dwLength    - the number of nodes to remove
+--                          pArena      - the arena to allocate the result from
 --
 -- RETURNS:     The contents of the first n nodes in the list, 
---              where n = dwLength
+--              where n = dwLength, or NULL if pArena is out of memory.
 --
 -- NOTES:
 --              Retrieves and removes a specified amount of nodes in the form
---              of a character array.
+--              of a character array. The array is only valid until pArena is
+--              reset. The nodes are removed even when NULL is returned, so
+--              that the caller stays in step with the list.
 ------------------------------------------------------------------------------*/
-CHAR* RemoveFromFront(CHAR_LIST** pHead, DWORD dwLength) {
+CHAR* RemoveFromFront(CHAR_LIST** pHead, CHAR_LIST** pFree, DWORD dwLength,
+                      PARENA pArena) {
     CHAR_LIST*  p       = NULL;
     CHAR_LIST*  tracer  = NULL;
     UINT        i       = 0;
     CHAR*       removed = NULL;
     
     p       = *pHead;
-    removed = (CHAR*) malloc(sizeof(CHAR) * dwLength);
+    removed = (CHAR*) ArenaAlloc(pArena, sizeof(CHAR) * dwLength);
 
     for (i = 0; i < dwLength; i++) {
-        removed[i]  = p->c;
-        tracer      = p;
-        p           = p->next;
-        free(tracer);
+        if (removed != NULL) {
+            removed[i]  = p->c;
+        }
+        tracer          = p;
+        p               = p->next;
+        tracer->next    = *pFree;
+        *pFree          = tracer;
     }
     *pHead = p;
     return removed;
 }
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FreeList
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID FreeList(CHAR_LIST** pHead)
+--                          pHead       - the first node in the list
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Frees every node in the list and sets the head to NULL.
+------------------------------------------------------------------------------*/
+VOID FreeList(CHAR_LIST** pHead) {
+    CHAR_LIST*  p       = NULL;
+    CHAR_LIST*  tracer  = NULL;
+
+    p = *pHead;
+    while (p != NULL) {
+        tracer  = p;
+        p       = p->next;
+        free(tracer);
+    }
+    *pHead = NULL;
+}
@@ -2,6 +2,7 @@
 #define LIST_H
 
 #include <Windows.h>
+#include "Arena.h"
 
 typedef struct CHAR_LIST CHAR_LIST;
 typedef struct CHAR_LIST {
@@ -9,8 +10,12 @@ typedef struct CHAR_LIST {
     CHAR_LIST*  next;
 } CHAR_LIST;
 
-DWORD AddToBack(CHAR_LIST** p, CHAR* psBuf, DWORD dwLength);
+DWORD AddToBack(CHAR_LIST** p, CHAR_LIST** pFree, CHAR* psBuf, DWORD dwLength,
+                PARENA pArena);
 DWORD GetFromList(CHAR_LIST* p, UINT ordinal);
-CHAR* RemoveFromFront(CHAR_LIST** p, DWORD dwLength);
+DWORD FindInList(CHAR_LIST* p, CHAR c);
+CHAR* RemoveFromFront(CHAR_LIST** p, CHAR_LIST** pFree, DWORD dwLength,
+                      PARENA pArena);
+VOID  FreeList(CHAR_LIST** p);
 
 #endif
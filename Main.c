@@ -33,6 +33,10 @@
 --
 -- REVISIONS:   Nov 06, 2010
 --              Changed the window name.
+--              Oct 19, 2026
+--              The window can be resized, and has a vertical scroll bar.
+--              Oct 19, 2026
+--              The window isn't shown when the console renderer is headless.
 --
 -- DESIGNER:    Dean Morin
 --
@@ -83,14 +87,16 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
     }
 
     hWnd = CreateWindow(szAppName,
-                        TEXT("RFID Reader - Enterprise Edition (Trial Expired)"), 
+                        APP_TITLE, 
                         WS_OVERLAPPED | WS_CAPTION | WS_SYSMENU 
-                        | WS_MINIMIZEBOX,
+                        | WS_MINIMIZEBOX | WS_MAXIMIZEBOX | WS_THICKFRAME
+                        | WS_VSCROLL,
                         CW_USEDEFAULT, CW_USEDEFAULT,
                         CW_USEDEFAULT, CW_USEDEFAULT,
                         NULL, NULL, hInstance, NULL);
 
-    ShowWindow(hWnd, iCmdShow);
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    ShowWindow(hWnd, pwd->console.bHeadless ? SW_HIDE : iCmdShow);
     UpdateWindow(hWnd);
 
 
@@ -108,6 +114,37 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
 --
 -- REVISIONS:   Nov 06, 2010
 --              Removed message handling that doesn't apply to this program.
+--              Oct 19, 2026
+--              Added WM_PORTLOST, WM_TIMER and WM_DEVICECHANGE for the
+--              reconnect supervisor.
+--              Oct 19, 2026
+--              Closes the latency trace on WM_DESTROY.
+--              Oct 19, 2026
+--              Stops the decode workers on WM_DESTROY.
+--              Oct 19, 2026
+--              Added WM_SIZE, WM_VSCROLL and WM_MOUSEWHEEL for the resizable
+--              display and its scrollback.
+--              Oct 19, 2026
+--              Refreshes the console renderer on its timer, and closes it on
+--              WM_DESTROY.
+--              Oct 19, 2026
+--              Checks the UID lists for changes on their timer, and unmaps
+--              them on WM_DESTROY.
+--              Oct 19, 2026
+--              Saves the tag analytics sketches on WM_DESTROY.
+--              Oct 19, 2026
+--              Moves the correlator's watermark on its timer, and flushes it
+--              on WM_DESTROY.
+--              Oct 19, 2026
+--              Closes the read journal on WM_DESTROY.
+--              Oct 19, 2026
+--              Snapshots the tag inventory on WM_DESTROY.
+--              Oct 19, 2026
+--              Closes the tag bus on WM_DESTROY.
+--              Oct 19, 2026
+--              Frees the read thread's arena on WM_DESTROY.
+--              Oct 19, 2026
+--              Added WM_RECONNECTED for the supervisor's reconnect attempts.
 --
 -- DESIGNER:    Dean Morin
 --
@@ -146,8 +183,55 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message,
             PerformMenuAction(hWnd, wParam);
             return 0;
 
+        case WM_SIZE:
+            ResizeDisplay(hWnd, LOWORD(lParam), HIWORD(lParam));
+            return 0;
+
+        case WM_VSCROLL:
+            OnVScroll(hWnd, wParam);
+            return 0;
+
+        case WM_MOUSEWHEEL:
+            OnMouseWheel(hWnd, wParam);
+            return 0;
+
+        case WM_PORTLOST:
+            OnPortLost(hWnd);
+            return 0;
+
+        case WM_RECONNECTED:
+            OnReconnectResult(hWnd, wParam, lParam);
+            return 0;
+
+        case WM_TIMER:
+            if (wParam == IDT_RECONNECT) {
+                OnReconnectTimer(hWnd);
+            } else if (wParam == IDT_CONSOLE) {
+                RenderConsole(hWnd);
+            } else if (wParam == IDT_UIDSET) {
+                RefreshUidLists(hWnd);
+            } else if (wParam == IDT_CORRELATE) {
+                AdvanceCorrelator();
+            }
+            return 0;
+
+        case WM_DEVICECHANGE:
+            OnDeviceChange(hWnd, wParam, lParam);
+            return TRUE;
+
         case WM_DESTROY:
             Disconnect(hWnd);
+            StopWorkerPool();
+            CloseSketch(hWnd);
+            CloseCorrelator(hWnd);
+            CloseJournal();
+            CloseInventory();
+            CloseBus();
+            CloseTrace(&pwd->trace);
+            CloseConsole(hWnd);
+            CloseUidLists(hWnd);
+            FreeDisplay(hWnd);
+            FreeArena(&pwd->ioArena);
             PostQuitMessage(0);
             return 0;
 
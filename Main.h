@@ -8,6 +8,28 @@
 #include <Windows.h>
 #include <stdio.h>
 #include "Application.h"
+#include "Arena.h"
+#include "Command.h"
+#include "Config.h"
+#include "Scheduler.h"
+#include "Supervisor.h"
+#include "Sketch.h"
+#include "Correlate.h"
+#include "Journal.h"
+#include "Inventory.h"
+#include "Bus.h"
+#include "Rollup.h"
+#include "UidSet.h"
+#include "Filter.h"
+#include "Blocks.h"
+#include "Console.h"
+#include "Display.h"
+#include "Escape.h"
+#include "Latency.h"
+#include "Realtime.h"
+#include "Pool.h"
+#include "Trace.h"
+#include "Transport.h"
 #include "Menu.h"
 #include "Physical.h"
 #include "Presentation.h"
@@ -23,8 +45,8 @@
                                     // client area, and any text
 #define NO_OF_PORTS         9       // the number of ports available from the
                                     // "Select Ports" dropdown
-#define CHARS_PER_LINE      80      // characters per line
-#define LINES_PER_SCRN      24      // lines per screen
+
+#define APP_TITLE           TEXT("RFID Reader - Enterprise Edition (Trial Expired)")
 
 #define DISPLAY_ERROR(x)    MessageBox(NULL, TEXT(x), TEXT(""), MB_OK)
 #define X                   pwd->displayBuf.cxCursor
@@ -35,43 +57,22 @@
                                                        + PADDING
 #define CHAR_WIDTH          pwd->displayBuf.cxChar
 #define CHAR_HEIGHT         pwd->displayBuf.cyChar
-#define CHARACTER(x, y)     pwd->displayBuf.rows[y]->columns[x]
-#define SET_BUFFER(c, x, y) pwd->displayBuf.rows[y]->columns[x].character = c;
-#define ROW(y)              pwd->displayBuf.rows[y]
+#define CHARS_PER_LINE      pwd->displayBuf.uiCols
+#define LINES_PER_SCRN      pwd->displayBuf.uiRows
+#define CELL(x, y)          (GetDisplayRow(&pwd->displayBuf, y) \
+                                * CHARS_PER_LINE + (x))
+#define CELL_CHAR(x, y)     pwd->displayBuf.pcChars[CELL(x, y)]
+#define CELL_FG(x, y)       pwd->displayBuf.pbFgColors[CELL(x, y)]
+#define CELL_BG(x, y)       pwd->displayBuf.pbBgColors[CELL(x, y)]
+#define CELL_STYLE(x, y)    pwd->displayBuf.pbStyles[CELL(x, y)]
 #define CUR_FG_COLOR        pwd->displayBuf.fgColor
 #define CUR_BG_COLOR        pwd->displayBuf.bgColor
 #define CUR_STYLE           pwd->displayBuf.style
 #define BRIGHTNESS			pwd->displayBuf.brightness
-#define ESC_VAL(x)          pwd->dwEscSeqValues[x]
 #define WINDOW_TOP          pwd->cyWindowTop
 #define WINDOW_BOTTOM       pwd->cyWindowBottom
 
 /*-------------------------------Structures-----------------------------------*/
-typedef struct charInfo {
-    CHAR    character;
-    BYTE    fgColor;
-    BYTE    bgColor;
-    BYTE    style;
-} CHARINFO;
-
-typedef struct line line;
-typedef struct line {
-    CHARINFO    columns[CHARS_PER_LINE];
-} LINE, *PLINE;
-
-typedef struct displayBuf {
-    PLINE   rows[LINES_PER_SCRN];
-    UINT    cxChar;
-    UINT    cyChar;
-    INT     cxCursor;
-    INT     cyCursor;
-    HFONT	hFont;
-	BYTE    fgColor;
-    BYTE    bgColor;
-    BYTE    style;
-	BYTE	brightness;
-} DISPLAYBUF;
-
 typedef struct wndData {
     HANDLE          hPort;
     LPTSTR          lpszCommName;
@@ -80,15 +81,31 @@ typedef struct wndData {
     HANDLE          hThread;
     DWORD           dwThreadid;
     COMMTIMEOUTS    defaultTimeOuts;
-    CHAR*           psIncompleteEsc;
-    DWORD           dwIncompleteLength;
+    ESCPARSER       escParser;
     DISPLAYBUF      displayBuf;
-    DWORD           dwEscSeqValues[32];
 	BOOL			cursorMode;
     INT             cyWindowTop;
     INT             cyWindowBottom;
 	BOOL			wordWrap;
 	BOOL			relOrigin;
+    ARENA           ioArena;
+    TCHAR           szConfigFile[MAX_PATH];
+    COMMAND         inventoryCmd;
+    COMMAND         initCmd;
+    BOOL            bMultiTag;
+    POLLSCHED       pollSched;
+    SUPERVISOR      supervisor;
+    TRANSPORT       transport;
+    TRACE           trace;
+    STRAND          strand;
+    RTOPTIONS       realtime;
+    LATENCY         latency;
+    CONSOLE         console;
+    BLOCKENGINE     blocks;
+    FILTER          filter;
+    UIDLISTS        uidLists;
+    ROLLUP          rollup;
+    SKETCH          sketch;
 } WNDDATA, *PWNDDATA;
 
 /*---------------------------Function Prototypes------------------------------*/
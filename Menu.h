@@ -14,5 +14,10 @@
 #define IDM_COM8        110
 #define IDM_COM9        111
 #define IDM_COMMSET		112
+#define IDM_RATES       113
+#define IDM_SKETCH      114
+#define IDM_ZONES       115
+#define IDM_HISTORY     116
+#define IDM_INVENTORY   117
 
 #endif
@@ -11,6 +11,8 @@
 -- FUNCTIONS:
 --              DWORD WINAPI    ReadThreadProc(HWND);
 --				VOID	        RequestPacket(HWND hWnd);
+--              BOOL            TransactCommand(HWND, PCOMMAND, DWORD);
+--              BOOL            IsPortLost(DWORD);
 --              VOID            ProcessCommError(HANDLE);
 --
 --
@@ -19,6 +21,9 @@
 -- REVISIONS:   Nov 05, 2010
 --              Modified ReadThreadProc to work more appropriately for the RFID
 --              reader. Added RequestPacket()
+--              Oct 19, 2026
+--              The read thread now runs on an I/O completion port (see
+--              Transport.c).
 --
 -- DESIGNER:    Dean Morin
 --
@@ -30,6 +35,9 @@
 
 #include "Physical.h"
 
+static DWORD GetFrameLength(CHAR_LIST* pHead);
+static DWORD GetPortNumber(LPCTSTR lpszCommName);
+
 /*------------------------------------------------------------------------------
 -- FUNCTION:    ReadThreadProc
 --
@@ -41,6 +49,58 @@
 --              ProcessRead() is now called once a complete packet is confirmed
 --              (as opposed to sending the contents of the buffer to 
 --              ProcessRead() as soon as they arrive).
+--              Oct 19, 2026
+--              Packets are taken from the reader's arena, which is reset after
+--              each read, and queue nodes are recycled.
+--              Oct 19, 2026
+--              Requests are spaced out by the poll scheduler, and are re-sent
+--              if the reader doesn't answer within the reply timeout.
+--              Oct 19, 2026
+--              Exits and posts WM_PORTLOST if the port stops working.
+--              Oct 19, 2026
+--              Waits on the reader's completion port instead of calling 
+--              WaitCommEvent() and ReadFile() for every burst of characters.
+--              Decodes every complete packet in a read, not just the first.
+--              Oct 19, 2026
+--              Writes out the reader's command queue, and cancels writes that
+--              take too long.
+--              Oct 19, 2026
+--              Timestamps each frame's first read and its completion, for the
+--              latency trace.
+--              Oct 19, 2026
+--              Only frames the bytes; complete frames are handed to the worker
+--              pool to be decoded. Bytes that can't start a frame are skipped.
+--              Oct 19, 2026
+--              Samples its own scheduling delay.
+--              Oct 19, 2026
+--              Sizes its reads for the latency profile.
+--              Oct 19, 2026
+--              Bytes outside of a frame are passed on as the reader's ASCII
+--              output.
+--              Oct 19, 2026
+--              Reads both bytes of the frame length, for multi-tag responses
+--              longer than 255 bytes.
+--              Oct 19, 2026
+--              A frame length under MIN_FRAME_LENGTH isn't a frame.
+--              Oct 19, 2026
+--              The next request is scheduled once a worker has decoded the
+--              reply (KEY_POLLED), and only this thread touches the poll
+--              scheduler.
+--              Oct 19, 2026
+--              Submits an empty frame every block timeout, so the strand
+--              checks its block requests even when no frames arrive.
+--              Oct 19, 2026
+--              Only a reply to the inventory command ends the request; the
+--              workers don't post any other frame back.
+--              Oct 19, 2026
+--              A packet the arena couldn't hold is dropped instead of being
+--              submitted.
+--              Oct 19, 2026
+--              Tags are stamped with the whole port number, so COM10 and up
+--              are told apart.
+--              Oct 19, 2026
+--              Bounds how long it waits on a full strand by the time the
+--              port's receive buffer takes to fill at the negotiated rate.
 --
 -- DESIGNER:    Dean Morin
 --
@@ -49,101 +109,292 @@
 -- INTERFACE:   DWORD WINAPI ReadThreadProc(HWND hWnd)
 --                          hWnd - the handle to the window
 --
--- RETURNS:     0 because threads are required to return a DWORD.
+-- RETURNS:     1 if the thread ended because the port was lost, otherwise 0.
 --
 -- NOTES:
---              While connected, this thread will loop and wait for characters
---              to arrive at the port. Once the EV_RXCHAR event is triggered,
---              ReadFile() is called to get however many characters have arrived
---              at the port by that time. This function uses overlapped I/O.
+--              While connected, this thread keeps reads posted on the port and
+--              sleeps on the completion port until one of them finishes, the
+--              inventory request has been written, a worker has decoded a
+--              reply (KEY_POLLED), it is time for the next request or a block
+--              timeout check, or the reader is disconnected (KEY_DISCONNECT).
+--              Whenever a read completes, the same buffer is posted again 
+--              straight away.
 ------------------------------------------------------------------------------*/
 DWORD WINAPI ReadThreadProc(HWND hWnd) {
     
     PWNDDATA        pwd                     = NULL;
-    CHAR            psReadBuf[READ_BUFSIZE] = {0};
-    OVERLAPPED      overlap                 = {0};
+    PTRANSPORT      pT                      = NULL;
+    LPOVERLAPPED    pOv                     = NULL;
+    ULONG_PTR       key                     = 0;
     DWORD           dwBytesRead             = 0;
-    DWORD           dwEvent                 = 0;
-    DWORD           dwError                 = 0;
-    COMSTAT         cs                      = {0};
-    HANDLE          hEvents[2]              = {0};
 	BOOL			requestPending 			= FALSE;
 	DWORD			dwPacketLength 			= 0;
 	CHAR*			pcPacket			    = NULL;
     CHAR_LIST*      pHead                   = NULL;
+    CHAR_LIST*      pFree                   = NULL;
     DWORD           dwQueueSize             = 0;
+    DWORD           dwTimeout               = INFINITE;
+    DWORD           dwDeadline              = 0;
+    DWORD           dwBlockCheck            = 0;
+    BOOL            bResult                 = FALSE;
+    BOOL            bPortLost               = FALSE;
+    INT             iSlot                   = 0;
+    DWORD           dwReads                 = 0;
+    LONGLONG        llReadTime              = 0;
+    LONGLONG        llFirstByte             = 0;
+    TAGREAD         tagRead                 = {0};
+    DWORD           dwReader                = 0;
+    COMMPROP        cp                      = {0};
 	DWORD           i                       = 0;
 
     pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
-    
+    pT  = &pwd->transport;
+    dwReader = GetPortNumber(pwd->lpszCommName);
+
+    // never wait on the workers for longer than the driver can buffer
+    GetCommProperties(pwd->hPort, &cp);
+    SetStrandStall(&pwd->strand, cp.dwCurrentRxQueue, pwd->cc.dcb.BaudRate);
 	
-    if ((overlap.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL)) == NULL) {
-        DISPLAY_ERROR("Error creating event in read thread");
+    // a low latency read's size depends on the one before it
+    dwReads = pwd->latency.bLowLatency ? 1 : TRANSPORT_READS;
+    for (i = 0; i < dwReads; i++) {
+        if (!PostTransportRead(pT, pwd->hPort, i, 
+                               GetReadLength(&pwd->latency, 0, 0))) {
+            bPortLost = TRUE;
+            break;
+        }
     }
-    hEvents[0] = overlap.hEvent;
-    hEvents[1] = OpenEvent(DELETE | SYNCHRONIZE, FALSE, TEXT("disconnected"));
-
+    dwDeadline = GetTickCount();
+    dwBlockCheck = GetTickCount() + pwd->blocks.dwTimeout;
 	
-    while (pwd->bConnected) {
+    while (pwd->bConnected  &&  !bPortLost) {
 		
-		if(!requestPending){
+        // the deadline is either the next request or the reply timeout
+        if (!requestPending  &&  (LONG) (GetTickCount() - dwDeadline) >= 0) {
 			RequestPacket(hWnd);
 			requestPending = TRUE;
+            dwDeadline = GetTickCount() + pwd->pollSched.dwReplyTimeout;
 		}
-
-        SetCommMask(pwd->hPort, EV_RXCHAR);
-        if (!WaitCommEvent(pwd->hPort, &dwEvent, &overlap)) {
-            ProcessCommError(pwd->hPort);
+        if (pwd->blocks.bEnabled  &&  
+                (LONG) (GetTickCount() - dwBlockCheck) >= 0) {
+            // the strand checks whether its block requests have timed out
+            SubmitFrame(&pwd->strand, NULL, 0, &tagRead);
+            dwBlockCheck = GetTickCount() + pwd->blocks.dwTimeout;
         }
-        dwEvent = WaitForMultipleObjects(2, hEvents, FALSE, INFINITE);
-        if (dwEvent == WAIT_OBJECT_0 + 1) {
-            // the connection was severed
+        if (!FlushWriteQueue(pT, pwd->hPort)  &&  
+                IsPortLost(GetLastError())) {
+            bPortLost = TRUE;
             break;
         }
-	
-        ClearCommError(pwd->hPort, &dwError, &cs);    
-		
-        // ensures that there is a character at the port
-        if (cs.cbInQue) {  
-            if (!ReadFile(pwd->hPort, psReadBuf, cs.cbInQue, 
-                          &dwBytesRead, &overlap)) {
-                // read is incomplete or had an error
-                ProcessCommError(pwd->hPort);
-                GetOverlappedResult(pwd->hThread, &overlap, &dwBytesRead, TRUE);
-            }
+        dwTimeout = dwDeadline - GetTickCount();
+        if ((LONG) dwTimeout < 0) {
+            dwTimeout = 0;
+        }
+        dwTimeout = min(dwTimeout, GetWriteTimeout(pT));
+        if (pwd->blocks.bEnabled) {
+            dwTimeout = min(dwTimeout, 
+                            (DWORD) max((LONG) (dwBlockCheck - GetTickCount()),
+                                        0));
+        }
+
+        bResult = GetQueuedCompletionStatus(pT->hIocp, &dwBytesRead, &key,
+                                            &pOv, dwTimeout);
+        pT->dwCompletions++;
 
-            dwQueueSize = AddToBack(&pHead, psReadBuf, dwBytesRead);
-            if (dwQueueSize >= 2) {
-                dwPacketLength = GetFromList(pHead, 2);
+        if (pOv == NULL) {
+            if (bResult  &&  key == KEY_DISCONNECT) {
+                // the connection was severed
+                break;
+            }
+            if (bResult  &&  key == KEY_FLUSH) {
+                // a command was queued
+                continue;
+            }
+            if (bResult  &&  key == KEY_POLLED) {
+                // a worker decoded an inventory reply, and dwBytesRead is its
+                // tag count
+                UpdatePollScheduler(&pwd->pollSched, dwBytesRead);
+                if (requestPending) {
+                    requestPending = FALSE;
+                    dwDeadline = GetTickCount() + pwd->pollSched.dwInterval;
+                }
+                continue;
+            }
+            if (GetLastError() != WAIT_TIMEOUT) {
+                bPortLost = TRUE;
+                break;
+            }
+            CheckWriteTimeout(pT, pwd->hPort);
             
-                if (dwQueueSize >= dwPacketLength) {
-
-                    pcPacket = RemoveFromFront(&pHead, dwPacketLength);
-				    ProcessPacket(hWnd, pcPacket, dwPacketLength);
-                    memset(psReadBuf, 0, READ_BUFSIZE);
-				    requestPending = FALSE;
-                    free(pcPacket);
-			    }
-                InvalidateRect(hWnd, NULL, FALSE);
+            if (requestPending  &&  
+                    (LONG) (GetTickCount() - dwDeadline) >= 0) {
+                // the reader never answered, so count it as an empty inventory
+                UpdatePollScheduler(&pwd->pollSched, 0);
+                requestPending = FALSE;
+                dwDeadline = GetTickCount() + pwd->pollSched.dwInterval;
             }
+            continue;
+        }
+
+        if (pOv == &pT->writeOv) {
+            if (!bResult  &&  !pT->bWriteCancelled  &&  
+                    IsPortLost(GetLastError())) {
+                bPortLost = TRUE;
+            }
+            CompleteWrite(pT, dwBytesRead);
+            continue;
+        }
+
+        if ((iSlot = GetReadSlot(pT, pOv)) < 0) {
+            continue;
+        }
+        pT->bReadPending[iSlot] = FALSE;
+
+        if (!bResult) {
+            // read had an error
+            if (IsPortLost(GetLastError())) {
+                bPortLost = TRUE;
+                break;
+            }
+            ProcessCommError(pwd->hPort);
+            dwBytesRead = 0;
+        }
+
+        if (dwBytesRead > 0) {
+            llReadTime = TraceNow();
+            if (dwQueueSize == 0) {
+                // this read starts a new frame
+                llFirstByte = llReadTime;
+            }
+            dwQueueSize = AddToBack(&pHead, &pFree, pT->psReadBuf[iSlot], 
+                                    dwBytesRead, &pwd->ioArena);
+            SampleSchedDelay(hWnd);
+
+            while (dwQueueSize > 0) {
+                
+                if ((CHAR) GetFromList(pHead, 1) != CMD_SOF) {
+                    // ASCII output from the reader, up to the next frame
+                    dwPacketLength = min(FindInList(pHead, CMD_SOF), 
+                                         MAX_FRAME_LENGTH);
+                    pcPacket = RemoveFromFront(&pHead, &pFree, dwPacketLength,
+                                               &pwd->ioArena);
+                    dwQueueSize -= dwPacketLength;
+                    if (pcPacket != NULL) {
+                        SubmitFrame(&pwd->strand, pcPacket, dwPacketLength, 
+                                    NULL);
+                    }
+                    continue;
+                }
+                if (dwQueueSize < FRAME_HEADER_BYTES) {
+                    break;
+                }
+                dwPacketLength = GetFrameLength(pHead);
+                
+                if (dwPacketLength < MIN_FRAME_LENGTH
+                        ||  dwPacketLength > MAX_FRAME_LENGTH) {
+                    // can't be a frame, so skip the SOF and look again
+                    RemoveFromFront(&pHead, &pFree, 1, &pwd->ioArena);
+                    dwQueueSize--;
+                    continue;
+                }
+                if (dwQueueSize < dwPacketLength) {
+                    break;
+                }
+                pcPacket = RemoveFromFront(&pHead, &pFree, dwPacketLength,
+                                           &pwd->ioArena);
+                dwQueueSize -= dwPacketLength;
+                if (pcPacket == NULL) {
+                    // out of memory; counted in the arena's dwFailures
+                    continue;
+                }
+
+                ZeroMemory(&tagRead, sizeof(TAGREAD));
+                tagRead.dwReader    = dwReader;
+                tagRead.llRead      = llFirstByte;
+                tagRead.llFramed    = TraceNow();
+                // whatever is left over arrived in this read
+                llFirstByte         = llReadTime;
+
+                // the workers decode it, and post back its tag count
+                SubmitFrame(&pwd->strand, pcPacket, dwPacketLength, &tagRead);
+            }
+            // every frame from this read has been copied to the strand
+            ResetArena(&pwd->ioArena);
+        }
+
+        dwPacketLength = (dwQueueSize >= FRAME_HEADER_BYTES) 
+                       ? GetFrameLength(pHead) : 0;
+        if (pwd->bConnected  &&  
+                !PostTransportRead(pT, pwd->hPort, (DWORD) iSlot, 
+                                   GetReadLength(&pwd->latency, dwQueueSize,
+                                                 dwPacketLength))) {
+            bPortLost = TRUE;
+            break;
         }
-        ResetEvent(overlap.hEvent);
     }
 
+    DrainTransport(pT, pwd->hPort);
+    FreeList(&pHead);
+    FreeList(&pFree);
+    ResetArena(&pwd->ioArena);
 
+    if (bPortLost) {
+        // let the supervisor close the port and reconnect
+        PostMessage(hWnd, WM_PORTLOST, 0, 0);
+        return 1;
+    }
     if (!PurgeComm(pwd->hPort, PURGE_RXCLEAR)) {
         DISPLAY_ERROR("Error purging read buffer");
     }
-    CloseHandle(overlap.hEvent);
     return 0;
 }
 
+/*------------------------------------------------------------------------------
+-- FUNCTION:    IsPortLost
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL IsPortLost(DWORD dwError)
+--                          dwError - the value returned by GetLastError()
+--
+-- RETURNS:     True if the error means the port is no longer usable.
+--
+-- NOTES:
+--              These are the errors reported once a USB-serial adapter has been
+--              unplugged or its driver has reset; the handle has to be closed
+--              and the port opened again.
+------------------------------------------------------------------------------*/
+BOOL IsPortLost(DWORD dwError) {
+
+    switch (dwError) {
+        case ERROR_ACCESS_DENIED:
+        case ERROR_INVALID_HANDLE:
+        case ERROR_BAD_COMMAND:
+        case ERROR_GEN_FAILURE:
+        case ERROR_OPERATION_ABORTED:
+        case ERROR_DEVICE_NOT_CONNECTED:
+            return TRUE;
+        default:
+            return FALSE;
+    }
+}
+
 /*------------------------------------------------------------------------------
 -- FUNCTION:    RequestPacket
 --
 -- DATE:        Nov 4, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              Sends the inventory command built by LoadCommandSet() rather
+--              than a hard-coded frame.
+--              Oct 19, 2026
+--              The command is put on the reader's write queue.
 --
 -- DESIGNER:    Daniel Wright
 --
@@ -152,36 +403,114 @@ DWORD WINAPI ReadThreadProc(HWND hWnd) {
 -- INTERFACE:   BOOL RequestPacket(HWND hWnd)
 --                          hWnd        - the handle to the window
 --                          
--- RETURNS:     True if the port write was successful.
+-- RETURNS:     False if the write queue is full.
 --
 -- NOTES:
---              Writes a string representing a packet request to the port.
+--              Queues the inventory command. The read thread writes it out.
 ------------------------------------------------------------------------------*/
 BOOL RequestPacket(HWND hWnd) {
  
     PWNDDATA    pwd             = {0};
-    CHAR        psWriteBuf[10]  = {0};
-    OVERLAPPED  overlap         = {0};
-    DWORD       dwBytesRead     = 0;
-    UINT        bufLength       = 9;
     pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
 
-    psWriteBuf[0] = 0x01;
-	psWriteBuf[1] = 0x09;
-	psWriteBuf[2] = 0x00;
-	psWriteBuf[3] = 0x03;
-	psWriteBuf[4] = 0x01;
-	psWriteBuf[5] = 0x41;
-	psWriteBuf[6] = 0x00; 
-	psWriteBuf[7] = 0x4B; 
-	psWriteBuf[8] = 0xB4; 
-
-    if (!WriteFile(pwd->hPort, psWriteBuf, bufLength, &dwBytesRead, &overlap)) {
-		if (GetLastError() != ERROR_IO_PENDING) {
+    return QueueCommand(&pwd->transport, &pwd->inventoryCmd);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    TransactCommand
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Reads both bytes of the frame length.
+--              Oct 19, 2026
+--              Uses the read thread's minimum frame length.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL TransactCommand(HWND hWnd, PCOMMAND pCmd, DWORD dwTimeout)
+--                          hWnd        - the handle to the window
+--                          pCmd        - the command to send
+--                          dwTimeout   - ms to wait for the reply
+--
+-- RETURNS:     True if a complete frame with a valid LRC came back in time.
+--
+-- NOTES:
+--              Sends a command and waits for the reader's reply. This is only
+--              used while connecting, before the read thread is started, to
+--              check that the reader understands us at the current settings.
+--              Anything already waiting at the port is discarded first.
+------------------------------------------------------------------------------*/
+BOOL TransactCommand(HWND hWnd, PCOMMAND pCmd, DWORD dwTimeout) {
+
+    PWNDDATA    pwd                     = NULL;
+    CHAR        psReadBuf[READ_BUFSIZE] = {0};
+    OVERLAPPED  overlap                 = {0};
+    DWORD       dwBytes                 = 0;
+    DWORD       dwTotal                 = 0;
+    DWORD       dwPacketLength          = 0;
+    DWORD       dwStart                 = 0;
+    DWORD       dwElapsed               = 0;
+    BOOL        bResult                 = FALSE;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    if ((overlap.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL)) == NULL) {
+        return FALSE;
+    }
+    PurgeComm(pwd->hPort, PURGE_RXCLEAR | PURGE_TXCLEAR);
+
+    if (!WriteFile(pwd->hPort, pCmd->pcFrame, pCmd->dwLength, 
+                   &dwBytes, &overlap)) {
+        if (GetLastError() != ERROR_IO_PENDING  ||
+                !GetOverlappedResult(pwd->hPort, &overlap, &dwBytes, TRUE)) {
+            CloseHandle(overlap.hEvent);
             return FALSE;
         }
     }
-    return TRUE;
+
+    dwStart = GetTickCount();
+    while ((dwElapsed = GetTickCount() - dwStart) < dwTimeout) {
+        
+        ResetEvent(overlap.hEvent);
+        if (!ReadFile(pwd->hPort, psReadBuf + dwTotal, READ_BUFSIZE - dwTotal,
+                      &dwBytes, &overlap)) {
+            if (GetLastError() != ERROR_IO_PENDING) {
+                break;
+            }
+            if (WaitForSingleObject(overlap.hEvent, dwTimeout - dwElapsed)
+                    != WAIT_OBJECT_0) {
+                // no reply in time
+                CancelIo(pwd->hPort);
+                GetOverlappedResult(pwd->hPort, &overlap, &dwBytes, TRUE);
+                break;
+            }
+            if (!GetOverlappedResult(pwd->hPort, &overlap, &dwBytes, FALSE)) {
+                break;
+            }
+        }
+        dwTotal += dwBytes;
+
+        if (dwTotal >= FRAME_HEADER_BYTES) {
+            dwPacketLength = (BYTE) psReadBuf[1] | (BYTE) psReadBuf[2] << 8;
+
+            if (psReadBuf[0] != CMD_SOF  ||  dwPacketLength < MIN_FRAME_LENGTH
+                    ||  dwPacketLength > READ_BUFSIZE) {
+                // noise, most likely from a mismatched baud rate
+                break;
+            }
+            if (dwTotal >= dwPacketLength) {
+                bResult = !DetectLRCError(psReadBuf, dwPacketLength);
+                break;
+            }
+        }
+        if (dwTotal == READ_BUFSIZE) {
+            break;
+        }
+    }
+    CloseHandle(overlap.hEvent);
+    return bResult;
 }
 
 /*------------------------------------------------------------------------------
@@ -229,3 +558,62 @@ VOID ProcessCommError(HANDLE hPort) {
             DISPLAY_ERROR("A communication error occured");
     }
 }
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetFrameLength
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   DWORD GetFrameLength(CHAR_LIST* pHead)
+--                          pHead - the received bytes, starting with an SOF 
+--                                  and at least FRAME_HEADER_BYTES long
+--
+-- RETURNS:     The length of the frame, from its header.
+--
+-- NOTES:
+--              The length is two bytes, LSB first. Single-tag responses
+--              always fit in the first, but a multi-tag response may not.
+------------------------------------------------------------------------------*/
+static DWORD GetFrameLength(CHAR_LIST* pHead) {
+    return (BYTE) GetFromList(pHead, 2) | (BYTE) GetFromList(pHead, 3) << 8;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetPortNumber
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static DWORD GetPortNumber(LPCTSTR lpszCommName)
+--                          lpszCommName - the name of the port
+--
+-- RETURNS:     The number at the end of the port's name, or 0 if there isn't
+--              one.
+--
+-- NOTES:
+--              A reader is identified by its port number, so the reader on
+--              "COM12" or "\\.\COM12" is reader 12.
+------------------------------------------------------------------------------*/
+static DWORD GetPortNumber(LPCTSTR lpszCommName) {
+    LPCTSTR p       = lpszCommName + lstrlen(lpszCommName);
+    DWORD   dwPort  = 0;
+
+    while (p > lpszCommName  &&  p[-1] >= '0'  &&  p[-1] <= '9') {
+        p--;
+    }
+    for ( ; *p != '\0'; p++) {
+        dwPort = dwPort * 10 + (*p - '0');
+    }
+    return dwPort;
+}
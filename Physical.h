@@ -7,8 +7,13 @@
 #define READ_BUFSIZE    2048
 #define WAIT_TIME       100
 
+// the shortest reply is the header, a status byte and the LRC
+#define MIN_FRAME_LENGTH    (TAG_TYPE + CMD_TRAILER_LENGTH)
+
 VOID            ProcessCommError(HANDLE hPort);
 DWORD WINAPI    ReadThreadProc(HWND hWnd);
 BOOL	        RequestPacket(HWND hWnd);
+BOOL            TransactCommand(HWND hWnd, PCOMMAND pCmd, DWORD dwTimeout);
+BOOL            IsPortLost(DWORD dwError);
 
 #endif
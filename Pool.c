@@ -0,0 +1,519 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Pool.c - Contains the worker threads that decode frames
+--                           for every reader.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              BOOL            StartWorkerPool(HWND);
+--              VOID            StopWorkerPool(VOID);
+--              VOID            InitStrand(HWND, PSTRAND);
+--              VOID            DrainStrand(PSTRAND);
+--              VOID            SetStrandStall(PSTRAND, DWORD, DWORD);
+--              BOOL            SubmitFrame(PSTRAND, CHAR*, DWORD, PTAGREAD);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Frames can also be the reader's ASCII output.
+--              Oct 19, 2026
+--              Frames are offered to the block engine before being decoded.
+--              Oct 19, 2026
+--              Added DrainStrand(), so a reader's port isn't closed while its
+--              frames are still being decoded.
+--              Oct 19, 2026
+--              A full strand holds up the read thread instead of dropping the
+--              frame straight away.
+--              Oct 19, 2026
+--              The read thread is only held up for as long as the port's
+--              driver can buffer the line (see SetStrandStall()).
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- A reader's read thread only splits the incoming bytes into frames. Each
+-- complete frame is copied into a slot on the reader's strand, and the decoding
+-- (LRC check, ProcessPacket(), the display) is done by a fixed pool of worker
+-- threads shared by all readers.
+--
+-- The workers wait on one I/O completion port. A strand is posted to it when
+-- its first frame arrives, and whichever worker picks it up decodes that
+-- reader's frames in order until the strand is empty. So a reader is only ever
+-- decoded by one worker at a time, its tags stay in order, and its state needs
+-- no locking, while different readers are spread over every core. (Its display
+-- is shared with the UI thread, so that has a lock of its own.) After
+-- STRAND_BATCH frames a busy strand goes to the back of the queue so that it
+-- can't starve the others.
+--
+-- If a reader's strand fills up, its read thread waits for the workers to
+-- catch up. It doesn't post its next read while it waits, so the bytes back up
+-- in the port's driver rather than being thrown away. Only if no slot frees up
+-- before the driver's receive buffer could fill is the frame dropped, so that
+-- the UART never overruns while the read thread waits; at a high baud rate
+-- that can be a few milliseconds, and it is never more than
+-- STRAND_STALL_TIMEOUT. Both are counted, and shown with the read rates.
+--
+-- The number of workers is set in the [Workers] section of the configuration
+-- file. 0 means one per processor.
+--
+--      [Workers]
+--      Count=0
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+static HANDLE   hPoolIocp               = NULL;
+static HANDLE   hWorkers[MAX_WORKERS]   = {0};
+static DWORD    dwWorkers               = 0;
+
+static DWORD WINAPI WorkerThreadProc(LPVOID lpParam);
+static VOID         RunStrand(PSTRAND pStrand);
+static VOID         DecodeFrame(PSTRAND pStrand, PFRAME pFrame);
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    StartWorkerPool
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL StartWorkerPool(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     False if the pool could not be started. Frames are then decoded
+--              on the read thread, as before.
+--
+-- NOTES:
+--              Creates the workers. Only the first call does anything, so
+--              every reader window can call it.
+------------------------------------------------------------------------------*/
+BOOL StartWorkerPool(HWND hWnd) {
+    SYSTEM_INFO si          = {0};
+    DWORD       dwCount     = 0;
+    DWORD       dwThreadid  = 0;
+    DWORD       i           = 0;
+
+    if (hPoolIocp != NULL) {
+        return TRUE;
+    }
+    dwCount = ReadConfigInt(hWnd, TEXT("Workers"), TEXT("Count"), 0);
+    if (dwCount == 0) {
+        GetSystemInfo(&si);
+        dwCount = si.dwNumberOfProcessors;
+    }
+    dwCount = min(max(dwCount, 1), MAX_WORKERS);
+
+    if ((hPoolIocp = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 
+                                            dwCount)) == NULL) {
+        return FALSE;
+    }
+    for (i = 0; i < dwCount; i++) {
+        hWorkers[dwWorkers] = CreateThread(NULL, 0, WorkerThreadProc, NULL, 0,
+                                           &dwThreadid);
+        if (hWorkers[dwWorkers] != NULL) {
+            dwWorkers++;
+        }
+    }
+    if (dwWorkers == 0) {
+        CloseHandle(hPoolIocp);
+        hPoolIocp = NULL;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    StopWorkerPool
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID StopWorkerPool(VOID)
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Tells each worker to exit, and waits for them. The exit packets
+--              queue up behind any strands that are already posted, so 
+--              frames that have been submitted are still decoded. Every read
+--              thread must have stopped first.
+------------------------------------------------------------------------------*/
+VOID StopWorkerPool(VOID) {
+    DWORD i = 0;
+
+    if (hPoolIocp == NULL) {
+        return;
+    }
+    for (i = 0; i < dwWorkers; i++) {
+        PostQueuedCompletionStatus(hPoolIocp, 0, 0, NULL);
+    }
+    WaitForMultipleObjects(dwWorkers, hWorkers, TRUE, INFINITE);
+
+    for (i = 0; i < dwWorkers; i++) {
+        CloseHandle(hWorkers[i]);
+        hWorkers[i] = NULL;
+    }
+    dwWorkers = 0;
+    CloseHandle(hPoolIocp);
+    hPoolIocp = NULL;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitStrand
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Creates the strand's idle event.
+--              Oct 19, 2026
+--              Creates the strand's space event.
+--              Oct 19, 2026
+--              Starts with a stall timeout of STRAND_STALL_TIMEOUT.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitStrand(HWND hWnd, PSTRAND pStrand)
+--                          hWnd    - the handle to the reader's window
+--                          pStrand - the reader's strand
+--
+-- RETURNS:     VOID.
+------------------------------------------------------------------------------*/
+VOID InitStrand(HWND hWnd, PSTRAND pStrand) {
+
+    ZeroMemory(pStrand, sizeof(STRAND));
+    pStrand->hWnd   = hWnd;
+    pStrand->hIdle  = CreateEvent(NULL, TRUE, TRUE, NULL);
+    pStrand->hSpace = CreateEvent(NULL, TRUE, TRUE, NULL);
+    pStrand->dwStallTimeout = STRAND_STALL_TIMEOUT;
+    InitializeCriticalSection(&pStrand->cs);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    SetStrandStall
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID SetStrandStall(PSTRAND pStrand, DWORD dwRxQueue, 
+--                                  DWORD dwBaud)
+--                          pStrand     - the reader's strand
+--                          dwRxQueue   - the size of the port driver's receive
+--                                        buffer, or 0 if it isn't known
+--                          dwBaud      - the port's baud rate
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Sets how long SubmitFrame() waits for room on a full strand:
+--              half the time the line takes to fill the driver's receive
+--              buffer, since the buffer may not be empty when the wait starts.
+--              Called by the read thread when it starts, once the baud rate
+--              has been negotiated.
+------------------------------------------------------------------------------*/
+VOID SetStrandStall(PSTRAND pStrand, DWORD dwRxQueue, DWORD dwBaud) {
+    LONGLONG llTimeout = 0;
+
+    if (dwRxQueue == 0) {
+        dwRxQueue = STRAND_RX_QUEUE;
+    }
+    llTimeout = (LONGLONG) dwRxQueue * RT_BITS_PER_CHAR * 1000 
+              / (2 * max(dwBaud, 1));
+    pStrand->dwStallTimeout = (DWORD) min(llTimeout, STRAND_STALL_TIMEOUT);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    DrainStrand
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID DrainStrand(PSTRAND pStrand)
+--                          pStrand - the reader's strand
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Waits until every frame submitted to the strand has been
+--              decoded, and no worker is running it. The read thread must have
+--              stopped, so that nothing more is submitted.
+------------------------------------------------------------------------------*/
+VOID DrainStrand(PSTRAND pStrand) {
+
+    if (pStrand->hIdle != NULL) {
+        WaitForSingleObject(pStrand->hIdle, INFINITE);
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    SubmitFrame
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Waits up to STRAND_STALL_TIMEOUT for room on a full strand.
+--              Oct 19, 2026
+--              Takes empty frames, which check the block requests.
+--              Oct 19, 2026
+--              Waits up to the strand's dwStallTimeout instead, which is bound
+--              by the port's buffer time.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL SubmitFrame(PSTRAND pStrand, CHAR* pcFrame, 
+--                               DWORD dwLength, PTAGREAD pRead)
+--                          pStrand     - the reader's strand
+--                          pcFrame     - a complete frame
+--                          dwLength    - the number of bytes in the frame, or
+--                                        0 to have the strand check its block
+--                                        requests for timeouts
+--                          pRead       - the frame's timestamps so far, or
+--                                        NULL if pcFrame is ASCII output
+--                                        rather than a binary frame
+--
+-- RETURNS:     False if the frame was dropped because the strand stayed full.
+--
+-- NOTES:
+--              Copies the frame onto the strand, and posts the strand to the
+--              workers if it isn't already waiting for one. Called from the
+--              reader's read thread, which is held up while the strand is
+--              full, for no longer than the strand's dwStallTimeout (see
+--              SetStrandStall()).
+------------------------------------------------------------------------------*/
+BOOL SubmitFrame(PSTRAND pStrand, CHAR* pcFrame, DWORD dwLength, 
+                 PTAGREAD pRead) {
+    PFRAME  pFrame      = NULL;
+    BOOL    bSchedule   = FALSE;
+    FRAME   frame       = {0};
+
+    dwLength = min(dwLength, MAX_FRAME_LENGTH);
+
+    if (hPoolIocp == NULL) {
+        // no workers, so decode it here
+        memcpy(frame.pcData, pcFrame, dwLength);
+        frame.dwLength  = dwLength;
+        frame.bText     = (pRead == NULL);
+        if (pRead != NULL) {
+            frame.tagRead = *pRead;
+        }
+        DecodeFrame(pStrand, &frame);
+        InvalidateRect(pStrand->hWnd, NULL, FALSE);
+        return TRUE;
+    }
+
+    EnterCriticalSection(&pStrand->cs);
+    if (pStrand->dwCount == STRAND_FRAMES) {
+        // the read isn't posted again until the workers catch up
+        pStrand->dwStalls++;
+        ResetEvent(pStrand->hSpace);
+        LeaveCriticalSection(&pStrand->cs);
+        WaitForSingleObject(pStrand->hSpace, pStrand->dwStallTimeout);
+
+        EnterCriticalSection(&pStrand->cs);
+        if (pStrand->dwCount == STRAND_FRAMES) {
+            pStrand->dwDropped++;
+            LeaveCriticalSection(&pStrand->cs);
+            return FALSE;
+        }
+    }
+    pFrame = &pStrand->frames[(pStrand->dwHead + pStrand->dwCount) 
+                              % STRAND_FRAMES];
+    memcpy(pFrame->pcData, pcFrame, dwLength);
+    pFrame->dwLength    = dwLength;
+    pFrame->bText       = (pRead == NULL);
+    if (pRead != NULL) {
+        pFrame->tagRead = *pRead;
+    }
+    pStrand->dwCount++;
+    pStrand->dwFrames++;
+
+    bSchedule = !pStrand->bScheduled;
+    if (bSchedule) {
+        pStrand->bScheduled = TRUE;
+        ResetEvent(pStrand->hIdle);
+    }
+    LeaveCriticalSection(&pStrand->cs);
+
+    if (bSchedule) {
+        PostQueuedCompletionStatus(hPoolIocp, 0, (ULONG_PTR) pStrand, NULL);
+    }
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    WorkerThreadProc
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static DWORD WINAPI WorkerThreadProc(LPVOID lpParam)
+--                          lpParam - unused
+--
+-- RETURNS:     0.
+--
+-- NOTES:
+--              Runs each strand that is posted to the pool. A completion key of
+--              0 tells the worker to exit.
+------------------------------------------------------------------------------*/
+static DWORD WINAPI WorkerThreadProc(LPVOID lpParam) {
+    LPOVERLAPPED    pOv     = NULL;
+    ULONG_PTR       key     = 0;
+    DWORD           dwBytes = 0;
+
+    while (GetQueuedCompletionStatus(hPoolIocp, &dwBytes, &key, &pOv, 
+                                     INFINITE)) {
+        if (key == 0) {
+            break;
+        }
+        RunStrand((PSTRAND) key);
+    }
+    return 0;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    RunStrand
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID RunStrand(PSTRAND pStrand)
+--                          pStrand - a strand taken from the pool's queue
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Decodes the strand's frames in order. A frame's slot is only
+--              given back once it has been decoded, so the read thread never
+--              writes over it. If the batch runs out before the strand is
+--              empty, the strand is posted to the pool again.
+------------------------------------------------------------------------------*/
+static VOID RunStrand(PSTRAND pStrand) {
+    PFRAME  pFrame  = NULL;
+    DWORD   i       = 0;
+
+    for (i = 0; i < STRAND_BATCH; i++) {
+        
+        EnterCriticalSection(&pStrand->cs);
+        if (pStrand->dwCount == 0) {
+            pStrand->bScheduled = FALSE;
+            SetEvent(pStrand->hIdle);
+            LeaveCriticalSection(&pStrand->cs);
+            InvalidateRect(pStrand->hWnd, NULL, FALSE);
+            return;
+        }
+        pFrame = &pStrand->frames[pStrand->dwHead];
+        LeaveCriticalSection(&pStrand->cs);
+
+        DecodeFrame(pStrand, pFrame);
+
+        EnterCriticalSection(&pStrand->cs);
+        pStrand->dwHead = (pStrand->dwHead + 1) % STRAND_FRAMES;
+        if (pStrand->dwCount-- == STRAND_FRAMES) {
+            SetEvent(pStrand->hSpace);
+        }
+        LeaveCriticalSection(&pStrand->cs);
+    }
+    InvalidateRect(pStrand->hWnd, NULL, FALSE);
+
+    // let the other readers have a turn
+    PostQueuedCompletionStatus(hPoolIocp, 0, (ULONG_PTR) pStrand, NULL);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    DecodeFrame
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Replies to block requests go to the block engine.
+--              Oct 19, 2026
+--              The tag count is posted to the read thread, which owns the poll
+--              scheduler.
+--              Oct 19, 2026
+--              An empty frame checks the block requests for timeouts.
+--              Oct 19, 2026
+--              Only a reply to the inventory command is posted to the read
+--              thread.
+--              Oct 19, 2026
+--              No longer resets the reader's arena; nothing decoded uses it.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID DecodeFrame(PSTRAND pStrand, PFRAME pFrame)
+--                          pStrand - the reader's strand
+--                          pFrame  - the frame to decode
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Decodes and displays one frame. If it is a reply to the
+--              inventory command, the read thread is told how many tags it
+--              held (see PostPollResult()); other replies, such as the one to
+--              the init command, don't answer the outstanding request.
+--              ASCII output goes to the escape sequence parser instead, and
+--              replies to block requests to the block engine; neither counts
+--              towards the poll scheduler. The read thread submits an empty
+--              frame every block timeout, so that a lost reply is noticed even
+--              if nothing else arrives.
+------------------------------------------------------------------------------*/
+static VOID DecodeFrame(PSTRAND pStrand, PFRAME pFrame) {
+    PWNDDATA    pwd     = NULL;
+    DWORD       dwTags  = 0;
+    pwd = (PWNDDATA) GetWindowLongPtr(pStrand->hWnd, 0);
+
+    if (pFrame->bText) {
+        ProcessWrite(pStrand->hWnd, pFrame->pcData, pFrame->dwLength);
+        return;
+    }
+    if (pFrame->dwLength == 0) {
+        CheckBlockTimeout(pStrand->hWnd);
+        return;
+    }
+    if (ProcessBlockReply(pStrand->hWnd, pFrame->pcData, pFrame->dwLength,
+                          &pFrame->tagRead)) {
+        return;
+    }
+
+    dwTags = ProcessPacket(pStrand->hWnd, pFrame->pcData, pFrame->dwLength, 
+                           &pFrame->tagRead);
+    if (pFrame->pcData[TAG_OPCODE] == pwd->inventoryCmd.pcFrame[TAG_OPCODE]) {
+        PostPollResult(&pwd->transport, dwTags);
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <Windows.h>
+#include "Tag.h"
+
+#define MAX_WORKERS         16      // decode threads, at most
+#define MAX_FRAME_LENGTH    1024    // the longest frame that is accepted
+#define STRAND_FRAMES       64      // frames waiting per reader
+#define STRAND_BATCH        8       // frames decoded before other readers 
+                                    // get a turn
+#define STRAND_STALL_TIMEOUT 1000   // ms the read thread waits for room on a
+                                    // full strand, at most
+#define STRAND_RX_QUEUE     4096    // bytes the port's driver buffers, if it
+                                    // doesn't say
+
+typedef struct frame {
+    CHAR        pcData[MAX_FRAME_LENGTH];
+    DWORD       dwLength;
+    BOOL        bText;
+    TAGREAD     tagRead;
+} FRAME, *PFRAME;
+
+typedef struct strand {
+    HWND                hWnd;
+    CRITICAL_SECTION    cs;
+    FRAME               frames[STRAND_FRAMES];
+    DWORD               dwHead;
+    DWORD               dwCount;
+    BOOL                bScheduled;
+    HANDLE              hIdle;          // set while bScheduled is false
+    HANDLE              hSpace;         // set while a frame slot is free
+    DWORD               dwStallTimeout; // ms before a frame is dropped
+    DWORD               dwFrames;
+    DWORD               dwStalls;
+    DWORD               dwDropped;
+    DWORD               dwBadFrames;    // failed the LRC, or too short for
+                                        // their tag type
+} STRAND, *PSTRAND;
+
+BOOL    StartWorkerPool(HWND hWnd);
+VOID    StopWorkerPool(VOID);
+VOID    InitStrand(HWND hWnd, PSTRAND pStrand);
+VOID    DrainStrand(PSTRAND pStrand);
+VOID    SetStrandStall(PSTRAND pStrand, DWORD dwRxQueue, DWORD dwBaud);
+BOOL    SubmitFrame(PSTRAND pStrand, CHAR* pcFrame, DWORD dwLength, 
+                    PTAGREAD pRead);
+
+#endif
@@ -6,6 +6,8 @@
 --
 -- FUNCTIONS:
 --              VOID    UpdateDisplayBuf(HWND hWnd, CHAR cCharacter);
+--              VOID    UpdateDisplayRun(HWND hWnd, CHAR* pcRun, 
+--                                       DWORD dwLength);
 --              VOID    HorizontalTab(HWND hWnd);
 --              VOID    FormFeed(HWND hWnd);
 --              VOID    MoveCursor(HWND hWnd, INT cxCoord, INT cyCoord, 
@@ -19,13 +21,38 @@
 --              VOID    SetScrollRegion(HWND hWnd, INT cyTop, INT cyBottom); 
 --              VOID    EchoTag(HWND hWnd, CHAR* pcToken, DWORD dwTokenLength, 
 --                              CHAR* pcData, DWORD dwDataLength)
---				VOID	ProcessPacket(HWND hWnd, CHAR* pcPacket, 
+--				DWORD	ProcessPacket(HWND hWnd, CHAR* pcPacket, 
 --                                    DWORD dwLength);
 --
 -- DATE:        Oct 19, 2010
 --
 -- REVISIONS:   November 4, 2010 - ProcessPacket, EchoTag
 --              November 7, 2010 - Removed a number of unecessary functions.
+--              October 19, 2026 - EchoTag and the scroll functions no longer
+--                                 allocate from the heap.
+--              October 19, 2026 - Added UpdateDisplayRun.
+--              October 19, 2026 - The display buffer is stored as planes, and
+--                                 is cleared and scrolled with FillCells and
+--                                 MoveRows.
+--              October 19, 2026 - The screen is runtime-sized and scrolls
+--                                 into the scrollback. New tags are added at
+--                                 the bottom.
+--              October 19, 2026 - ProcessPacket decodes multi-tag responses.
+--              October 19, 2026 - ISO 15693 tags are passed to the block
+--                                 engine.
+--              October 19, 2026 - Tags are filtered before they are displayed.
+--              October 19, 2026 - Tags are matched against the UID lists, and
+--                                 the result is displayed with them.
+--              October 19, 2026 - Every decoded tag is counted in the read
+--                                 rate rollups.
+--              October 19, 2026 - Every decoded tag is added to the tag
+--                                 analytics sketches.
+--              October 19, 2026 - Tags are passed to the cross-reader
+--                                 correlator.
+--              October 19, 2026 - Tags are saved in the read journal.
+--              October 19, 2026 - Tags are recorded in the inventory.
+--              October 19, 2026 - Tags are published on the shared-memory
+--                                 tag bus.
 --
 -- DESIGNER:    Dean Morin
 --
@@ -39,29 +66,81 @@
 
 #include "Presentation.h"
 
+static DWORD    ProcessTagRecords(HWND hWnd, CHAR* pcPacket, DWORD dwLength,
+                                  PTAGREAD pRead);
+static CHAR*    GetTokenName(BYTE bType);
+static VOID     ShowMatch(HWND hWnd, BYTE bMatch);
+
 /*------------------------------------------------------------------------------
 -- FUNCTION:    ProcessPacket
 --
 -- DATE:        Nov 4, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              Returns the number of tags in the packet, for the poll
+--              scheduler.
+--              Oct 19, 2026
+--              Fills in the tag read, timestamps its decoding and display, and
+--              records it in the latency histograms.
+--              Oct 19, 2026
+--              Replies to the multi-tag inventory are passed to 
+--              ProcessTagRecords().
+--              Oct 19, 2026
+--              Starts a block job for the tag (see Blocks.c).
+--              Oct 19, 2026
+--              Tags rejected by the filter are dropped before they are timed
+--              or displayed.
+--              Oct 19, 2026
+--              Matches the tag against the UID lists.
+--              Oct 19, 2026
+--              Counts the tag in the read rate rollups, even if it is
+--              filtered out.
+--              Oct 19, 2026
+--              Adds the tag to the tag analytics sketches.
+--              Oct 19, 2026
+--              Passes the tag to the cross-reader correlator.
+--              Oct 19, 2026
+--              Saves the tag in the read journal.
+--              Oct 19, 2026
+--              Records the tag in the inventory.
+--              Oct 19, 2026
+--              Publishes the tag on the tag bus.
+--              Oct 19, 2026
+--              Checks the packet is long enough for the tag type's UID before
+--              copying it.
+--              Oct 19, 2026
+--              A packet that fails the LRC, or is too short for its tag type,
+--              is counted and dropped before the tag reaches anything, rather
+--              than shown in a message box from the decode worker.
+--              Oct 19, 2026
+--              An unsupported tag is only displayed again; it has no UID, so
+--              it isn't counted or passed on as a tag.
 --
 -- DESIGNER:    Dean Morin, Marcel Vangrootheest
 --
 -- PROGRAMMER:  Daniel Wright
 --
--- INTERFACE:   VOID ProcessPacket(HWND hWnd, CHAR* pcPacket, DWORD dwLength)
+-- INTERFACE:   DWORD ProcessPacket(HWND hWnd, CHAR* pcPacket, DWORD dwLength,
+--                                  PTAGREAD pRead)
 --                          hWnd    - the handle to the window
 --                          pcPacket - RFID packet
 --							dwLength - number of bytes in the RFID packet
+--                          pRead   - the tag read, with its read and framed
+--                                    times already set
 --
--- RETURNS:     VOID.
+-- RETURNS:     The number of tags reported in the packet.
 --
 -- NOTES:
 --              Calls DetectLRCError to check for errors in the packet.
 --				Calls a function to display token name and data.
+--              A single-tag reply has the tag type at TAG_TYPE, and the UID 
+--              at the end of the packet. A packet that fails the LRC, or is
+--              too short to hold both, is counted in the strand's dwBadFrames
+--              (see View > Rates) and ignored. A tag type that isn't supported
+--              is displayed, but nothing else sees it.
 ------------------------------------------------------------------------------*/
-VOID ProcessPacket(HWND hWnd, CHAR* pcPacket, DWORD dwLength){
+DWORD ProcessPacket(HWND hWnd, CHAR* pcPacket, DWORD dwLength, 
+                    PTAGREAD pRead){
 	PWNDDATA pwd = NULL;
 	
 	CHAR pcToken[512];
@@ -72,58 +151,277 @@ VOID ProcessPacket(HWND hWnd, CHAR* pcPacket, DWORD dwLength){
 	pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
 
 	if(DetectLRCError(pcPacket, dwLength)){
-		DISPLAY_ERROR("Error in RFID Packet");
+		pwd->strand.dwBadFrames++;
+		return 0;
+	}
+	if(dwLength < TAG_TYPE + 1 + CMD_TRAILER_LENGTH){
+		// an empty inventory, or the reply to the init command
+		return 0;
 	}
 	
+	if(pwd->bMultiTag && dwLength > TAG_RECORD_COUNT + CMD_TRAILER_LENGTH &&
+	   pcPacket[TAG_OPCODE] == pwd->inventoryCmd.pcFrame[TAG_OPCODE]){
+		return ProcessTagRecords(hWnd, pcPacket, dwLength, pRead);
+	}
 	
-	switch(pcPacket[7]){
-		case 0x04:
+	switch(pcPacket[TAG_TYPE]){
+		case TAG_ISO15693:
 
-			strcpy(pcToken , "ISO 15693");
+			strcpy(pcToken , GetTokenName(TAG_ISO15693));
 			dwTokenLength = strlen(pcToken);
 			dwDataLength = 8;
+			if(dwLength < TAG_TYPE + 1 + dwDataLength + CMD_TRAILER_LENGTH){
+				pwd->strand.dwBadFrames++;
+				return 0;
+			}
 			j = (dwLength - 3);
 			for(i = 0; i < dwDataLength; i++){
 				pcData[i] = pcPacket[j];
 				j--;
 			}
-			EchoTag(hWnd, pcToken, dwTokenLength, pcData, dwDataLength);
-			return;
-		case 0x05:
+			break;
+		case TAG_TAGIT:
 			
-			strcpy(pcToken , "TAG-IT HF");
+			strcpy(pcToken , GetTokenName(TAG_TAGIT));
 			dwTokenLength = strlen(pcToken);
 			dwDataLength = 4;
+			if(dwLength < TAG_TYPE + 1 + dwDataLength){
+				pwd->strand.dwBadFrames++;
+				return 0;
+			}
 			for(i = 0, j = (dwLength - 1); i < dwDataLength; i++, j--){
 				pcData[i] = pcPacket[j];
 			}
-			EchoTag(hWnd, pcToken, dwTokenLength, pcData, dwDataLength);
-			
-			return;
-		case 0x06:
+			break;
+		case TAG_LF:
 	
-			strcpy(pcToken , "LF R/W");
+			strcpy(pcToken , GetTokenName(TAG_LF));
 			dwTokenLength = strlen(pcToken);
 			dwDataLength = 8;
+			if(dwLength < TAG_TYPE + 1 + dwDataLength + CMD_TRAILER_LENGTH){
+				pwd->strand.dwBadFrames++;
+				return 0;
+			}
 			for(i = 0, j = (dwLength - 3); i < dwDataLength; i++, j--){
 				pcData[i] = pcPacket[j];
 			}
-			EchoTag(hWnd, pcToken, dwTokenLength, pcData, dwDataLength);
-			
-			return;
+			break;
 		
 			
 		default:
-			//Ignore response to Rfid initialization
+			//Ignore response to Rfid initialization, and empty inventories
 			if(pcPacket[1] == 0x09){
-				return;
+				return 0;
 			}
-			strcpy(pcToken, "Unsupported Tag");
-			
-			EchoTag(hWnd, pcToken,15,NULL,0);
-			
-			return;
+			strcpy(pcToken, GetTokenName(TAG_UNSUPPORTED));
+			dwTokenLength = strlen(pcToken);
+			EchoTag(hWnd, pcToken, dwTokenLength, NULL, 0);
+			return 0;
 	}
+
+	pRead->bType = (BYTE) pcPacket[TAG_TYPE];
+	pRead->dwUidLength = dwDataLength;
+	memcpy(pRead->pbUid, pcData, dwDataLength);
+	CountTagRead(&pwd->rollup, pRead);
+	UpdateSketch(&pwd->sketch, pRead);
+	if (!FilterTag(&pwd->filter, pRead)) {
+		// still a tag in the field, as far as the poll scheduler cares
+		return 1;
+	}
+	MatchUid(&pwd->uidLists, pRead);
+	CorrelateTag(pRead);
+	UpdateInventory(pRead);
+	JournalTag(pRead);
+	PublishTag(pRead);
+	pRead->llDecoded = TraceNow();
+
+	EchoTag(hWnd, pcToken, dwTokenLength, pcData, dwDataLength);
+	ShowMatch(hWnd, pRead->bMatch);
+	pRead->llDisplayed = TraceNow();
+	
+	RecordTagRead(&pwd->trace, pRead);
+	StartBlockJob(hWnd, pRead);
+	return 1;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ProcessTagRecords
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Starts a block job for each tag (see Blocks.c).
+--              Oct 19, 2026
+--              Tags rejected by the filter are skipped, but still counted.
+--              Oct 19, 2026
+--              Matches each tag against the UID lists.
+--              Oct 19, 2026
+--              Counts each tag in the read rate rollups.
+--              Oct 19, 2026
+--              Adds each tag to the tag analytics sketches.
+--              Oct 19, 2026
+--              Passes each tag to the cross-reader correlator.
+--              Oct 19, 2026
+--              Saves each tag in the read journal.
+--              Oct 19, 2026
+--              Records each tag in the inventory.
+--              Oct 19, 2026
+--              Publishes each tag on the tag bus.
+--              Oct 19, 2026
+--              A record with an empty UID is skipped, and isn't counted.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   DWORD ProcessTagRecords(HWND hWnd, CHAR* pcPacket, 
+--                                      DWORD dwLength, PTAGREAD pRead)
+--                          hWnd        - the handle to the window
+--                          pcPacket    - a reply to the multi-tag inventory
+--                          dwLength    - the number of bytes in pcPacket
+--                          pRead       - the packet's read and framed times
+--
+-- RETURNS:     The number of tags decoded, not counting records without a
+--              UID.
+--
+-- NOTES:
+--              A multi-tag reply holds a record for every tag that answered
+--              the reader's anti-collision rounds:
+--
+--      SOF | length (2) | device | flags | opcode | status | count | 
+--      records | LRC | ~LRC
+--
+--              where each record is the tag type, the UID length, and the UID
+--              (LSB first). Every tag is displayed and timed on its own, and
+--              all of them share the packet's read and framed times. Decoding
+--              stops at a record that would run past the end of the packet.
+------------------------------------------------------------------------------*/
+static DWORD ProcessTagRecords(HWND hWnd, CHAR* pcPacket, DWORD dwLength,
+                               PTAGREAD pRead) {
+    PWNDDATA    pwd                     = NULL;
+    TAGREAD     tagRead                 = {0};
+    CHAR        pcData[MAX_UID_LENGTH]  = {0};
+    CHAR*       pcToken                 = NULL;
+    DWORD       dwCount                 = 0;
+    DWORD       dwRecord                = 0;
+    DWORD       dwTags                  = 0;
+    DWORD       dwOffset                = TAG_RECORDS;
+    DWORD       dwEnd                   = 0;
+    DWORD       dwUidLength             = 0;
+    DWORD       i                       = 0;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    dwCount = (BYTE) pcPacket[TAG_RECORD_COUNT];
+    dwEnd   = dwLength - CMD_TRAILER_LENGTH;
+
+    for (dwRecord = 0; dwRecord < dwCount; dwRecord++) {
+        if (dwOffset + TAG_RECORD_HEADER > dwEnd) {
+            break;
+        }
+        dwUidLength = (BYTE) pcPacket[dwOffset + 1];
+        if (dwUidLength > MAX_UID_LENGTH  
+                ||  dwOffset + TAG_RECORD_HEADER + dwUidLength > dwEnd) {
+            break;
+        }
+        if (dwUidLength == 0) {
+            // nothing to identify the tag by
+            dwOffset += TAG_RECORD_HEADER;
+            continue;
+        }
+        dwTags++;
+        
+        // the UID is sent LSB first, and displayed MSB first
+        for (i = 0; i < dwUidLength; i++) {
+            pcData[i] = pcPacket[dwOffset + TAG_RECORD_HEADER 
+                                 + dwUidLength - 1 - i];
+        }
+        tagRead             = *pRead;
+        tagRead.bType       = (BYTE) pcPacket[dwOffset];
+        tagRead.dwUidLength = dwUidLength;
+        memcpy(tagRead.pbUid, pcData, dwUidLength);
+        dwOffset           += TAG_RECORD_HEADER + dwUidLength;
+        CountTagRead(&pwd->rollup, &tagRead);
+        UpdateSketch(&pwd->sketch, &tagRead);
+        if (!FilterTag(&pwd->filter, &tagRead)) {
+            continue;
+        }
+        MatchUid(&pwd->uidLists, &tagRead);
+        CorrelateTag(&tagRead);
+        UpdateInventory(&tagRead);
+        JournalTag(&tagRead);
+        PublishTag(&tagRead);
+        tagRead.llDecoded   = TraceNow();
+
+        pcToken = GetTokenName(tagRead.bType);
+        EchoTag(hWnd, pcToken, strlen(pcToken), pcData, dwUidLength);
+        ShowMatch(hWnd, tagRead.bMatch);
+        tagRead.llDisplayed = TraceNow();
+        RecordTagRead(&pwd->trace, &tagRead);
+        StartBlockJob(hWnd, &tagRead);
+    }
+    return dwTags;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetTokenName
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   CHAR* GetTokenName(BYTE bType)
+--                          bType - the tag type reported by the reader
+--
+-- RETURNS:     The name displayed for the tag type.
+------------------------------------------------------------------------------*/
+static CHAR* GetTokenName(BYTE bType) {
+    switch (bType) {
+        case TAG_ISO15693:  return "ISO 15693";
+        case TAG_TAGIT:     return "TAG-IT HF";
+        case TAG_LF:        return "LF R/W";
+        default:            return "Unsupported Tag";
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ShowMatch
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Holds the display buffer's critical section.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID ShowMatch(HWND hWnd, BYTE bMatch)
+--                          hWnd    - the handle to the window
+--                          bMatch  - the tag's result from MatchUid()
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Adds the result to the line EchoTag() just wrote, if there are
+--              UID lists.
+------------------------------------------------------------------------------*/
+static VOID ShowMatch(HWND hWnd, BYTE bMatch) {
+    PWNDDATA    pwd         = NULL;
+    CHAR*       pcResult    = NULL;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    if (bMatch == MATCH_NONE) {
+        return;
+    }
+    pcResult = (bMatch == MATCH_ALLOWED) ? "ALLOWED" : "DENIED";
+    EnterCriticalSection(&pwd->displayBuf.cs);
+    MoveCursor(hWnd, MATCH_COLUMN, LINES_PER_SCRN, FALSE);
+    UpdateDisplayRun(hWnd, pcResult, strlen(pcResult));
+    LeaveCriticalSection(&pwd->displayBuf.cs);
 }
 
 /*------------------------------------------------------------------------------
@@ -131,7 +429,19 @@ VOID ProcessPacket(HWND hWnd, CHAR* pcPacket, DWORD dwLength){
 --
 -- DATE:        Nov 5, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              The hex buffer is no longer leaked.
+--              Oct 19, 2026
+--              The token and the hex are each written as a single run.
+--              Oct 19, 2026
+--              Adds the tag at the bottom, so older tags scroll up into the
+--              scrollback.
+--              Oct 19, 2026
+--              The hex buffer is on the stack, since a tag or a line of block
+--              data is at most ECHO_MAX_BYTES.
+--              Oct 19, 2026
+--              Holds the display buffer's critical section, since it runs on
+--              a decode worker while the UI thread paints.
 --
 -- DESIGNER:    Ian Lee, Marcel Vangrootheest
 --
@@ -148,33 +458,31 @@ VOID ProcessPacket(HWND hWnd, CHAR* pcPacket, DWORD dwLength){
 -- RETURNS:     VOID.
 --
 -- NOTES:
---              Scrolls currently displayed tags down and prints tag to top 
---              of list
+--              Scrolls currently displayed tags up and prints tag to the
+--              bottom of the list
 --
 ------------------------------------------------------------------------------*/
 VOID EchoTag(HWND hWnd, CHAR* pcToken, DWORD dwTokenLength, CHAR* pcData, 
              DWORD dwDataLength){
+	PWNDDATA pwd = NULL;
 	DWORD i;
-	CHAR* temp = (CHAR*)malloc(sizeof(CHAR)*dwDataLength*2);
-    SetScrollRegion(hWnd,2,LINES_PER_SCRN);
-	ScrollUp(hWnd);
-	MoveCursor( hWnd, 1, 2, FALSE);
-	for(i=0;i<dwTokenLength;i++){
-		UpdateDisplayBuf(hWnd,pcToken[i]);
-	}
-    MoveCursor( hWnd, 12, 2, FALSE);
-    
-	for(i=0;i<dwDataLength;i++)
-	  sprintf(temp+2*i, "%02X", (BYTE)pcData[i]);
+	// "XX " per byte, plus the terminating null written by sprintf
+	CHAR temp[ECHO_MAX_BYTES*3 + 1] = {0};
+	pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
 
+	dwDataLength = min(dwDataLength, ECHO_MAX_BYTES);
+	for(i=0;i<dwDataLength;i++)
+	  sprintf(temp+3*i, "%02X ", (BYTE)pcData[i]);
 
-	for(i=0;i<dwDataLength*2;i++){
-      
-        UpdateDisplayBuf(hWnd,temp[i++]);
-		UpdateDisplayBuf(hWnd,temp[i]);
-		UpdateDisplayBuf(hWnd,' ');
-	}
+    EnterCriticalSection(&pwd->displayBuf.cs);
+    SetScrollRegion(hWnd,2,LINES_PER_SCRN);
+	ScrollDown(hWnd);
+	MoveCursor( hWnd, 1, LINES_PER_SCRN, FALSE);
+	UpdateDisplayRun(hWnd, pcToken, dwTokenLength);
+    MoveCursor( hWnd, 12, LINES_PER_SCRN, FALSE);
+	UpdateDisplayRun(hWnd, temp, dwDataLength*3);
     SetScrollRegion(hWnd,1,LINES_PER_SCRN);
+    LeaveCriticalSection(&pwd->displayBuf.cs);
 }
 
 /*------------------------------------------------------------------------------
@@ -182,7 +490,8 @@ VOID EchoTag(HWND hWnd, CHAR* pcToken, DWORD dwTokenLength, CHAR* pcData,
 --
 -- DATE:        Oct 19, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              Writes the cell into the display buffer's planes.
 --
 -- DESIGNER:    Dean Morin
 --
@@ -202,15 +511,14 @@ VOID UpdateDisplayBuf(HWND hWnd, CHAR cCharacter) {
     PWNDDATA    pwd     = NULL;
     CHAR        a[2]    = {0};    
     HDC         hdc     = {0};
-    CHARINFO    ci      = {0};
     pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
 
     a[0] = cCharacter;
      
-    CHARACTER(X, Y).character   = cCharacter;
-    CHARACTER(X, Y).fgColor     = CUR_FG_COLOR;
-	CHARACTER(X, Y).bgColor     = CUR_BG_COLOR;
-	CHARACTER(X, Y).style	    = CUR_STYLE;
+    CELL_CHAR(X, Y)     = cCharacter;
+    CELL_FG(X, Y)       = CUR_FG_COLOR;
+	CELL_BG(X, Y)       = CUR_BG_COLOR;
+	CELL_STYLE(X, Y)    = CUR_STYLE;
     
     if (X >= CHARS_PER_LINE - 1) { 
         if (pwd->wordWrap == FALSE) {
@@ -227,6 +535,61 @@ VOID UpdateDisplayBuf(HWND hWnd, CHAR cCharacter) {
     }
 }
 
+/*------------------------------------------------------------------------------
+-- FUNCTION:    UpdateDisplayRun
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Copies each line of the run into the planes with memcpy and
+--              memset.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID UpdateDisplayRun(HWND hWnd, CHAR* pcRun, DWORD dwLength)
+--                          hWnd        - the handle to the window
+--                          pcRun       - printable characters
+--                          dwLength    - the number of characters in pcRun
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Adds a run of characters to the display buffer, a line at a 
+--              time. The result is the same as calling UpdateDisplayBuf() for
+--              each character: only the last column needs the wrap logic.
+------------------------------------------------------------------------------*/
+VOID UpdateDisplayRun(HWND hWnd, CHAR* pcRun, DWORD dwLength) {
+    
+    PWNDDATA    pwd     = NULL;
+    DWORD       dwCount = 0;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    while (dwLength > 0) {
+        dwCount = min(dwLength, (DWORD) (CHARS_PER_LINE - 1 - X));
+        
+        memcpy(&CELL_CHAR(X, Y), pcRun, dwCount);
+        memset(&CELL_FG(X, Y), CUR_FG_COLOR, dwCount);
+        memset(&CELL_BG(X, Y), CUR_BG_COLOR, dwCount);
+        memset(&CELL_STYLE(X, Y), CUR_STYLE, dwCount);
+        X           += dwCount;
+        pcRun       += dwCount;
+        dwLength    -= dwCount;
+        
+        if (dwLength == 0) {
+            return;
+        }
+        if (pwd->wordWrap == FALSE) {
+            // the rest would all land on the last column
+            pcRun       += dwLength - 1;
+            dwLength    = 1;
+        }
+        UpdateDisplayBuf(hWnd, *pcRun++);
+        dwLength--;
+    }
+}
+
 /*------------------------------------------------------------------------------
 -- FUNCTION:    HorizontalTab
 --
@@ -261,7 +624,8 @@ VOID HorizontalTab(HWND hWnd) {
 --
 -- DATE:        Oct 19, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              Clears the whole buffer with FillCells().
 --
 -- DESIGNER:    Dean Morin
 --
@@ -278,17 +642,9 @@ VOID HorizontalTab(HWND hWnd) {
 ------------------------------------------------------------------------------*/
 VOID FormFeed(HWND hWnd) { 
     PWNDDATA    pwd = NULL;
-    UINT        i   = 0;
-    UINT        j   = 0;
     pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
 
-    for (i = 0; i < LINES_PER_SCRN; i++) {
-        for (j = 0; j < CHARS_PER_LINE; j++) {
-            CHARACTER(j, i).character   = ' ';
-            CHARACTER(j, i).bgColor     = CUR_BG_COLOR;
-            CHARACTER(j, i).style       = 0;
-         }
-    }
+    FillCells(&pwd->displayBuf, 0, 0, LINES_PER_SCRN * CHARS_PER_LINE);
     X = 0;
     Y = 0;
 }
@@ -355,7 +711,8 @@ VOID MoveCursor(HWND hWnd, INT cxCoord, INT cyCoord, BOOL bScroll) {
 --
 -- DATE:        Oct 19, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              Clears the span with FillCells().
 --
 -- DESIGNER:    Dean Morin
 --
@@ -380,17 +737,16 @@ VOID MoveCursor(HWND hWnd, INT cxCoord, INT cyCoord, BOOL bScroll) {
 ------------------------------------------------------------------------------*/
 VOID ClearLine(HWND hWnd, UINT cxCoord, UINT cyCoord, INT iDirection) {
     PWNDDATA    pwd = NULL;
-    UINT        i   = 0;
-    UINT        j   = 0;
     pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
     
-    i = cyCoord;
-    j = cxCoord;
-    while (j < CHARS_PER_LINE  &&  j >= 0) {
-        CHARACTER(j, i).character   = ' ';
-        CHARACTER(j, i).bgColor     = CUR_BG_COLOR;
-        CHARACTER(j, i).style       = 0;
-        j += iDirection;
+    if (cxCoord >= CHARS_PER_LINE  ||  cyCoord >= LINES_PER_SCRN) {
+        return;
+    }
+    if (iDirection == CLR_RIGHT) {
+        FillCells(&pwd->displayBuf, cxCoord, cyCoord, 
+                  CHARS_PER_LINE - cxCoord);
+    } else {
+        FillCells(&pwd->displayBuf, 0, cyCoord, cxCoord + 1);
     }
 }
 
@@ -399,7 +755,9 @@ VOID ClearLine(HWND hWnd, UINT cxCoord, UINT cyCoord, INT iDirection) {
 --
 -- DATE:        Oct 19, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              Clears the cells in one call to FillCells(), since the rows
+--              are contiguous.
 --
 -- DESIGNER:    Dean Morin
 --
@@ -424,21 +782,20 @@ VOID ClearLine(HWND hWnd, UINT cxCoord, UINT cyCoord, INT iDirection) {
 --              that cxCoord and cyCoord use a (0,0) origin.
 ------------------------------------------------------------------------------*/
 VOID ClearScreen(HWND hWnd, UINT cxCoord, UINT cyCoord, INT iDirection) {
-    PWNDDATA    pwd = NULL;
-    UINT        i   = 0;
-    UINT        j   = 0;
+    PWNDDATA    pwd     = NULL;
+    UINT        uiCell  = 0;
     pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
 
-    ClearLine(hWnd, cxCoord, cyCoord, iDirection);
-
-    i = cyCoord + iDirection;
-    while (i < LINES_PER_SCRN  &&  i >= 0) {
-        for (j = 0; j < CHARS_PER_LINE; j++) {
-            CHARACTER(j, i).character   = ' ';
-            CHARACTER(j, i).bgColor     = CUR_BG_COLOR;
-            CHARACTER(j, i).style       = 0;
-         }
-         i += iDirection;
+    if (cxCoord >= CHARS_PER_LINE  ||  cyCoord >= LINES_PER_SCRN) {
+        return;
+    }
+    uiCell = cyCoord * CHARS_PER_LINE + cxCoord;
+    
+    if (iDirection == CLR_DOWN) {
+        FillCells(&pwd->displayBuf, cxCoord, cyCoord, 
+                  LINES_PER_SCRN * CHARS_PER_LINE - uiCell);
+    } else {
+        FillCells(&pwd->displayBuf, 0, 0, uiCell + 1);
     }
 }
 
@@ -447,7 +804,14 @@ VOID ClearScreen(HWND hWnd, UINT cxCoord, UINT cyCoord, INT iDirection) {
 --
 -- DATE:        Oct 19, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              The deleted top line is blanked and reused as the new line
+--              instead of being freed and reallocated.
+--              Oct 19, 2026
+--              Moves the lines with MoveRows().
+--              Oct 19, 2026
+--              A region that reaches the bottom of the screen scrolls into
+--              the scrollback.
 --
 -- DESIGNER:    Dean Morin
 --
@@ -461,26 +825,21 @@ VOID ClearScreen(HWND hWnd, UINT cxCoord, UINT cyCoord, INT iDirection) {
 -- NOTES:
 --              "Scrolls down" one line. It moves every line on the screen up
 --              one position, deleting the top line, and creating a new, blank
---              bottom line.
+--              bottom line. If the scroll region ends at the bottom of the
+--              screen, the top line is kept in the scrollback instead of
+--              being deleted (see AdvanceDisplay()).
 ------------------------------------------------------------------------------*/
 VOID ScrollDown(HWND hWnd) {
-    PWNDDATA    pwd         = NULL;
-    PLINE       pNewLine    = NULL;
-    INT         i           = 0;
-    INT         j           = 0;
+    PWNDDATA    pwd = NULL;
     pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0); 
-    pNewLine = (PLINE) malloc(sizeof(LINE));
-    free(ROW(WINDOW_TOP));
 
-    for (i = WINDOW_TOP; i < WINDOW_BOTTOM; i++) {
-        ROW(i) = ROW(i + 1);
-    }
-    ROW(i) = pNewLine;
-    for (j = 0; j < CHARS_PER_LINE; j++) {
-        CHARACTER(j, i).character   = ' ';
-        CHARACTER(j, i).bgColor     = CUR_BG_COLOR;
-        CHARACTER(j, i).style       = 0;
+    if (WINDOW_BOTTOM == (INT) LINES_PER_SCRN - 1
+            &&  AdvanceDisplay(&pwd->displayBuf, WINDOW_TOP)) {
+        return;
     }
+    MoveRows(&pwd->displayBuf, WINDOW_TOP, WINDOW_TOP + 1, 
+             WINDOW_BOTTOM - WINDOW_TOP);
+    FillCells(&pwd->displayBuf, 0, WINDOW_BOTTOM, CHARS_PER_LINE);
 }
 
 /*------------------------------------------------------------------------------
@@ -488,7 +847,11 @@ VOID ScrollDown(HWND hWnd) {
 --
 -- DATE:        Oct 19, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              The deleted bottom line is blanked and reused as the new line
+--              instead of being freed and reallocated.
+--              Oct 19, 2026
+--              Moves the lines with MoveRows().
 --
 -- DESIGNER:    Dean Morin
 --
@@ -505,23 +868,12 @@ VOID ScrollDown(HWND hWnd) {
 --              blank top line.
 ------------------------------------------------------------------------------*/
 VOID ScrollUp(HWND hWnd) {
-    PWNDDATA    pwd         = NULL;
-    PLINE       pNewLine    = NULL;
-    INT         i           = 0;
-    INT         j           = 0;
+    PWNDDATA    pwd = NULL;
     pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0); 
-    pNewLine = (PLINE) malloc(sizeof(LINE));
-    free(ROW(WINDOW_BOTTOM));
     
-    for (i = WINDOW_BOTTOM; i > WINDOW_TOP; i--) {
-        ROW(i) = ROW(i - 1);
-    }
-    ROW(i) = pNewLine;
-    for (j = 0; j < CHARS_PER_LINE; j++) {
-        CHARACTER(j, i).character   = ' ';
-        CHARACTER(j, i).bgColor     = CUR_BG_COLOR;
-        CHARACTER(j, i).style       = 0;
-    }
+    MoveRows(&pwd->displayBuf, WINDOW_TOP + 1, WINDOW_TOP, 
+             WINDOW_BOTTOM - WINDOW_TOP);
+    FillCells(&pwd->displayBuf, 0, WINDOW_TOP, CHARS_PER_LINE);
 }
 
 /*------------------------------------------------------------------------------
@@ -9,6 +9,9 @@
 #define CLR_DOWN    1
 #define CLR_LEFT    -1
 #define CLR_RIGHT   1
+#define MATCH_COLUMN    40  // where a tag's allow/deny result is displayed
+#define ECHO_MAX_BYTES  BLOCK_LINE_BYTES    // the most bytes EchoTag() shows,
+                                            // a line of block data
 
 
 VOID	EchoTag(HWND hWnd, CHAR* pcToken, DWORD dwTokenLength, CHAR* pcData, 
@@ -22,6 +25,8 @@ VOID    ScrollDown(HWND hWnd);
 VOID    ScrollUp(HWND hWnd);
 VOID    SetScrollRegion(HWND hWnd, INT cyTop, INT cyBottom); 
 VOID    UpdateDisplayBuf(HWND hWnd, CHAR cCharacter);
-VOID	ProcessPacket(HWND hWnd, CHAR* pcPacket, DWORD dwLength);
+VOID    UpdateDisplayRun(HWND hWnd, CHAR* pcRun, DWORD dwLength);
+DWORD	ProcessPacket(HWND hWnd, CHAR* pcPacket, DWORD dwLength, 
+                      PTAGREAD pRead);
 
 #endif
@@ -0,0 +1,204 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Realtime.c - Contains the scheduling options for the read
+--                               thread.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    InitRealtime(HWND);
+--              BOOL    ApplyRealtime(HWND, HANDLE);
+--              VOID    SampleSchedDelay(HWND);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- On a busy gateway the read thread can sit waiting for a CPU while the UART
+-- fills up, which ends in CE_OVERRUN. The [Realtime] section of the
+-- configuration file can pin the read thread to one CPU (numbered from 0),
+-- raise its priority, and lock its receive buffers into memory so that they
+-- never have to be paged in:
+--
+--      [Realtime]
+--      Cpu=-1
+--      Priority=normal
+--      LockMemory=0
+--
+-- Priority is one of idle, lowest, below, normal, above, highest or critical.
+-- "critical" is THREAD_PRIORITY_TIME_CRITICAL, the nearest thing Windows has
+-- to SCHED_FIFO without putting the whole process in the real-time class.
+--
+-- Every RT_SAMPLE_INTERVAL reads, the read thread looks at how many bytes 
+-- have arrived since its last read completed. At the current baud rate those
+-- bytes have been waiting at least that many character times, which is an
+-- estimate of how long the thread took to be scheduled. Overruns are counted
+-- at the same time.
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+static LPCTSTR lpszPriorityNames[] = {
+    TEXT("idle"), TEXT("lowest"), TEXT("below"), TEXT("normal"), 
+    TEXT("above"), TEXT("highest"), TEXT("critical")
+};
+static INT iPriorities[] = {
+    THREAD_PRIORITY_IDLE, THREAD_PRIORITY_LOWEST, 
+    THREAD_PRIORITY_BELOW_NORMAL, THREAD_PRIORITY_NORMAL,
+    THREAD_PRIORITY_ABOVE_NORMAL, THREAD_PRIORITY_HIGHEST, 
+    THREAD_PRIORITY_TIME_CRITICAL
+};
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitRealtime
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitRealtime(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Reads the [Realtime] settings, and locks the receive buffers if
+--              asked to. The process's working set is grown first if it is too
+--              small to lock them.
+------------------------------------------------------------------------------*/
+VOID InitRealtime(HWND hWnd) {
+    PWNDDATA    pwd             = NULL;
+    PRTOPTIONS  pRt             = NULL;
+    TCHAR       szPriority[16]  = {0};
+    SIZE_T      dwMin           = 0;
+    SIZE_T      dwMax           = 0;
+    DWORD       i               = 0;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pRt = &pwd->realtime;
+
+    pRt->iCpu           = (INT) ReadConfigInt(hWnd, TEXT("Realtime"), 
+                                              TEXT("Cpu"), RT_ANY_CPU);
+    pRt->bLockMemory    = ReadConfigInt(hWnd, TEXT("Realtime"), 
+                                        TEXT("LockMemory"), FALSE);
+    pRt->iPriority      = THREAD_PRIORITY_NORMAL;
+
+    ReadConfigString(hWnd, TEXT("Realtime"), TEXT("Priority"), 
+                     TEXT("normal"), szPriority, 16);
+    for (i = 0; i < sizeof(iPriorities) / sizeof(INT); i++) {
+        if (lstrcmpi(szPriority, lpszPriorityNames[i]) == 0) {
+            pRt->iPriority = iPriorities[i];
+        }
+    }
+
+    if (!pRt->bLockMemory) {
+        return;
+    }
+    if (!VirtualLock(&pwd->transport, sizeof(TRANSPORT))) {
+        GetProcessWorkingSetSize(GetCurrentProcess(), &dwMin, &dwMax);
+        SetProcessWorkingSetSize(GetCurrentProcess(), 
+                                 dwMin + sizeof(TRANSPORT) * 2,
+                                 dwMax + sizeof(TRANSPORT) * 2);
+        if (!VirtualLock(&pwd->transport, sizeof(TRANSPORT))) {
+            DISPLAY_ERROR("Could not lock the receive buffers into memory");
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ApplyRealtime
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL ApplyRealtime(HWND hWnd, HANDLE hThread)
+--                          hWnd    - the handle to the window
+--                          hThread - the reader's read thread
+--
+-- RETURNS:     False if the affinity or priority could not be set.
+--
+-- NOTES:
+--              Pins the read thread and sets its priority. Called each time
+--              the port is opened, since that starts a new thread.
+------------------------------------------------------------------------------*/
+BOOL ApplyRealtime(HWND hWnd, HANDLE hThread) {
+    PWNDDATA    pwd     = NULL;
+    PRTOPTIONS  pRt     = NULL;
+    BOOL        bResult = TRUE;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pRt = &pwd->realtime;
+
+    if (pRt->iCpu >= 0) {
+        if (pRt->iCpu >= (INT) (sizeof(DWORD_PTR) * 8)  ||  
+                SetThreadAffinityMask(hThread, (DWORD_PTR) 1 << pRt->iCpu) 
+                == 0) {
+            bResult = FALSE;
+        }
+    }
+    if (!SetThreadPriority(hThread, pRt->iPriority)) {
+        bResult = FALSE;
+    }
+    return bResult;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    SampleSchedDelay
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID SampleSchedDelay(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Called by the read thread after each read that brought in data.
+--              Every RT_SAMPLE_INTERVAL calls, it estimates the scheduling
+--              delay from the bytes waiting in the driver, and counts any
+--              overrun.
+------------------------------------------------------------------------------*/
+VOID SampleSchedDelay(HWND hWnd) {
+    PWNDDATA    pwd         = NULL;
+    PRTOPTIONS  pRt         = NULL;
+    COMSTAT     cs          = {0};
+    DWORD       dwErrors    = 0;
+    DWORD       dwBaud      = 0;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pRt = &pwd->realtime;
+
+    if (++pRt->dwReads % RT_SAMPLE_INTERVAL != 0) {
+        return;
+    }
+    if (!ClearCommError(pwd->hPort, &dwErrors, &cs)) {
+        return;
+    }
+    if (dwErrors & CE_OVERRUN) {
+        pRt->dwOverruns++;
+    }
+    dwBaud = max(pwd->cc.dcb.BaudRate, 1);
+
+    pRt->dwDelayUs = (DWORD) ((LONGLONG) cs.cbInQue * RT_BITS_PER_CHAR 
+                              * 1000000 / dwBaud);
+    pRt->dwMaxDelayUs = max(pRt->dwMaxDelayUs, pRt->dwDelayUs);
+    pRt->llTotalDelayUs += pRt->dwDelayUs;
+    pRt->dwSamples++;
+}
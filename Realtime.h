@@ -0,0 +1,26 @@
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <Windows.h>
+
+#define RT_ANY_CPU          -1
+#define RT_SAMPLE_INTERVAL  16      // reads between scheduling delay samples
+#define RT_BITS_PER_CHAR    10      // start, 8 data and stop bits
+
+typedef struct rtOptions {
+    INT         iCpu;
+    INT         iPriority;
+    BOOL        bLockMemory;
+    DWORD       dwReads;
+    DWORD       dwSamples;
+    DWORD       dwDelayUs;
+    DWORD       dwMaxDelayUs;
+    LONGLONG    llTotalDelayUs;
+    DWORD       dwOverruns;
+} RTOPTIONS, *PRTOPTIONS;
+
+VOID    InitRealtime(HWND hWnd);
+BOOL    ApplyRealtime(HWND hWnd, HANDLE hThread);
+VOID    SampleSchedDelay(HWND hWnd);
+
+#endif
@@ -0,0 +1,360 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Rollup.c - Contains the counts of tag reads per second and
+--                             per minute.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    InitRollup(HWND);
+--              VOID    CountTagRead(PROLLUP, PTAGREAD);
+--              DWORD   GetRollup(PROLLUP, BOOL, DWORD, PROLLUPSAMPLE);
+--              VOID    ShowRollup(HWND);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- Every decoded tag (including those the filter rejects) is counted by type
+-- in two rings: one bucket per second for the last minute, and one per minute
+-- for the last hour. A read adds one to a bucket in each ring, and the first
+-- read of a new period clears the bucket it lands in; nothing is allocated and
+-- nothing is locked. The period is taken from the performance counter reading
+-- the tag already carries, so counting costs no extra system calls.
+--
+-- Only the reader's strand counts reads. A snapshot (GetRollup()) may be taken
+-- from any thread at the same time: it reads each bucket's period before and
+-- after copying its counts, and treats a bucket that was cleared in between as
+-- empty. A snapshot may miss reads counted while it is being taken, but never
+-- mixes up two periods.
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+static VOID     AddToBucket(PROLLUPBUCKET pBucket, LONG lPeriod, DWORD dwType);
+static DWORD    GetRollupType(BYTE bType);
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitRollup
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitRollup(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Empties both rings.
+------------------------------------------------------------------------------*/
+VOID InitRollup(HWND hWnd) {
+    PWNDDATA        pwd = NULL;
+    LARGE_INTEGER   li  = {0};
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    ZeroMemory(&pwd->rollup, sizeof(ROLLUP));
+    QueryPerformanceFrequency(&li);
+    pwd->rollup.llFrequency = li.QuadPart;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CountTagRead
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID CountTagRead(PROLLUP pRollup, PTAGREAD pRead)
+--                          pRollup - the reader's counts
+--                          pRead   - a decoded tag, with its framed time set
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Counts the read in the second and the minute its frame was
+--              completed. Called from the reader's strand.
+------------------------------------------------------------------------------*/
+VOID CountTagRead(PROLLUP pRollup, PTAGREAD pRead) {
+    LONG    lSecond = 0;
+    DWORD   dwType  = 0;
+
+    if (pRollup->llFrequency == 0) {
+        return;
+    }
+    lSecond = (LONG) (pRead->llFramed / pRollup->llFrequency);
+    dwType  = GetRollupType(pRead->bType);
+
+    AddToBucket(&pRollup->seconds[lSecond % ROLLUP_SECONDS], lSecond, dwType);
+    AddToBucket(&pRollup->minutes[(lSecond / 60) % ROLLUP_MINUTES],
+                lSecond / 60, dwType);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetRollup
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   DWORD GetRollup(PROLLUP pRollup, BOOL bMinutes, DWORD dwCount,
+--                              PROLLUPSAMPLE pSamples)
+--                          pRollup     - the reader's counts
+--                          bMinutes    - whether to read the per-minute ring
+--                                        rather than the per-second one
+--                          dwCount     - the number of periods wanted
+--                          pSamples    - receives them, oldest first
+--
+-- RETURNS:     The number of samples filled in, at most the size of the ring.
+--
+-- NOTES:
+--              Takes a snapshot of the most recent periods, ending with the
+--              current one (which is still being counted). Periods without
+--              reads are filled with zeros. May be called from any thread.
+------------------------------------------------------------------------------*/
+DWORD GetRollup(PROLLUP pRollup, BOOL bMinutes, DWORD dwCount,
+                PROLLUPSAMPLE pSamples) {
+    PROLLUPBUCKET   pRing       = NULL;
+    PROLLUPBUCKET   pBucket     = NULL;
+    DWORD           dwRing      = 0;
+    LONG            lNow        = 0;
+    LONG            lBefore     = 0;
+    DWORD           i           = 0;
+    DWORD           j           = 0;
+
+    if (pRollup->llFrequency == 0) {
+        return 0;
+    }
+    pRing   = bMinutes ? pRollup->minutes : pRollup->seconds;
+    dwRing  = bMinutes ? ROLLUP_MINUTES : ROLLUP_SECONDS;
+    dwCount = min(dwCount, dwRing);
+    lNow    = (LONG) (TraceNow() / pRollup->llFrequency);
+    if (bMinutes) {
+        lNow /= 60;
+    }
+
+    for (i = 0; i < dwCount; i++) {
+        pSamples[i].lPeriod = lNow - (LONG) (dwCount - 1 - i);
+        pBucket = &pRing[pSamples[i].lPeriod % dwRing];
+
+        lBefore = pBucket->lPeriod;
+        MemoryBarrier();
+        for (j = 0; j < ROLLUP_TYPES; j++) {
+            pSamples[i].dwReads[j] = pBucket->dwReads[j];
+        }
+        MemoryBarrier();
+
+        if (lBefore != pSamples[i].lPeriod
+                ||  pBucket->lPeriod != pSamples[i].lPeriod) {
+            // stale, or cleared while it was being copied
+            ZeroMemory(pSamples[i].dwReads, sizeof(pSamples[i].dwReads));
+        }
+    }
+    return dwCount;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ShowRollup
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Shows how often the reader's strand was full.
+--              Oct 19, 2026
+--              Shows how many frames were corrupt.
+--              Oct 19, 2026
+--              Shows how much of the read thread's arena was used.
+--              Oct 19, 2026
+--              Shows the reconnect supervisor's counts.
+--              Oct 19, 2026
+--              Shows the read thread's scheduling delay and overruns.
+--              Oct 19, 2026
+--              Shows the percentiles of the latency histograms.
+--              Oct 19, 2026
+--              Shows the transport's counts.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID ShowRollup(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Shows the reads per second of each tag type: the average and
+--              the busiest second over the last minute, and the average over
+--              the last hour. The current, partly counted, period is left out.
+--              Below them are the frames the read thread had to wait for the
+--              workers on, and the frames it dropped (see SubmitFrame()).
+--              Next to those is the read thread's scheduling delay: the last
+--              and the largest sample, the average, and the overruns the port
+--              reported (see SampleSchedDelay()).
+--              The transport's counts follow: the reads and writes posted,
+--              the commands queued and dropped, the writes cancelled for
+--              taking too long, and the completions the read thread woke for.
+--              Then the most of the read thread's arena used at once, the
+--              heap allocations it needed, and the ones that failed.
+--              Last are the times the port was lost, the attempts made to
+--              reopen it, the ones that worked, and the total time it was
+--              down (see Supervisor.c), and the latency of each stage a tag
+--              goes through (see FormatTraceSummary()).
+------------------------------------------------------------------------------*/
+VOID ShowRollup(HWND hWnd) {
+    static LPCTSTR lpszTypes[ROLLUP_TYPES] = {
+        TEXT("Unsupported"), TEXT("ISO 15693"), TEXT("TAG-IT HF"),
+        TEXT("LF R/W")
+    };
+    PWNDDATA        pwd                         = NULL;
+    ROLLUPSAMPLE    seconds[ROLLUP_SECONDS]     = {0};
+    ROLLUPSAMPLE    minutes[ROLLUP_MINUTES]     = {0};
+    TCHAR           szText[2048]                = {0};
+    DWORD           dwLength                    = 0;
+    DWORD           dwMinute                    = 0;
+    DWORD           dwPeak                      = 0;
+    DWORD           dwHour                      = 0;
+    DWORD           dwAvgDelayUs                = 0;
+    DWORD           i                           = 0;
+    DWORD           j                           = 0;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    GetRollup(&pwd->rollup, FALSE, ROLLUP_SECONDS, seconds);
+    GetRollup(&pwd->rollup, TRUE, ROLLUP_MINUTES, minutes);
+
+    dwLength = wsprintf(szText, TEXT("Reads per second\t")
+                        TEXT("last minute (peak)\tlast hour\n"));
+    for (j = 0; j < ROLLUP_TYPES; j++) {
+        dwMinute    = 0;
+        dwPeak      = 0;
+        dwHour      = 0;
+        for (i = 0; i < ROLLUP_SECONDS - 1; i++) {
+            dwMinute   += seconds[i].dwReads[j];
+            dwPeak      = max(dwPeak, seconds[i].dwReads[j]);
+        }
+        for (i = 0; i < ROLLUP_MINUTES - 1; i++) {
+            dwHour     += minutes[i].dwReads[j];
+        }
+        dwLength += wsprintf(szText + dwLength, TEXT("%s\t\t%u (%u)\t\t%u\n"),
+                             lpszTypes[j], dwMinute / (ROLLUP_SECONDS - 1),
+                             dwPeak, dwHour / ((ROLLUP_MINUTES - 1) * 60));
+    }
+    dwLength += wsprintf(szText + dwLength,
+                         TEXT("\nFrames %u, waited for the workers %u, ")
+                         TEXT("dropped %u, corrupt %u\n"),
+                         pwd->strand.dwFrames, pwd->strand.dwStalls,
+                         pwd->strand.dwDropped, pwd->strand.dwBadFrames);
+    if (pwd->realtime.dwSamples > 0) {
+        dwAvgDelayUs = (DWORD) (pwd->realtime.llTotalDelayUs 
+                                / pwd->realtime.dwSamples);
+    }
+    dwLength += wsprintf(szText + dwLength,
+                         TEXT("Read delay %u us (max %u, avg %u), ")
+                         TEXT("overruns %u\n"),
+                         pwd->realtime.dwDelayUs, pwd->realtime.dwMaxDelayUs,
+                         dwAvgDelayUs, pwd->realtime.dwOverruns);
+    dwLength += wsprintf(szText + dwLength,
+                         TEXT("Reads posted %u, writes posted %u, ")
+                         TEXT("commands queued %u, dropped %u\n")
+                         TEXT("Write timeouts %u, completions %u\n"),
+                         pwd->transport.dwReadsPosted,
+                         pwd->transport.dwWritesPosted,
+                         pwd->transport.dwCommandsQueued,
+                         pwd->transport.dwCommandsDropped,
+                         pwd->transport.dwWriteTimeouts,
+                         pwd->transport.dwCompletions);
+    dwLength += wsprintf(szText + dwLength,
+                         TEXT("Arena %u of %u bytes, heap allocations %u, ")
+                         TEXT("failed %u\n"),
+                         pwd->ioArena.dwHighWater, pwd->ioArena.dwCapacity,
+                         pwd->ioArena.dwHeapAllocs, pwd->ioArena.dwFailures);
+    dwLength += wsprintf(szText + dwLength,
+                         TEXT("Port lost %u, reconnect attempts %u, ")
+                         TEXT("reconnected %u, down %u s\n"),
+                         pwd->supervisor.dwPortLost, pwd->supervisor.dwAttempts,
+                         pwd->supervisor.dwReconnects,
+                         pwd->supervisor.dwDowntime / 1000);
+    dwLength += FormatTraceSummary(&pwd->trace, szText + dwLength);
+    MessageBox(hWnd, szText, TEXT("Read Rates"), MB_OK);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    AddToBucket
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID AddToBucket(PROLLUPBUCKET pBucket, LONG lPeriod,
+--                                      DWORD dwType)
+--                          pBucket - the bucket the period maps to
+--                          lPeriod - the read's second or minute
+--                          dwType  - the read's index in dwReads
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              If the bucket still holds an older period, it is marked as
+--              being cleared, cleared, and then given the new period. The
+--              interlocked writes keep a snapshot from seeing the new period
+--              before the counts are zero.
+------------------------------------------------------------------------------*/
+static VOID AddToBucket(PROLLUPBUCKET pBucket, LONG lPeriod, DWORD dwType) {
+    DWORD i = 0;
+
+    if (pBucket->lPeriod != lPeriod) {
+        InterlockedExchange(&pBucket->lPeriod, ROLLUP_RESETTING);
+        for (i = 0; i < ROLLUP_TYPES; i++) {
+            pBucket->dwReads[i] = 0;
+        }
+        InterlockedExchange(&pBucket->lPeriod, lPeriod);
+    }
+    pBucket->dwReads[dwType]++;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetRollupType
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static DWORD GetRollupType(BYTE bType)
+--                          bType - the tag type reported by the reader
+--
+-- RETURNS:     The tag type's index in a bucket.
+------------------------------------------------------------------------------*/
+static DWORD GetRollupType(BYTE bType) {
+    switch (bType) {
+        case TAG_ISO15693:  return 1;
+        case TAG_TAGIT:     return 2;
+        case TAG_LF:        return 3;
+        default:            return 0;
+    }
+}
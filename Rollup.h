@@ -0,0 +1,37 @@
+#ifndef ROLLUP_H
+#define ROLLUP_H
+
+#include <Windows.h>
+#include "Tag.h"
+
+#define ROLLUP_SECONDS      60      // per-second buckets kept
+#define ROLLUP_MINUTES      60      // per-minute buckets kept
+#define ROLLUP_TYPES        4       // unsupported, ISO 15693, Tag-it, LF
+#define ROLLUP_RESETTING    -1      // a bucket's period while it is cleared
+
+// A bucket holds the reads of one second (or minute) of the performance
+// counter. Only the reader's strand writes to it; lPeriod tells a snapshot
+// which period the counts belong to, and whether they are being cleared.
+typedef struct rollupBucket {
+    volatile LONG   lPeriod;
+    volatile DWORD  dwReads[ROLLUP_TYPES];
+} ROLLUPBUCKET, *PROLLUPBUCKET;
+
+typedef struct rollup {
+    LONGLONG        llFrequency;
+    ROLLUPBUCKET    seconds[ROLLUP_SECONDS];
+    ROLLUPBUCKET    minutes[ROLLUP_MINUTES];
+} ROLLUP, *PROLLUP;
+
+typedef struct rollupSample {
+    LONG    lPeriod;
+    DWORD   dwReads[ROLLUP_TYPES];
+} ROLLUPSAMPLE, *PROLLUPSAMPLE;
+
+VOID    InitRollup(HWND hWnd);
+VOID    CountTagRead(PROLLUP pRollup, PTAGREAD pRead);
+DWORD   GetRollup(PROLLUP pRollup, BOOL bMinutes, DWORD dwCount,
+                  PROLLUPSAMPLE pSamples);
+VOID    ShowRollup(HWND hWnd);
+
+#endif
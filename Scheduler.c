@@ -0,0 +1,125 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Scheduler.c - Contains the functions that decide how often
+--                                the RFID reader is polled.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    InitPollScheduler(HWND);
+--              VOID    UpdatePollScheduler(PPOLLSCHED, DWORD);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- A reader with no tags in front of it doesn't need to be asked for an
+-- inventory as fast as it can answer. After a few empty inventories in a row,
+-- the delay before the next request is doubled each round, up to a maximum.
+-- As soon as a tag is seen the delay drops straight back to the minimum.
+--
+-- The limits are set in the [Polling] section of the configuration file:
+--
+--      [Polling]
+--      MinInterval=0
+--      MaxInterval=500
+--      BackoffAfter=3
+--      ReplyTimeout=1000
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitPollScheduler
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitPollScheduler(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Reads the polling limits from the configuration file and starts
+--              the reader at its fastest rate.
+------------------------------------------------------------------------------*/
+VOID InitPollScheduler(HWND hWnd) {
+    PWNDDATA    pwd     = NULL;
+    PPOLLSCHED  pSched  = NULL;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pSched  = &pwd->pollSched;
+
+    pSched->dwMinInterval   = ReadConfigInt(hWnd, TEXT("Polling"),
+                                            TEXT("MinInterval"),
+                                            POLL_MIN_INTERVAL);
+    pSched->dwMaxInterval   = ReadConfigInt(hWnd, TEXT("Polling"),
+                                            TEXT("MaxInterval"),
+                                            POLL_MAX_INTERVAL);
+    pSched->dwBackoffAfter  = ReadConfigInt(hWnd, TEXT("Polling"),
+                                            TEXT("BackoffAfter"),
+                                            POLL_BACKOFF_AFTER);
+    pSched->dwReplyTimeout  = ReadConfigInt(hWnd, TEXT("Polling"),
+                                            TEXT("ReplyTimeout"),
+                                            POLL_REPLY_TIMEOUT);
+
+    if (pSched->dwMaxInterval < pSched->dwMinInterval) {
+        pSched->dwMaxInterval = pSched->dwMinInterval;
+    }
+    pSched->dwInterval      = pSched->dwMinInterval;
+    pSched->dwEmptyRounds   = 0;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    UpdatePollScheduler
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID UpdatePollScheduler(PPOLLSCHED pSched, DWORD dwTags)
+--                          pSched  - the reader's scheduler
+--                          dwTags  - the number of tags in the last inventory
+--                                    (0 if the reader didn't answer)
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Adjusts the delay before the next inventory request based on the
+--              result of the last one. Only the reader's read thread calls
+--              this; the workers post their tag counts to it.
+------------------------------------------------------------------------------*/
+VOID UpdatePollScheduler(PPOLLSCHED pSched, DWORD dwTags) {
+
+    if (dwTags > 0) {
+        pSched->dwEmptyRounds   = 0;
+        pSched->dwInterval      = pSched->dwMinInterval;
+        return;
+    }
+
+    if (++pSched->dwEmptyRounds < pSched->dwBackoffAfter) {
+        return;
+    }
+    if (pSched->dwInterval < POLL_BACKOFF_STEP) {
+        pSched->dwInterval = POLL_BACKOFF_STEP;
+    } else {
+        pSched->dwInterval *= 2;
+    }
+    if (pSched->dwInterval > pSched->dwMaxInterval) {
+        pSched->dwInterval = pSched->dwMaxInterval;
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Windows.h>
+
+#define POLL_MIN_INTERVAL   0       // ms between requests while tags are seen
+#define POLL_MAX_INTERVAL   500     // ms between requests on an idle reader
+#define POLL_BACKOFF_AFTER  3       // empty inventories before backing off
+#define POLL_BACKOFF_STEP   10      // ms, the first step when backing off
+                                    // from a minimum interval of 0
+#define POLL_REPLY_TIMEOUT  1000    // ms to wait for a reply to a request
+
+typedef struct pollSched {
+    DWORD   dwMinInterval;
+    DWORD   dwMaxInterval;
+    DWORD   dwBackoffAfter;
+    DWORD   dwReplyTimeout;
+    DWORD   dwInterval;
+    DWORD   dwEmptyRounds;
+} POLLSCHED, *PPOLLSCHED;
+
+VOID    InitPollScheduler(HWND hWnd);
+VOID    UpdatePollScheduler(PPOLLSCHED pSched, DWORD dwTags);
+
+#endif
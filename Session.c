@@ -6,15 +6,21 @@
 --
 -- FUNCTIONS:
 --              BOOL    Connect(HWND);
+--              BOOL    OpenPort(HWND, BOOL);
 --              VOID    Disconnect(HWND);
+--              VOID    ClosePort(HWND);
 --              VOID    SelectPort(HWND, INT);
 --				VOID	InitRfid(HWND);
+--              BOOL    NegotiateBaudRate(HWND);
 --
 -- DATE:        Oct 19, 2010
 --
 -- REVISIONS:   Nov 06, 2010
 --              Dean    - Modified Disconnect() to be more event driven.
 --              Daniel  - Added InitRfid() and updated Connect.
+--              Oct 19, 2026
+--              Split OpenPort() and ClosePort() out of Connect() and
+--              Disconnect() for the reconnect supervisor.
 --
 -- DESIGNER:    Dean Morin, Daniel Wright
 --
@@ -35,6 +41,10 @@
 --
 -- REVISIONS:   Nov 6, 2010 - Added initialization of rfid scanner and printing
 --								headers for token display.
+--              Oct 19, 2026 - Applies the comm settings and negotiates the
+--                             baud rate before initializing the scanner.
+--              Oct 19, 2026 - Moved the port setup into OpenPort() so that the
+--                             supervisor can reconnect without any dialogues.
 --
 -- DESIGNER:    Dean Morin
 --
@@ -53,10 +63,74 @@
 ------------------------------------------------------------------------------*/
 BOOL Connect(HWND hWnd) {
     
+    PWNDDATA        pwd         = {0};
+    DWORD           i           = 0;
+	
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    if (!OpenPort(hWnd, TRUE)) {
+        return FALSE;
+    }
+	
+    CUR_FG_COLOR = 7;
+    CUR_BG_COLOR = 0;
+    CUR_STYLE    = 0;
+	BRIGHTNESS	 = 0;
+	pwd->cursorMode = TRUE;
+                                
+    // enable/disable appropriate menu choices
+    EnableMenuItem(GetMenu(hWnd), IDM_DISCONNECT, MF_ENABLED);
+    EnableMenuItem(GetMenu(hWnd), IDM_CONNECT,    MF_GRAYED);
+    EnableMenuItem(GetMenu(hWnd), IDM_COMMSET,    MF_GRAYED);
+    for (i = 0; i < NO_OF_PORTS; i++) {
+        EnableMenuItem(GetMenu(hWnd), IDM_COM1 + i, MF_GRAYED);
+    }        
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    OpenPort
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Associates the port with a completion port before starting the
+--              read thread.
+--              Oct 19, 2026
+--              The completion port is opened before InitRfid(), which queues 
+--              its command on it.
+--              Oct 19, 2026
+--              Applies the read thread's CPU and priority.
+--              Oct 19, 2026
+--              Applies the latency profile before starting the read thread.
+--              Oct 19, 2026
+--              Fails if the reader doesn't answer at any baud rate.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL OpenPort(HWND hWnd, BOOL bShowErrors)
+--                          hWnd        - the handle to the window
+--                          bShowErrors - whether to display dialogues for
+--                                        errors
+--
+-- RETURNS:     True if the port was opened, the reader answered, and the read
+--              thread started.
+--
+-- NOTES:
+--              Opens the serial port, sets its comm settings, negotiates the
+--              baud rate, initializes the RFID reader and creates the read
+--              thread. This was the body of Connect(), but the supervisor also
+--              uses it to reconnect, in which case errors are not displayed.
+--              If the reader doesn't answer, the port is closed again; the
+--              supervisor then retries later.
+------------------------------------------------------------------------------*/
+BOOL OpenPort(HWND hWnd, BOOL bShowErrors) {
+    
     PWNDDATA        pwd         = {0};
     COMMTIMEOUTS    timeOut     = {0};
     DWORD           dwThreadid  = 0;
-    DWORD           i           = 0;
 	
     pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
 
@@ -67,6 +141,10 @@ BOOL Connect(HWND hWnd) {
                           FILE_FLAG_OVERLAPPED, NULL);
 
     if (pwd->hPort == INVALID_HANDLE_VALUE) {
+        pwd->hPort = NULL;
+        if (!bShowErrors) {
+            return FALSE;
+        }
         if (GetLastError() == ERROR_FILE_NOT_FOUND) {
             DISPLAY_ERROR("Serial port does not exist");
         } else {
@@ -77,50 +155,75 @@ BOOL Connect(HWND hWnd) {
     pwd->bConnected = TRUE;
 
 
-    if (!EscapeCommFunction(pwd->hPort, SETRTS)) {
+    if (!EscapeCommFunction(pwd->hPort, SETRTS)  &&  bShowErrors) {
         DISPLAY_ERROR("Error sending RTS signal");
     }
-    if (!EscapeCommFunction(pwd->hPort, SETDTR)) {
+    if (!EscapeCommFunction(pwd->hPort, SETDTR)  &&  bShowErrors) {
         DISPLAY_ERROR("Error sending DTR signal");
     }
 
     // set timeouts for the port
     if (!GetCommTimeouts(pwd->hPort, &pwd->defaultTimeOuts)) {
-        DISPLAY_ERROR("Error retrieving comm timeouts");
+        if (bShowErrors) {
+            DISPLAY_ERROR("Error retrieving comm timeouts");
+        }
+        ClosePort(hWnd);
         return FALSE;   
     }
     timeOut.ReadIntervalTimeout         = 10;
     timeOut.WriteTotalTimeoutConstant   = 5000;
 
     if (!SetCommTimeouts(pwd->hPort, &timeOut)) {
-        DISPLAY_ERROR("Could not set comm timeouts");
+        if (bShowErrors) {
+            DISPLAY_ERROR("Could not set comm timeouts");
+        }
+        ClosePort(hWnd);
+        return FALSE;
+    }
+
+    // find the reader's baud rate, and move to the fastest one we can
+    if (!SetCommState(pwd->hPort, &pwd->cc.dcb)  &&  bShowErrors) {
+        DISPLAY_ERROR("Could not apply the comm settings");
+    }
+    if (!NegotiateBaudRate(hWnd)) {
+        if (bShowErrors) {
+            DISPLAY_ERROR("The RFID reader did not respond at any baud rate");
+        }
+        ClosePort(hWnd);
+        return FALSE;
+    }
+
+    // from here on, all I/O on the port completes on the completion port
+    if (!OpenTransport(&pwd->transport, pwd->hPort)) {
+        if (bShowErrors) {
+            DISPLAY_ERROR("Error creating I/O completion port");
+        }
+        ClosePort(hWnd);
         return FALSE;
     }
+
     //Initialize Rfid scanner
 	InitRfid(hWnd);
+
+    // switch from the negotiation timeouts to the latency profile's
+    if (!ApplyLatencyProfile(hWnd)  &&  bShowErrors) {
+        DISPLAY_ERROR("Could not set the latency profile's timeouts");
+    }
     // create thread for reading
     pwd->hThread = CreateThread(NULL, 0,
                                 (LPTHREAD_START_ROUTINE) ReadThreadProc,
                                 hWnd, 0, &dwThreadid);
 
-    if (pwd->hThread == INVALID_HANDLE_VALUE) {
-        DISPLAY_ERROR("Error creating read thread");
+    if (pwd->hThread == NULL) {
+        if (bShowErrors) {
+            DISPLAY_ERROR("Error creating read thread");
+        }
+        ClosePort(hWnd);
         return FALSE;
     }
-	
-    CUR_FG_COLOR = 7;
-    CUR_BG_COLOR = 0;
-    CUR_STYLE    = 0;
-	BRIGHTNESS	 = 0;
-	pwd->cursorMode = TRUE;
-                                
-    // enable/disable appropriate menu choices
-    EnableMenuItem(GetMenu(hWnd), IDM_DISCONNECT, MF_ENABLED);
-    EnableMenuItem(GetMenu(hWnd), IDM_CONNECT,    MF_GRAYED);
-    EnableMenuItem(GetMenu(hWnd), IDM_COMMSET,    MF_GRAYED);
-    for (i = 0; i < NO_OF_PORTS; i++) {
-        EnableMenuItem(GetMenu(hWnd), IDM_COM1 + i, MF_GRAYED);
-    }        
+    if (!ApplyRealtime(hWnd, pwd->hThread)  &&  bShowErrors) {
+        DISPLAY_ERROR("Could not set the read thread's CPU or priority");
+    }
     return TRUE;
 }
 
@@ -131,6 +234,9 @@ BOOL Connect(HWND hWnd) {
 --
 -- REVISIONS:   Nov 16, 2010
 --              This function now creates and signals the event "disconnected".
+--              Oct 19, 2026
+--              Moved the port shutdown into ClosePort(), and stops any
+--              reconnect that is waiting to happen.
 --
 -- DESIGNER:    Dean Morin
 --
@@ -148,41 +254,79 @@ BOOL Connect(HWND hWnd) {
 VOID Disconnect(HWND hWnd) {
 
     PWNDDATA        pwd         = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
-    COMMTIMEOUTS    timeOut     = {0};
-    HANDLE          hEvent      = 0;
-    DWORD           dwThreadid  = 0;
     DWORD           i           = 0;
     
+    if (!CancelReconnect(hWnd)  &&  pwd->hPort == NULL) {
+        return;
+    }
+    ClosePort(hWnd);
+	
+    // enable/disable appropriate menu choices    
+    EnableMenuItem(GetMenu(hWnd), IDM_DISCONNECT, MF_GRAYED);
+    EnableMenuItem(GetMenu(hWnd), IDM_CONNECT,    MF_ENABLED);
+    EnableMenuItem(GetMenu(hWnd), IDM_COMMSET,    MF_ENABLED);
+    for (i = 0; i < NO_OF_PORTS; i++) {
+        EnableMenuItem(GetMenu(hWnd), IDM_COM1 + i, MF_ENABLED);
+    }	
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ClosePort
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Wakes the read thread through its completion port rather than
+--              the "disconnected" event.
+--              Oct 19, 2026
+--              Waits for the workers to finish the reader's frames before
+--              closing the completion port.
+--              Oct 19, 2026
+--              Queues the block requests in flight again.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID ClosePort(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Stops the read thread (if it hasn't already stopped on its own),
+--              waits for the workers to decode what it submitted, and closes
+--              the serial port. The menus are left alone, since the
+--              supervisor closes the port while it is still "connected".
+------------------------------------------------------------------------------*/
+VOID ClosePort(HWND hWnd) {
+
+    PWNDDATA        pwd         = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    
     if (pwd->hPort == NULL) {
         return;
     }
 
     // this will end the outer while loop in the read thread
     pwd->bConnected = FALSE;
-    hEvent = CreateEvent(NULL, TRUE, FALSE, TEXT("disconnected"));
-	SetEvent(hEvent);
+    WakeTransport(&pwd->transport);
    
-    if (!SetCommTimeouts(pwd->hPort, &pwd->defaultTimeOuts)) {
-        DISPLAY_ERROR("Could not reset comm timeouts to defaults");
-    }
+    // may fail if the device is gone, which doesn't matter here
+    SetCommTimeouts(pwd->hPort, &pwd->defaultTimeOuts);
 
     // let the read thread finish up
-    do {
-        GetExitCodeThread(pwd->hThread, &dwThreadid);
-    } while (dwThreadid == STILL_ACTIVE);
+    if (pwd->hThread != NULL) {
+        WaitForSingleObject(pwd->hThread, INFINITE);
+        CloseHandle(pwd->hThread);
+        pwd->hThread = NULL;
+    }
 
-    ResetEvent(hEvent);
-    CloseHandle(pwd->hThread);
+    // the workers may still queue commands for the frames they have
+    DrainStrand(&pwd->strand);
+    ResetBlockEngine(hWnd);
+    CloseTransport(&pwd->transport);
     CloseHandle(pwd->hPort);
     pwd->hPort = NULL;
-	
-    // enable/disable appropriate menu choices    
-    EnableMenuItem(GetMenu(hWnd), IDM_DISCONNECT, MF_GRAYED);
-    EnableMenuItem(GetMenu(hWnd), IDM_CONNECT,    MF_ENABLED);
-    EnableMenuItem(GetMenu(hWnd), IDM_COMMSET,    MF_ENABLED);
-    for (i = 0; i < NO_OF_PORTS; i++) {
-        EnableMenuItem(GetMenu(hWnd), IDM_COM1 + i, MF_ENABLED);
-    }	
 }
 
 /*------------------------------------------------------------------------------
@@ -237,7 +381,12 @@ VOID SelectPort(HWND hWnd, INT iSelected) {
 --
 -- DATE:        Nov 6, 2010
 --
--- REVISIONS:   (Date and Description)
+-- REVISIONS:   Oct 19, 2026
+--              Sends the init command built by LoadCommandSet() rather than a
+--              hard-coded frame.
+--              Oct 19, 2026
+--              Queues the command rather than writing it with an OVERLAPPED
+--              that went out of scope before the write finished.
 --
 -- DESIGNER:    Daniel Wright
 --
@@ -251,23 +400,278 @@ VOID SelectPort(HWND hWnd, INT iSelected) {
 --
 -- NOTES:
 --              Initializes settings for the RFID scanner. Called everytime
---				a connection is made.
+--				a connection is made, before the read thread starts, so the
+--              command goes out ahead of the first inventory request.
 ------------------------------------------------------------------------------*/
 VOID InitRfid(HWND hWnd){
 	PWNDDATA pwd;
-	CHAR        psWriteBuf[26]   = {0x30, 0x31, 0x30, 0x41, 0x30, 0x30, 0x30, 0x33, 0x30, 0x31, 0x34,
-									0x33, 0x30, 0x36, 0x30, 0x30, 0x01, 0x0A, 0x00, 0x03, 0x01, 0x43,
-									0x06, 0x00, 0x4C, 0xB3};
-	
-    OVERLAPPED  overlap         = {0};
-    DWORD       dwBytesRead     = 0;
-    UINT        bufLength       = 26;
 	pwd = (PWNDDATA)GetWindowLongPtr(hWnd, 0);
 	
-	if (!WriteFile(pwd->hPort, psWriteBuf, bufLength, &dwBytesRead, &overlap)) {
-        if (GetLastError() != ERROR_IO_PENDING) {
-            DISPLAY_ERROR("Failed to initialize RFID reader");
-        }
+	if (!QueueCommand(&pwd->transport, &pwd->initCmd)) {
+        DISPLAY_ERROR("Failed to initialize RFID reader");
     }
 	
-}
\ No newline at end of file
+}
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ReadBaudRates
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static DWORD ReadBaudRates(HWND hWnd, DWORD* pdwRates)
+--                          hWnd        - the handle to the window
+--                          pdwRates    - receives up to MAX_BAUD_RATES rates
+--
+-- RETURNS:     The number of rates read.
+--
+-- NOTES:
+--              Reads the list of baud rates to try from the configuration
+--              file. The list is sorted from slowest to fastest.
+------------------------------------------------------------------------------*/
+static DWORD ReadBaudRates(HWND hWnd, DWORD* pdwRates) {
+    TCHAR   szRates[CMD_TEMPLATE_SIZE]  = {0};
+    TCHAR*  p                           = NULL;
+    DWORD   dwCount                     = 0;
+    DWORD   dwRate                      = 0;
+    DWORD   i                           = 0;
+    DWORD   j                           = 0;
+
+    ReadConfigString(hWnd, TEXT("Baud"), TEXT("Rates"), BAUD_RATES,
+                     szRates, CMD_TEMPLATE_SIZE);
+
+    for (p = szRates; *p != '\0'  &&  dwCount < MAX_BAUD_RATES; ) {
+        while (*p == ' '  ||  *p == ',') {
+            p++;
+        }
+        for (dwRate = 0; *p >= '0'  &&  *p <= '9'; p++) {
+            dwRate = dwRate * 10 + (*p - '0');
+        }
+        if (dwRate > 0) {
+            pdwRates[dwCount++] = dwRate;
+        } else if (*p != '\0') {
+            p++;
+        }
+    }
+
+    // insertion sort, the list is tiny
+    for (i = 1; i < dwCount; i++) {
+        dwRate = pdwRates[i];
+        for (j = i; j > 0  &&  pdwRates[j - 1] > dwRate; j--) {
+            pdwRates[j] = pdwRates[j - 1];
+        }
+        pdwRates[j] = dwRate;
+    }
+    return dwCount;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    SetHostBaudRate
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static BOOL SetHostBaudRate(HWND hWnd, DWORD dwBaud)
+--                          hWnd    - the handle to the window
+--                          dwBaud  - the new baud rate
+--
+-- RETURNS:     True if the port accepted the rate.
+--
+-- NOTES:
+--              Changes the baud rate of our end of the connection. The rate is
+--              kept in the window extra's DCB, so it is used on the next
+--              connection as well.
+------------------------------------------------------------------------------*/
+static BOOL SetHostBaudRate(HWND hWnd, DWORD dwBaud) {
+    PWNDDATA    pwd         = NULL;
+    DWORD       dwPrevBaud  = 0;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    dwPrevBaud              = pwd->cc.dcb.BaudRate;
+    pwd->cc.dcb.BaudRate    = dwBaud;
+
+    if (!SetCommState(pwd->hPort, &pwd->cc.dcb)) {
+        pwd->cc.dcb.BaudRate = dwPrevBaud;
+        return FALSE;
+    }
+    PurgeComm(pwd->hPort, PURGE_RXCLEAR | PURGE_TXCLEAR);
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    HostSupportsBaud
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static BOOL HostSupportsBaud(LPCOMMPROP pcp, DWORD dwBaud)
+--                          pcp     - the properties of the open port
+--                          dwBaud  - the baud rate to check
+--
+-- RETURNS:     True if the port can be set to dwBaud.
+--
+-- NOTES:
+--              Rates that have no BAUD_* flag are left for SetCommState() to
+--              accept or reject.
+------------------------------------------------------------------------------*/
+static BOOL HostSupportsBaud(LPCOMMPROP pcp, DWORD dwBaud) {
+
+    if (pcp->dwMaxBaud == BAUD_USER) {
+        return TRUE;
+    }
+    switch (dwBaud) {
+        case CBR_9600:      return pcp->dwSettableBaud & BAUD_9600;
+        case CBR_19200:     return pcp->dwSettableBaud & BAUD_19200;
+        case CBR_38400:     return pcp->dwSettableBaud & BAUD_38400;
+        case CBR_57600:     return pcp->dwSettableBaud & BAUD_57600;
+        case CBR_115200:    return pcp->dwSettableBaud & BAUD_115200;
+        default:            return TRUE;
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ProbeReader
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static BOOL ProbeReader(HWND hWnd, DWORD dwTimeout)
+--                          hWnd        - the handle to the window
+--                          dwTimeout   - ms to wait for each reply
+--
+-- RETURNS:     True if the reader answered at the port's current rate.
+--
+-- NOTES:
+--              Sends the init command first. A reader that has just powered up
+--              only understands its ascii-hex prefix, and won't answer a binary
+--              inventory request until it has been initialized. If the init
+--              gets no reply, the reader may already be in binary mode, so an
+--              inventory request is tried as well.
+------------------------------------------------------------------------------*/
+static BOOL ProbeReader(HWND hWnd, DWORD dwTimeout) {
+    PWNDDATA pwd = NULL;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    return TransactCommand(hWnd, &pwd->initCmd, dwTimeout)
+        || TransactCommand(hWnd, &pwd->inventoryCmd, dwTimeout);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    NegotiateBaudRate
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Probes with the init command before the inventory request, and
+--              puts the port back to its settings on entry if it fails.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL NegotiateBaudRate(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     False if the reader didn't answer at any baud rate, or stopped
+--              answering. The port is then back at the settings it had on
+--              entry.
+--
+-- NOTES:
+--              Finds the reader's current baud rate by probing it (see
+--              ProbeReader()) at each rate in the [Baud] section of the
+--              configuration file until one gets a valid reply. The rate in use
+--              is tried first, so this is quick once the rates have been
+--              negotiated.
+--
+--              It then tries to move both ends to the fastest rate that the
+--              port supports and that has a command for switching the reader
+--              (Baud<rate> in the [Commands] section). None are shipped, so by
+--              default the reader stays at the rate it was found at. A switch
+--              only sticks if the reader answers another inventory request at
+--              the new rate; otherwise the port goes back to the old rate and
+--              the next fastest is tried.
+--
+--              Reconnect attempts call this on a thread of their own (see
+--              Supervisor.c), so their probing doesn't block the window.
+------------------------------------------------------------------------------*/
+BOOL NegotiateBaudRate(HWND hWnd) {
+    PWNDDATA    pwd                     = NULL;
+    COMMPROP    cp                      = {0};
+    COMMAND     setBaudCmd              = {0};
+    TCHAR       szKey[32]               = {0};
+    DWORD       pdwRates[MAX_BAUD_RATES]= {0};
+    DWORD       dwCount                 = 0;
+    DWORD       dwTimeout               = 0;
+    DWORD       dwBaud                  = 0;
+    DWORD       i                       = 0;
+    BOOL        bFound                  = FALSE;
+    DCB         dcbSaved                = {0};
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    dcbSaved    = pwd->cc.dcb;
+    dwCount     = ReadBaudRates(hWnd, pdwRates);
+    dwTimeout   = ReadConfigInt(hWnd, TEXT("Baud"), TEXT("ProbeTimeout"),
+                                BAUD_PROBE_TIMEOUT);
+    GetCommProperties(pwd->hPort, &cp);
+
+    // detect the reader's current rate
+    bFound = ProbeReader(hWnd, dwTimeout);
+    for (i = 0; i < dwCount  &&  !bFound; i++) {
+        if (pdwRates[i] != pwd->cc.dcb.BaudRate  &&
+                HostSupportsBaud(&cp, pdwRates[i])  &&
+                SetHostBaudRate(hWnd, pdwRates[i])) {
+            bFound = ProbeReader(hWnd, dwTimeout);
+        }
+    }
+    if (!bFound) {
+        pwd->cc.dcb = dcbSaved;
+        SetCommState(pwd->hPort, &pwd->cc.dcb);
+        return FALSE;
+    }
+    dwBaud = pwd->cc.dcb.BaudRate;
+
+    // step up to the fastest rate that both ends will accept
+    for (i = dwCount; i-- > 0  &&  pdwRates[i] > dwBaud; ) {
+        
+        wsprintf(szKey, TEXT("Baud%lu"), pdwRates[i]);
+        if (!HostSupportsBaud(&cp, pdwRates[i])  ||
+                !LoadCommand(hWnd, &setBaudCmd, szKey, TEXT(""), FALSE)) {
+            continue;
+        }
+        // the reader acknowledges at the old rate, then switches
+        if (!TransactCommand(hWnd, &setBaudCmd, dwTimeout)) {
+            continue;
+        }
+        if (SetHostBaudRate(hWnd, pdwRates[i])  &&
+                TransactCommand(hWnd, &pwd->inventoryCmd, dwTimeout)) {
+            return TRUE;
+        }
+        // the new rate didn't work, so make sure we can still talk
+        SetHostBaudRate(hWnd, dwBaud);
+        if (!TransactCommand(hWnd, &pwd->inventoryCmd, dwTimeout)) {
+            pwd->cc.dcb = dcbSaved;
+            SetCommState(pwd->hPort, &pwd->cc.dcb);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
@@ -4,8 +4,15 @@
 #include "Main.h"
 
 BOOL    Connect(HWND hWnd);
+BOOL    OpenPort(HWND hWnd, BOOL bShowErrors);
 VOID    Disconnect(HWND hWnd);
+VOID    ClosePort(HWND hWnd);
 VOID    SelectPort(HWND hWnd, INT iSelected);
 VOID	InitRfid(HWND hWnd);
+BOOL    NegotiateBaudRate(HWND hWnd);
+
+#define BAUD_PROBE_TIMEOUT  200     // ms to wait for a reply at each rate
+#define BAUD_RATES          TEXT("9600 19200 38400 57600 115200")
+#define MAX_BAUD_RATES      16
 
 #endif
@@ -0,0 +1,496 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Sketch.c - Contains the sketches that estimate how many
+--                             different tags a reader saw, and which it saw
+--                             most.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    InitSketch(HWND);
+--              VOID    UpdateSketch(PSKETCH, PTAGREAD);
+--              VOID    MergeSketch(PSKETCHWINDOW, PSKETCHWINDOW);
+--              DOUBLE  EstimateDistinct(PSKETCHWINDOW);
+--              DWORD   GetTopTags(PSKETCHWINDOW, PTOPTAG, DWORD);
+--              VOID    ShowSketch(HWND);
+--              VOID    CloseSketch(HWND);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- Time is split into windows of Window seconds, aligned to the system clock
+-- so that windows from different readers and hosts line up. For each window,
+-- every decoded tag updates two sketches of fixed size:
+--
+-- A HyperLogLog sketch counts the distinct UIDs. The top SKETCH_BITS of the
+-- UID's hash pick a register, which keeps the longest run of leading zeros
+-- seen in the rest of the hash. SKETCH_REGISTERS one-byte registers give an
+-- estimate within about 1.6%, however many tags there are.
+--
+-- A Space-Saving sketch finds the most read tags. It counts SKETCH_TOP UIDs.
+-- A UID that isn't counted takes over the slot with the lowest count, and
+-- starts from that count, which is kept as its possible overcount. Any tag
+-- read more than 1/SKETCH_TOP of the time is always in the sketch.
+--
+-- Both sketches merge: registers take the maximum, and counts add. So the
+-- windows of several readers, or of several hosts, can be combined with
+-- MergeSketch() into the window of a whole site. When a window ends it is
+-- appended to File, if one is set, as a SKETCHWINDOW record.
+--
+--      [Sketch]
+--      Window=3600
+--      File=sketch.bin
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+#include <math.h>
+
+static VOID AddToTopTags(PSKETCHWINDOW pWindow, ULONGLONG ullUid);
+static VOID WriteSketch(PSKETCH pSketch, PSKETCHWINDOW pWindow);
+static INT  CompareTopTags(const VOID* pA, const VOID* pB);
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitSketch
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitSketch(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Empties the sketches and reads the [Sketch] section of the
+--              configuration file. Must be called after InitConfig().
+------------------------------------------------------------------------------*/
+VOID InitSketch(HWND hWnd) {
+    PWNDDATA    pwd     = NULL;
+    PSKETCH     pSketch = NULL;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pSketch = &pwd->sketch;
+
+    ZeroMemory(pSketch, sizeof(SKETCH));
+    InitializeCriticalSection(&pSketch->cs);
+    ReadConfigPath(hWnd, TEXT("Sketch"), TEXT("File"), pSketch->szFile);
+
+    pSketch->current.dwMagic    = SKETCH_MAGIC;
+    pSketch->current.dwSeconds  = max(1, ReadConfigInt(hWnd, TEXT("Sketch"),
+                                                       TEXT("Window"),
+                                                       SKETCH_WINDOW));
+    pSketch->previous           = pSketch->current;
+    pSketch->bInitialized       = TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    UpdateSketch
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID UpdateSketch(PSKETCH pSketch, PTAGREAD pRead)
+--                          pSketch - the reader's sketches
+--                          pRead   - a decoded tag
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Adds the tag to the current window, starting a new one first
+--              if the clock has moved past it. Called from the reader's
+--              strand; the lock is only ever contended by ShowSketch().
+------------------------------------------------------------------------------*/
+VOID UpdateSketch(PSKETCH pSketch, PTAGREAD pRead) {
+    PSKETCHWINDOW   pWindow     = NULL;
+    FILETIME        ft          = {0};
+    ULONGLONG       ullWindow   = 0;
+    ULONGLONG       ullUid      = 0;
+    ULONGLONG       ullHash     = 0;
+    DWORD           dwRegister  = 0;
+    BYTE            bRank       = 1;
+
+    if (!pSketch->bInitialized) {
+        return;
+    }
+    pWindow = &pSketch->current;
+    GetSystemTimeAsFileTime(&ft);
+    ullWindow = (((ULONGLONG) ft.dwHighDateTime << 32) | ft.dwLowDateTime)
+              / 10000000 / pWindow->dwSeconds;
+    ullUid  = PackUid(pRead);
+    ullHash = HashUid(ullUid);
+
+    // the register, and the position of the first 1 in the rest of the hash
+    dwRegister = (DWORD) (ullHash >> (64 - SKETCH_BITS));
+    ullHash  <<= SKETCH_BITS;
+    while (bRank <= 64 - SKETCH_BITS  &&  !(ullHash >> 63)) {
+        bRank++;
+        ullHash <<= 1;
+    }
+
+    EnterCriticalSection(&pSketch->cs);
+    if (pWindow->ullWindow != ullWindow) {
+        if (pWindow->dwReads > 0) {
+            pSketch->previous = *pWindow;
+            WriteSketch(pSketch, &pSketch->previous);
+        }
+        ZeroMemory(pWindow->pbRegisters, sizeof(pWindow->pbRegisters));
+        pWindow->ullWindow  = ullWindow;
+        pWindow->dwReader   = pRead->dwReader;
+        pWindow->dwReads    = 0;
+        pWindow->dwTopCount = 0;
+    }
+    if (bRank > pWindow->pbRegisters[dwRegister]) {
+        pWindow->pbRegisters[dwRegister] = bRank;
+    }
+    AddToTopTags(pWindow, ullUid);
+    pWindow->dwReads++;
+    LeaveCriticalSection(&pSketch->cs);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    MergeSketch
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID MergeSketch(PSKETCHWINDOW pInto, PSKETCHWINDOW pFrom)
+--                          pInto   - a window, which receives the merge
+--                          pFrom   - the same window from another reader or
+--                                    host
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              The distinct count of the merge is that of the union of the
+--              tags. The top tags' counts and possible overcounts are added,
+--              and the SKETCH_TOP highest are kept.
+------------------------------------------------------------------------------*/
+VOID MergeSketch(PSKETCHWINDOW pInto, PSKETCHWINDOW pFrom) {
+    TOPTAG  tags[SKETCH_TOP * 2]    = {0};
+    DWORD   dwTags                  = 0;
+    DWORD   i                       = 0;
+    DWORD   j                       = 0;
+
+    for (i = 0; i < SKETCH_REGISTERS; i++) {
+        pInto->pbRegisters[i] = max(pInto->pbRegisters[i],
+                                    pFrom->pbRegisters[i]);
+    }
+    if (pInto->dwReader != pFrom->dwReader) {
+        pInto->dwReader = SKETCH_ANY_READER;
+    }
+    pInto->dwReads += pFrom->dwReads;
+
+    for (i = 0; i < pInto->dwTopCount; i++) {
+        tags[dwTags++] = pInto->topTags[i];
+    }
+    for (i = 0; i < pFrom->dwTopCount; i++) {
+        for (j = 0; j < pInto->dwTopCount; j++) {
+            if (tags[j].ullUid == pFrom->topTags[i].ullUid) {
+                tags[j].dwCount += pFrom->topTags[i].dwCount;
+                tags[j].dwError += pFrom->topTags[i].dwError;
+                break;
+            }
+        }
+        if (j == pInto->dwTopCount) {
+            tags[dwTags++] = pFrom->topTags[i];
+        }
+    }
+    qsort(tags, dwTags, sizeof(TOPTAG), CompareTopTags);
+    pInto->dwTopCount = min(dwTags, SKETCH_TOP);
+    memcpy(pInto->topTags, tags, pInto->dwTopCount * sizeof(TOPTAG));
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    EstimateDistinct
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   DOUBLE EstimateDistinct(PSKETCHWINDOW pWindow)
+--                          pWindow - a window
+--
+-- RETURNS:     The estimated number of distinct tags in the window.
+--
+-- NOTES:
+--              The HyperLogLog estimate, which is the harmonic mean of 2 to
+--              the power of each register, scaled. While many registers are
+--              still empty it is biased, so linear counting of the empty
+--              registers is used instead.
+------------------------------------------------------------------------------*/
+DOUBLE EstimateDistinct(PSKETCHWINDOW pWindow) {
+    DOUBLE  dSum        = 0;
+    DOUBLE  dEstimate   = 0;
+    DOUBLE  dM          = SKETCH_REGISTERS;
+    DWORD   dwEmpty     = 0;
+    DWORD   i           = 0;
+
+    for (i = 0; i < SKETCH_REGISTERS; i++) {
+        dSum += ldexp(1.0, -pWindow->pbRegisters[i]);
+        if (pWindow->pbRegisters[i] == 0) {
+            dwEmpty++;
+        }
+    }
+    dEstimate = 0.7213 / (1 + 1.079 / dM) * dM * dM / dSum;
+    if (dEstimate <= 2.5 * dM  &&  dwEmpty > 0) {
+        dEstimate = dM * log(dM / dwEmpty);
+    }
+    return dEstimate;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetTopTags
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   DWORD GetTopTags(PSKETCHWINDOW pWindow, PTOPTAG pTags,
+--                               DWORD dwCount)
+--                          pWindow - a window
+--                          pTags   - receives the most read tags, most first
+--                          dwCount - the size of pTags
+--
+-- RETURNS:     The number of tags copied to pTags.
+------------------------------------------------------------------------------*/
+DWORD GetTopTags(PSKETCHWINDOW pWindow, PTOPTAG pTags, DWORD dwCount) {
+    TOPTAG  tags[SKETCH_TOP]    = {0};
+
+    memcpy(tags, pWindow->topTags, pWindow->dwTopCount * sizeof(TOPTAG));
+    qsort(tags, pWindow->dwTopCount, sizeof(TOPTAG), CompareTopTags);
+    dwCount = min(dwCount, pWindow->dwTopCount);
+    memcpy(pTags, tags, dwCount * sizeof(TOPTAG));
+    return dwCount;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ShowSketch
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID ShowSketch(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Shows the distinct tags in the current and previous windows,
+--              and the SKETCH_SHOWN most read tags in the current one.
+------------------------------------------------------------------------------*/
+VOID ShowSketch(HWND hWnd) {
+    PWNDDATA        pwd                     = NULL;
+    PSKETCH         pSketch                 = NULL;
+    SKETCHWINDOW    current                 = {0};
+    SKETCHWINDOW    previous                = {0};
+    TOPTAG          tags[SKETCH_SHOWN]      = {0};
+    TCHAR           szText[1024]            = {0};
+    DWORD           dwLength                = 0;
+    DWORD           dwTags                  = 0;
+    DWORD           i                       = 0;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pSketch = &pwd->sketch;
+
+    EnterCriticalSection(&pSketch->cs);
+    current  = pSketch->current;
+    previous = pSketch->previous;
+    LeaveCriticalSection(&pSketch->cs);
+
+    dwLength = wsprintf(szText, TEXT("This window: about %u tags in %u reads\n")
+                        TEXT("Last window: about %u tags in %u reads\n\n")
+                        TEXT("Most read this window:\n"),
+                        (DWORD) (EstimateDistinct(&current) + 0.5),
+                        current.dwReads,
+                        (DWORD) (EstimateDistinct(&previous) + 0.5),
+                        previous.dwReads);
+
+    dwTags = GetTopTags(&current, tags, SKETCH_SHOWN);
+    for (i = 0; i < dwTags; i++) {
+        dwLength += wsprintf(szText + dwLength, TEXT("%08X%08X\t%u\n"),
+                             (DWORD) (tags[i].ullUid >> 32),
+                             (DWORD) tags[i].ullUid,
+                             tags[i].dwCount - tags[i].dwError);
+    }
+    MessageBox(hWnd, szText, TEXT("Tag Analytics"), MB_OK);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CloseSketch
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID CloseSketch(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Writes the unfinished window to the file, so that a restart
+--              loses nothing; merging it with the rest of the window later
+--              gives the same result. The decode workers must have stopped.
+------------------------------------------------------------------------------*/
+VOID CloseSketch(HWND hWnd) {
+    PWNDDATA    pwd     = NULL;
+    PSKETCH     pSketch = NULL;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pSketch = &pwd->sketch;
+
+    if (!pSketch->bInitialized) {
+        return;
+    }
+    if (pSketch->current.dwReads > 0) {
+        WriteSketch(pSketch, &pSketch->current);
+    }
+    DeleteCriticalSection(&pSketch->cs);
+    pSketch->bInitialized = FALSE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    AddToTopTags
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID AddToTopTags(PSKETCHWINDOW pWindow,
+--                                       ULONGLONG ullUid)
+--                          pWindow - the current window
+--                          ullUid  - the UID that was read
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Counts the UID if it has a slot. Otherwise it takes a free slot,
+--              or the one with the lowest count.
+------------------------------------------------------------------------------*/
+static VOID AddToTopTags(PSKETCHWINDOW pWindow, ULONGLONG ullUid) {
+    PTOPTAG pTag    = NULL;
+    PTOPTAG pMin    = NULL;
+    DWORD   i       = 0;
+
+    for (i = 0; i < pWindow->dwTopCount; i++) {
+        pTag = &pWindow->topTags[i];
+        if (pTag->ullUid == ullUid) {
+            pTag->dwCount++;
+            return;
+        }
+        if (pMin == NULL  ||  pTag->dwCount < pMin->dwCount) {
+            pMin = pTag;
+        }
+    }
+    if (pWindow->dwTopCount < SKETCH_TOP) {
+        pTag = &pWindow->topTags[pWindow->dwTopCount++];
+        pTag->ullUid    = ullUid;
+        pTag->dwCount   = 1;
+        pTag->dwError   = 0;
+        return;
+    }
+    pMin->ullUid    = ullUid;
+    pMin->dwError   = pMin->dwCount;
+    pMin->dwCount++;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    WriteSketch
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID WriteSketch(PSKETCH pSketch, PSKETCHWINDOW pWindow)
+--                          pSketch - the reader's sketches
+--                          pWindow - the window to save
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Appends the window to the sketch file, if there is one. The
+--              file is only open while it is being written, so other programs
+--              can collect it at any time.
+------------------------------------------------------------------------------*/
+static VOID WriteSketch(PSKETCH pSketch, PSKETCHWINDOW pWindow) {
+    HANDLE  hFile       = INVALID_HANDLE_VALUE;
+    DWORD   dwWritten   = 0;
+
+    if (pSketch->szFile[0] == '\0') {
+        return;
+    }
+    hFile = CreateFile(pSketch->szFile, FILE_APPEND_DATA, FILE_SHARE_READ,
+                       NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    WriteFile(hFile, pWindow, sizeof(SKETCHWINDOW), &dwWritten, NULL);
+    CloseHandle(hFile);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CompareTopTags
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static INT CompareTopTags(const VOID* pA, const VOID* pB)
+--                          pA  - a top tag
+--                          pB  - another top tag
+--
+-- RETURNS:     Less than 0 if pA was read more than pB, for qsort().
+------------------------------------------------------------------------------*/
+static INT CompareTopTags(const VOID* pA, const VOID* pB) {
+    DWORD dwA = ((const TOPTAG*) pA)->dwCount;
+    DWORD dwB = ((const TOPTAG*) pB)->dwCount;
+
+    return (dwA < dwB) - (dwA > dwB);
+}
@@ -0,0 +1,51 @@
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#include <Windows.h>
+#include "Tag.h"
+
+#define SKETCH_MAGIC        0x4B544B53  // "SKTK"
+#define SKETCH_BITS         12      // the hash bits that pick a register
+#define SKETCH_REGISTERS    (1 << SKETCH_BITS)  // about 1.6% error
+#define SKETCH_TOP          64      // tags counted by the top-K sketch
+#define SKETCH_WINDOW       3600    // default seconds in a window
+#define SKETCH_ANY_READER   0xFFFFFFFF  // the reader of a merged window
+#define SKETCH_SHOWN        10      // top tags shown in the dialogue
+
+typedef struct topTag {
+    ULONGLONG   ullUid;
+    DWORD       dwCount;        // an overestimate, by at most dwError
+    DWORD       dwError;
+} TOPTAG, *PTOPTAG;
+
+// One window of one reader (or several, merged). This is also the record
+// written to the sketch file, so its layout is fixed.
+typedef struct sketchWindow {
+    DWORD       dwMagic;
+    DWORD       dwReader;
+    ULONGLONG   ullWindow;      // the window's number since 1601, in
+    DWORD       dwSeconds;      // windows of dwSeconds
+    DWORD       dwReads;
+    BYTE        pbRegisters[SKETCH_REGISTERS];
+    TOPTAG      topTags[SKETCH_TOP];
+    DWORD       dwTopCount;
+    DWORD       dwReserved;
+} SKETCHWINDOW, *PSKETCHWINDOW;
+
+typedef struct sketch {
+    CRITICAL_SECTION    cs;
+    BOOL                bInitialized;
+    TCHAR               szFile[MAX_PATH];
+    SKETCHWINDOW        current;
+    SKETCHWINDOW        previous;
+} SKETCH, *PSKETCH;
+
+VOID    InitSketch(HWND hWnd);
+VOID    UpdateSketch(PSKETCH pSketch, PTAGREAD pRead);
+VOID    MergeSketch(PSKETCHWINDOW pInto, PSKETCHWINDOW pFrom);
+DOUBLE  EstimateDistinct(PSKETCHWINDOW pWindow);
+DWORD   GetTopTags(PSKETCHWINDOW pWindow, PTOPTAG pTags, DWORD dwCount);
+VOID    ShowSketch(HWND hWnd);
+VOID    CloseSketch(HWND hWnd);
+
+#endif
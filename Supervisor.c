@@ -0,0 +1,436 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Supervisor.c - Contains the functions that reconnect to the
+--                                 RFID reader when its port is lost.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    InitSupervisor(HWND);
+--              VOID    OnPortLost(HWND);
+--              VOID    OnReconnectTimer(HWND);
+--              VOID    OnReconnectResult(HWND, WPARAM, LPARAM);
+--              VOID    OnDeviceChange(HWND, WPARAM, LPARAM);
+--              BOOL    CancelReconnect(HWND);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Each attempt opens the port on a thread of its own, so probing
+--              the reader's baud rates doesn't freeze the window.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- When a USB-serial adapter is unplugged (or its driver resets), the read
+-- thread exits and posts WM_PORTLOST. Windows also sends WM_DEVICECHANGE to
+-- every top-level window when a COM port is added or removed. Either one
+-- closes the port, and then a timer retries OpenPort() with an exponential
+-- backoff. The delay is jittered so that many readers on one host don't all
+-- retry at the same moment. When the port comes back, the retry happens at
+-- once instead of waiting for the timer.
+--
+-- The supervisor itself runs on the window's thread, so it never races with
+-- the menu choices. Only an attempt runs on a thread of its own, since
+-- OpenPort() may probe the reader at every baud rate (up to ProbeTimeout ms
+-- each). The attempt posts WM_RECONNECTED when it is done, and until then the
+-- window's thread leaves the port alone; disconnecting waits for it to finish.
+-- The tags already on the display are kept across a reconnect.
+--
+-- The [Reconnect] section of the configuration file controls the backoff:
+--
+--      [Reconnect]
+--      Enabled=1
+--      MinDelay=250
+--      MaxDelay=30000
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+static DWORD WINAPI ReconnectThreadProc(LPVOID lpParam);
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitSupervisor
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitSupervisor(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Reads the reconnect settings from the configuration file.
+------------------------------------------------------------------------------*/
+VOID InitSupervisor(HWND hWnd) {
+    PWNDDATA    pwd     = NULL;
+    PSUPERVISOR pSup    = NULL;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pSup    = &pwd->supervisor;
+
+    pSup->bEnabled      = ReadConfigInt(hWnd, TEXT("Reconnect"),
+                                        TEXT("Enabled"), TRUE);
+    pSup->dwMinDelay    = ReadConfigInt(hWnd, TEXT("Reconnect"),
+                                        TEXT("MinDelay"), RECONNECT_MIN_DELAY);
+    pSup->dwMaxDelay    = ReadConfigInt(hWnd, TEXT("Reconnect"),
+                                        TEXT("MaxDelay"), RECONNECT_MAX_DELAY);
+
+    if (pSup->dwMinDelay == 0) {
+        pSup->dwMinDelay = 1;
+    }
+    if (pSup->dwMaxDelay < pSup->dwMinDelay) {
+        pSup->dwMaxDelay = pSup->dwMinDelay;
+    }
+    srand(GetTickCount());
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ShowStatus
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID ShowStatus(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Shows the reconnect status in the title bar.
+------------------------------------------------------------------------------*/
+static VOID ShowStatus(HWND hWnd) {
+    PWNDDATA    pwd         = NULL;
+    TCHAR       szTitle[128]= {0};
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    if (pwd->supervisor.bPending) {
+        wsprintf(szTitle, TEXT("%s - Reconnecting to %s (attempt %lu)"),
+                 APP_TITLE, pwd->lpszCommName, pwd->supervisor.dwAttempt + 1);
+        SetWindowText(hWnd, szTitle);
+    } else {
+        SetWindowText(hWnd, APP_TITLE);
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ScheduleReconnect
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID ScheduleReconnect(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Starts the timer for the next attempt. The delay doubles with
+--              each failed attempt, up to the maximum, and the actual wait is
+--              picked at random from the upper half of that delay.
+------------------------------------------------------------------------------*/
+static VOID ScheduleReconnect(HWND hWnd) {
+    PWNDDATA    pwd     = NULL;
+    PSUPERVISOR pSup    = NULL;
+    DWORD       dwDelay = 0;
+    DWORD       i       = 0;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pSup    = &pwd->supervisor;
+
+    dwDelay = pSup->dwMinDelay;
+    for (i = 0; i < pSup->dwAttempt  &&  dwDelay < pSup->dwMaxDelay; i++) {
+        dwDelay *= 2;
+    }
+    if (dwDelay > pSup->dwMaxDelay) {
+        dwDelay = pSup->dwMaxDelay;
+    }
+    dwDelay = dwDelay / 2 + rand() % (dwDelay / 2 + 1);
+
+    SetTimer(hWnd, IDT_RECONNECT, dwDelay, NULL);
+    ShowStatus(hWnd);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    OnPortLost
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID OnPortLost(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Called when the read thread reports that the port has stopped
+--              working, or when Windows reports that the port was removed.
+--              Closes the port and starts trying to reconnect. If reconnecting
+--              is disabled, the program disconnects instead. A port lost while
+--              an attempt is still running is left to OnReconnectResult().
+------------------------------------------------------------------------------*/
+VOID OnPortLost(HWND hWnd) {
+    PWNDDATA    pwd     = NULL;
+    PSUPERVISOR pSup    = NULL;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pSup    = &pwd->supervisor;
+
+    if (pSup->hWorker != NULL) {
+        // the attempt's read thread may already have given up
+        pSup->bLostAgain = TRUE;
+        return;
+    }
+    // the user may have disconnected before this message arrived
+    if (pwd->hPort == NULL  ||  pSup->bPending) {
+        return;
+    }
+    pSup->dwPortLost++;
+
+    if (!pSup->bEnabled) {
+        Disconnect(hWnd);
+        DISPLAY_ERROR("The connection to the RFID reader was lost");
+        return;
+    }
+    ClosePort(hWnd);
+
+    pSup->bPending      = TRUE;
+    pSup->dwAttempt     = 0;
+    pSup->dwLostTick    = GetTickCount();
+    ScheduleReconnect(hWnd);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    OnReconnectTimer
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Starts the attempt on a thread of its own.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID OnReconnectTimer(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Starts an attempt to open the port again, unless one is already
+--              running. The result arrives as WM_RECONNECTED (see
+--              OnReconnectResult()).
+------------------------------------------------------------------------------*/
+VOID OnReconnectTimer(HWND hWnd) {
+    PWNDDATA    pwd     = NULL;
+    PSUPERVISOR pSup    = NULL;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pSup    = &pwd->supervisor;
+
+    KillTimer(hWnd, IDT_RECONNECT);
+    if (!pSup->bPending  ||  pSup->hWorker != NULL) {
+        return;
+    }
+    pSup->dwAttempts++;
+    pSup->bLostAgain    = FALSE;
+    pSup->hWorker       = CreateThread(NULL, 0, ReconnectThreadProc, hWnd, 0,
+                                       &pSup->dwWorkerId);
+    if (pSup->hWorker == NULL) {
+        pSup->dwAttempt++;
+        ScheduleReconnect(hWnd);
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ReconnectThreadProc
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static DWORD WINAPI ReconnectThreadProc(LPVOID lpParam)
+--                          lpParam - the handle to the window
+--
+-- RETURNS:     0.
+--
+-- NOTES:
+--              Makes one attempt to open the port. OpenPort() negotiates the
+--              baud rate, re-initializes the reader and restarts the read
+--              thread. The result is posted back to the window's thread.
+------------------------------------------------------------------------------*/
+static DWORD WINAPI ReconnectThreadProc(LPVOID lpParam) {
+    HWND    hWnd    = (HWND) lpParam;
+    BOOL    bOpened = FALSE;
+
+    bOpened = OpenPort(hWnd, FALSE);
+    PostMessage(hWnd, WM_RECONNECTED, GetCurrentThreadId(), bOpened);
+    return 0;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    OnReconnectResult
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID OnReconnectResult(HWND hWnd, WPARAM wParam, 
+--                                     LPARAM lParam)
+--                          hWnd    - the handle to the window
+--                          wParam  - the id of the thread that made the attempt
+--                          lParam  - true if the port was opened
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Handles WM_RECONNECTED. If the port was opened, polling has
+--              already resumed. Otherwise, or if the port was lost again
+--              before this arrived, the next attempt is scheduled. A result
+--              from an attempt that CancelReconnect() already waited for is
+--              ignored.
+------------------------------------------------------------------------------*/
+VOID OnReconnectResult(HWND hWnd, WPARAM wParam, LPARAM lParam) {
+    PWNDDATA    pwd     = NULL;
+    PSUPERVISOR pSup    = NULL;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pSup    = &pwd->supervisor;
+
+    if (pSup->hWorker == NULL  ||  pSup->dwWorkerId != (DWORD) wParam) {
+        return;
+    }
+    WaitForSingleObject(pSup->hWorker, INFINITE);
+    CloseHandle(pSup->hWorker);
+    pSup->hWorker = NULL;
+
+    if (lParam  &&  pSup->bLostAgain) {
+        ClosePort(hWnd);
+        pSup->dwPortLost++;
+    } else if (lParam) {
+        pSup->bPending      = FALSE;
+        pSup->dwReconnects++;
+        pSup->dwDowntime   += GetTickCount() - pSup->dwLostTick;
+        ShowStatus(hWnd);
+        return;
+    }
+    pSup->dwAttempt++;
+    ScheduleReconnect(hWnd);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    OnDeviceChange
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID OnDeviceChange(HWND hWnd, WPARAM wParam, LPARAM lParam)
+--                          hWnd    - the handle to the window
+--                          wParam  - the device event
+--                          lParam  - the DEV_BROADCAST_HDR for the event
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Handles WM_DEVICECHANGE for our COM port. Removal is treated as
+--              a lost port, and arrival triggers an immediate reconnect.
+------------------------------------------------------------------------------*/
+VOID OnDeviceChange(HWND hWnd, WPARAM wParam, LPARAM lParam) {
+    PWNDDATA            pwd     = NULL;
+    PDEV_BROADCAST_HDR  pHdr    = (PDEV_BROADCAST_HDR) lParam;
+    PDEV_BROADCAST_PORT pPort   = (PDEV_BROADCAST_PORT) lParam;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    if (pHdr == NULL  ||  pHdr->dbch_devicetype != DBT_DEVTYP_PORT  ||
+            lstrcmpi(pPort->dbcp_name, pwd->lpszCommName) != 0) {
+        return;
+    }
+
+    switch (wParam) {
+
+        case DBT_DEVICEARRIVAL:
+            if (pwd->supervisor.bPending) {
+                OnReconnectTimer(hWnd);
+            }
+            return;
+
+        case DBT_DEVICEREMOVECOMPLETE:
+            OnPortLost(hWnd);
+            return;
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CancelReconnect
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Waits for an attempt that is still running.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL CancelReconnect(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     True if a reconnect was waiting to happen.
+--
+-- NOTES:
+--              Stops trying to reconnect. Called when the user disconnects.
+--              If an attempt is running, this waits for it, and leaves any
+--              port it opened for the caller to close.
+------------------------------------------------------------------------------*/
+BOOL CancelReconnect(HWND hWnd) {
+    PWNDDATA    pwd     = NULL;
+    PSUPERVISOR pSup    = NULL;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pSup    = &pwd->supervisor;
+
+    if (!pSup->bPending) {
+        return FALSE;
+    }
+    KillTimer(hWnd, IDT_RECONNECT);
+    if (pSup->hWorker != NULL) {
+        WaitForSingleObject(pSup->hWorker, INFINITE);
+        CloseHandle(pSup->hWorker);
+        pSup->hWorker = NULL;
+    }
+    pSup->bPending      = FALSE;
+    pSup->dwDowntime   += GetTickCount() - pSup->dwLostTick;
+    ShowStatus(hWnd);
+    return TRUE;
+}
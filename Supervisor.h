@@ -0,0 +1,36 @@
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <Windows.h>
+
+#define WM_PORTLOST             (WM_APP + 1)    // posted by the read thread
+#define WM_RECONNECTED          (WM_APP + 2)    // posted after a reconnect
+#define IDT_RECONNECT           1
+
+#define RECONNECT_MIN_DELAY     250     // ms before the first attempt
+#define RECONNECT_MAX_DELAY     30000   // ms between attempts, at most
+
+typedef struct supervisor {
+    BOOL    bEnabled;
+    BOOL    bPending;
+    DWORD   dwMinDelay;
+    DWORD   dwMaxDelay;
+    DWORD   dwAttempt;
+    HANDLE  hWorker;
+    DWORD   dwWorkerId;
+    BOOL    bLostAgain;
+    DWORD   dwLostTick;
+    DWORD   dwPortLost;
+    DWORD   dwAttempts;
+    DWORD   dwReconnects;
+    DWORD   dwDowntime;
+} SUPERVISOR, *PSUPERVISOR;
+
+VOID    InitSupervisor(HWND hWnd);
+VOID    OnPortLost(HWND hWnd);
+VOID    OnReconnectTimer(HWND hWnd);
+VOID    OnReconnectResult(HWND hWnd, WPARAM wParam, LPARAM lParam);
+VOID    OnDeviceChange(HWND hWnd, WPARAM wParam, LPARAM lParam);
+BOOL    CancelReconnect(HWND hWnd);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef TAG_H
+#define TAG_H
+
+#include <Windows.h>
+
+#define MAX_UID_LENGTH      8       // bytes in the longest tag id
+
+#define TAG_UNSUPPORTED     0x00    // tag types, as reported by the reader
+#define TAG_ISO15693        0x04
+#define TAG_TAGIT           0x05
+#define TAG_LF              0x06
+
+#define TAG_OPCODE          5       // offsets in a reader response
+#define TAG_TYPE            7
+#define TAG_RECORD_COUNT    7       // offsets in a multi-tag response
+#define TAG_RECORDS         8
+#define TAG_RECORD_HEADER   2       // a record's type and UID length
+
+#define MATCH_NONE          0       // the tag against the UID lists
+#define MATCH_ALLOWED       1
+#define MATCH_DENIED        2
+
+typedef struct tagRead {
+    BYTE        bType;
+    BYTE        pbUid[MAX_UID_LENGTH];
+    DWORD       dwUidLength;
+    DWORD       dwReader;
+    BYTE        bMatch;
+    BYTE        bArrived;       // not in the field before this read
+    LONGLONG    llRead;         // QueryPerformanceCounter() when the first
+    LONGLONG    llFramed;       // byte was read, the frame was complete, the
+    LONGLONG    llDecoded;      // tag was decoded, and it was put on the
+    LONGLONG    llDisplayed;    // display
+} TAGREAD, *PTAGREAD;
+
+#endif
@@ -0,0 +1,486 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Trace.c - Contains the functions that time each tag read on
+--                            its way from the port to the display.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID        InitTrace(HWND);
+--              LONGLONG    TraceNow(VOID);
+--              VOID        RecordTagRead(PTRACE, PTAGREAD);
+--              VOID        RecordBlockLatency(PTRACE, LONGLONG, LONGLONG,
+--                                             DWORD);
+--              DWORD       FormatTraceSummary(PTRACE, LPTSTR);
+--              VOID        CloseTrace(PTRACE);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Added the histogram of block request latencies.
+--              Oct 19, 2026
+--              Added FormatTraceSummary(), so the histograms are shown with the
+--              read rates whether or not there is a trace file.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- Every tag read carries four QueryPerformanceCounter() timestamps (see
+-- TAGREAD): when the read that brought in the first byte of its frame
+-- completed, when the frame was complete, when the tag was decoded, and when
+-- it was put in the display buffer. Once a tag is on the display, the time
+-- spent in each stage is added to a histogram with power-of-two buckets, in
+-- microseconds. The block engine (see Blocks.c) adds the time each block
+-- took, from sending its request to the reply being framed, to a histogram
+-- of its own.
+--
+-- If a file is named in the [Trace] section of the configuration file, each
+-- stage is also written to it as a Chrome trace event, which can be opened in
+-- chrome://tracing or Perfetto. A relative name is taken to be next to the
+-- executable. The histograms are added to the end of the file when the
+-- program exits. Either way, their percentiles are shown with the read rates
+-- (see FormatTraceSummary()).
+--
+--      [Trace]
+--      File=latency.json
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+static VOID FlushTrace(PTRACE pTrace);
+static DWORD GetPercentileUs(PTRACE pTrace, DWORD dwStage, DWORD dwCount,
+                             DWORD dwPercent);
+static VOID AddToHistogram(PTRACE pTrace, DWORD dwStage, LONGLONG llStart,
+                           LONGLONG llEnd, DWORD dwCount);
+static VOID WriteTraceEvent(PTRACE pTrace, PTAGREAD pRead, LPCSTR lpszName,
+                            LONGLONG llStart, LONGLONG llEnd);
+
+static LPCSTR lpszStageNames[TRACE_STAGES] = {
+    "frame", "decode", "display", "total", "block"
+};
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitTrace
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Resolves the file name with ReadConfigPath().
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitTrace(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Clears the histograms and opens the trace file, if one is set
+--              in the configuration file. Must be called after InitConfig().
+------------------------------------------------------------------------------*/
+VOID InitTrace(HWND hWnd) {
+    PWNDDATA        pwd                 = NULL;
+    PTRACE          pTrace              = NULL;
+    LARGE_INTEGER   li                  = {0};
+    TCHAR           szFile[MAX_PATH]    = {0};
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pTrace  = &pwd->trace;
+
+    ZeroMemory(pTrace, sizeof(TRACE));
+    QueryPerformanceFrequency(&li);
+    pTrace->llFrequency = li.QuadPart;
+    pTrace->llEpoch     = TraceNow();
+    pTrace->hFile       = INVALID_HANDLE_VALUE;
+
+    if (ReadConfigPath(hWnd, TEXT("Trace"), TEXT("File"), szFile) == 0) {
+        return;
+    }
+
+    pTrace->hFile = CreateFile(szFile, GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                               CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (pTrace->hFile == INVALID_HANDLE_VALUE) {
+        DISPLAY_ERROR("Could not create the trace file");
+        return;
+    }
+    pTrace->dwBufUsed = sprintf(pTrace->pcBuf, "{\"traceEvents\":[\n");
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    TraceNow
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   LONGLONG TraceNow(VOID)
+--
+-- RETURNS:     The current value of the performance counter.
+------------------------------------------------------------------------------*/
+LONGLONG TraceNow(VOID) {
+    LARGE_INTEGER li = {0};
+
+    QueryPerformanceCounter(&li);
+    return li.QuadPart;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    RecordTagRead
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              The histograms are updated by AddToHistogram().
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID RecordTagRead(PTRACE pTrace, PTAGREAD pRead)
+--                          pTrace  - the reader's latency histograms
+--                          pRead   - a tag read that has been displayed
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Adds the time spent in each stage to its histogram, and writes
+--              the stages to the trace file. Called from the read thread.
+------------------------------------------------------------------------------*/
+VOID RecordTagRead(PTRACE pTrace, PTAGREAD pRead) {
+    LONGLONG    llStart[TRACE_STAGES]   = {0};
+    LONGLONG    llEnd[TRACE_STAGES]     = {0};
+    DWORD       i                       = 0;
+
+    if (pTrace->llFrequency == 0) {
+        return;
+    }
+    llStart[STAGE_FRAME]    = pRead->llRead;
+    llEnd[STAGE_FRAME]      = pRead->llFramed;
+    llStart[STAGE_DECODE]   = pRead->llFramed;
+    llEnd[STAGE_DECODE]     = pRead->llDecoded;
+    llStart[STAGE_DISPLAY]  = pRead->llDecoded;
+    llEnd[STAGE_DISPLAY]    = pRead->llDisplayed;
+    llStart[STAGE_TOTAL]    = pRead->llRead;
+    llEnd[STAGE_TOTAL]      = pRead->llDisplayed;
+
+    for (i = 0; i <= STAGE_TOTAL; i++) {
+        AddToHistogram(pTrace, i, llStart[i], llEnd[i], 1);
+    }
+    pTrace->dwTags++;
+
+    if (pTrace->hFile == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    // the total is already covered by the other three
+    for (i = 0; i < STAGE_TOTAL; i++) {
+        WriteTraceEvent(pTrace, pRead, lpszStageNames[i], llStart[i], llEnd[i]);
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    RecordBlockLatency
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID RecordBlockLatency(PTRACE pTrace, LONGLONG llSent,
+--                                      LONGLONG llDone, DWORD dwBlocks)
+--                          pTrace      - the reader's latency histograms
+--                          llSent      - when the block request was queued
+--                          llDone      - when its reply was framed
+--                          dwBlocks    - the number of blocks it carried
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Adds the request's latency to the block histogram once for
+--              each of its blocks. Called from the reader's strand.
+------------------------------------------------------------------------------*/
+VOID RecordBlockLatency(PTRACE pTrace, LONGLONG llSent, LONGLONG llDone,
+                        DWORD dwBlocks) {
+
+    if (pTrace->llFrequency == 0) {
+        return;
+    }
+    AddToHistogram(pTrace, STAGE_BLOCK, llSent, llDone, dwBlocks);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    AddToHistogram
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID AddToHistogram(PTRACE pTrace, DWORD dwStage,
+--                                         LONGLONG llStart, LONGLONG llEnd,
+--                                         DWORD dwCount)
+--                          pTrace  - the reader's latency histograms
+--                          dwStage - the histogram to add to
+--                          llStart - when the stage started
+--                          llEnd   - when the stage ended
+--                          dwCount - the number of times to count it
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Counts the stage's latency in its power-of-two bucket, and
+--              keeps track of the longest.
+------------------------------------------------------------------------------*/
+static VOID AddToHistogram(PTRACE pTrace, DWORD dwStage, LONGLONG llStart,
+                           LONGLONG llEnd, DWORD dwCount) {
+    LONGLONG    llUs        = 0;
+    DWORD       dwBucket    = 0;
+
+    llUs = (llEnd - llStart) * 1000000 / pTrace->llFrequency;
+    while (dwBucket < TRACE_BUCKETS - 1  &&  (llUs >> dwBucket) > 0) {
+        dwBucket++;
+    }
+    pTrace->dwHist[dwStage][dwBucket] += dwCount;
+    if (llUs > pTrace->llMaxUs[dwStage]) {
+        pTrace->llMaxUs[dwStage] = llUs;
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    WriteTraceEvent
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID WriteTraceEvent(PTRACE pTrace, PTAGREAD pRead,
+--                                          LPCSTR lpszName, LONGLONG llStart,
+--                                          LONGLONG llEnd)
+--                          pTrace      - the reader's trace
+--                          pRead       - the tag read the event belongs to
+--                          lpszName    - the name of the stage
+--                          llStart     - when the stage started
+--                          llEnd       - when the stage ended
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Adds a complete ("X") event to the trace buffer. Each reader is
+--              shown as its own thread in the trace viewer.
+------------------------------------------------------------------------------*/
+static VOID WriteTraceEvent(PTRACE pTrace, PTAGREAD pRead, LPCSTR lpszName,
+                            LONGLONG llStart, LONGLONG llEnd) {
+    CHAR    pcUid[MAX_UID_LENGTH * 2 + 1]   = {0};
+    CHAR*   pcEvent                         = NULL;
+    DWORD   i                               = 0;
+
+    if (TRACE_BUFSIZE - pTrace->dwBufUsed < TRACE_EVENT_SIZE) {
+        FlushTrace(pTrace);
+    }
+    for (i = 0; i < pRead->dwUidLength; i++) {
+        sprintf(pcUid + 2 * i, "%02X", pRead->pbUid[i]);
+    }
+    pcEvent = pTrace->pcBuf + pTrace->dwBufUsed;
+    
+    pTrace->dwBufUsed += sprintf(pcEvent, 
+        "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,"
+        "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"type\":%u,\"uid\":\"%s\"}}\n",
+        (pTrace->dwEvents > 0) ? "," : "", lpszName, pRead->dwReader,
+        (llStart - pTrace->llEpoch) * 1e6 / pTrace->llFrequency,
+        (llEnd - llStart) * 1e6 / pTrace->llFrequency,
+        pRead->bType, pcUid);
+    pTrace->dwEvents++;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FlushTrace
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID FlushTrace(PTRACE pTrace)
+--                          pTrace - the reader's trace
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Writes the buffered events to the trace file. If the write 
+--              fails, tracing stops, but the histograms carry on.
+------------------------------------------------------------------------------*/
+static VOID FlushTrace(PTRACE pTrace) {
+    DWORD dwWritten = 0;
+
+    if (pTrace->dwBufUsed > 0  &&  
+            !WriteFile(pTrace->hFile, pTrace->pcBuf, pTrace->dwBufUsed, 
+                       &dwWritten, NULL)) {
+        CloseHandle(pTrace->hFile);
+        pTrace->hFile = INVALID_HANDLE_VALUE;
+    }
+    pTrace->dwBufUsed = 0;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetPercentileUs
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static DWORD GetPercentileUs(PTRACE pTrace, DWORD dwStage,
+--                                           DWORD dwCount, DWORD dwPercent)
+--                          pTrace      - the reader's latency histograms
+--                          dwStage     - the histogram to look at
+--                          dwCount     - the number of latencies it holds
+--                          dwPercent   - the percentile to find
+--
+-- RETURNS:     The upper bound of the bucket that holds the percentile, in
+--              microseconds. It is never more than the longest latency.
+------------------------------------------------------------------------------*/
+static DWORD GetPercentileUs(PTRACE pTrace, DWORD dwStage, DWORD dwCount,
+                             DWORD dwPercent) {
+    LONGLONG    llNeeded    = 0;
+    LONGLONG    llSeen      = 0;
+    LONGLONG    llMaxUs     = 0;
+    DWORD       i           = 0;
+
+    llMaxUs  = min(pTrace->llMaxUs[dwStage], MAXDWORD);
+    llNeeded = ((LONGLONG) dwCount * dwPercent + 99) / 100;
+    for (i = 0; i < TRACE_BUCKETS - 1; i++) {
+        llSeen += pTrace->dwHist[dwStage][i];
+        if (llSeen >= llNeeded) {
+            return (DWORD) min((LONGLONG) 1 << i, llMaxUs);
+        }
+    }
+    return (DWORD) llMaxUs;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FormatTraceSummary
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   DWORD FormatTraceSummary(PTRACE pTrace, LPTSTR lpszOut)
+--                          pTrace  - the reader's latency histograms
+--                          lpszOut - receives a line for each stage, and must
+--                                    hold TRACE_STAGES * TRACE_SUMMARY_SIZE
+--                                    characters
+--
+-- RETURNS:     The number of characters written, not counting the null.
+--
+-- NOTES:
+--              Writes the median, the 99th percentile and the longest latency
+--              of every stage that has been timed. A percentile is only known
+--              to within its power-of-two bucket, so it is given as the most it
+--              could be: the bucket's upper bound, or the longest latency if
+--              that is less. The strand may be counting while this reads, so a
+--              stage can be off by the tags counted meanwhile.
+------------------------------------------------------------------------------*/
+DWORD FormatTraceSummary(PTRACE pTrace, LPTSTR lpszOut) {
+    DWORD   dwLength    = 0;
+    DWORD   dwCount     = 0;
+    DWORD   i           = 0;
+    DWORD   j           = 0;
+
+    lpszOut[0] = '\0';
+    for (i = 0; i < TRACE_STAGES; i++) {
+        dwCount = 0;
+        for (j = 0; j < TRACE_BUCKETS; j++) {
+            dwCount += pTrace->dwHist[i][j];
+        }
+        if (dwCount == 0) {
+            continue;
+        }
+        dwLength += wsprintf(lpszOut + dwLength, 
+                             TEXT("%hs latency: 50%% within %u us, ")
+                             TEXT("99%% within %u us, max %u us\n"),
+                             lpszStageNames[i],
+                             GetPercentileUs(pTrace, i, dwCount, 50),
+                             GetPercentileUs(pTrace, i, dwCount, 99),
+                             (DWORD) min(pTrace->llMaxUs[i], MAXDWORD));
+    }
+    return dwLength;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CloseTrace
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID CloseTrace(PTRACE pTrace)
+--                          pTrace - the reader's trace
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Finishes the trace file with the histograms, and closes it. The
+--              read thread must have stopped. Each histogram is an array of
+--              counts, where bucket i holds latencies under 2^i microseconds.
+------------------------------------------------------------------------------*/
+VOID CloseTrace(PTRACE pTrace) {
+    CHAR*   pcOut   = NULL;
+    DWORD   i       = 0;
+    DWORD   j       = 0;
+
+    if (pTrace->hFile == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    FlushTrace(pTrace);
+    pcOut = pTrace->pcBuf;
+    pcOut += sprintf(pcOut, "],\n\"tags\":%lu,\n\"histograms\":{\n", 
+                     pTrace->dwTags);
+
+    for (i = 0; i < TRACE_STAGES; i++) {
+        pcOut += sprintf(pcOut, "\"%s\":{\"maxUs\":%I64d,\"buckets\":[",
+                         lpszStageNames[i], pTrace->llMaxUs[i]);
+        for (j = 0; j < TRACE_BUCKETS; j++) {
+            pcOut += sprintf(pcOut, "%s%lu", (j > 0) ? "," : "", 
+                             pTrace->dwHist[i][j]);
+        }
+        pcOut += sprintf(pcOut, "]}%s\n", (i < TRACE_STAGES - 1) ? "," : "");
+    }
+    pcOut += sprintf(pcOut, "}}\n");
+    pTrace->dwBufUsed = (DWORD) (pcOut - pTrace->pcBuf);
+    
+    FlushTrace(pTrace);
+    if (pTrace->hFile != INVALID_HANDLE_VALUE) {
+        CloseHandle(pTrace->hFile);
+        pTrace->hFile = INVALID_HANDLE_VALUE;
+    }
+}
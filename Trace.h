@@ -0,0 +1,39 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Windows.h>
+#include "Tag.h"
+
+#define STAGE_FRAME         0       // first byte read -> frame complete
+#define STAGE_DECODE        1       // frame complete -> tag decoded
+#define STAGE_DISPLAY       2       // tag decoded -> on the display
+#define STAGE_TOTAL         3       // first byte read -> on the display
+#define STAGE_BLOCK         4       // block request sent -> its reply framed
+#define TRACE_STAGES        5
+
+#define TRACE_BUCKETS       32      // bucket i counts latencies < 2^i us
+#define TRACE_BUFSIZE       8192    // bytes of trace events written at once
+#define TRACE_EVENT_SIZE    256     // room needed for one event
+#define TRACE_SUMMARY_SIZE  80      // characters per stage in a summary
+
+typedef struct trace {
+    LONGLONG    llFrequency;
+    LONGLONG    llEpoch;
+    DWORD       dwHist[TRACE_STAGES][TRACE_BUCKETS];
+    LONGLONG    llMaxUs[TRACE_STAGES];
+    DWORD       dwTags;
+    HANDLE      hFile;
+    CHAR        pcBuf[TRACE_BUFSIZE];
+    DWORD       dwBufUsed;
+    DWORD       dwEvents;
+} TRACE, *PTRACE;
+
+VOID        InitTrace(HWND hWnd);
+LONGLONG    TraceNow(VOID);
+VOID        RecordTagRead(PTRACE pTrace, PTAGREAD pRead);
+VOID        RecordBlockLatency(PTRACE pTrace, LONGLONG llSent, 
+                               LONGLONG llDone, DWORD dwBlocks);
+DWORD       FormatTraceSummary(PTRACE pTrace, LPTSTR lpszOut);
+VOID        CloseTrace(PTRACE pTrace);
+
+#endif
@@ -0,0 +1,552 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     Transport.c - Contains the I/O completion port that all of
+--                                a reader's port I/O goes through.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    InitTransport(PTRANSPORT);
+--              BOOL    OpenTransport(PTRANSPORT, HANDLE);
+--              VOID    CloseTransport(PTRANSPORT);
+--              VOID    WakeTransport(PTRANSPORT);
+--              BOOL    PostTransportRead(PTRANSPORT, HANDLE, DWORD, DWORD);
+--              BOOL    QueueCommand(PTRANSPORT, PCOMMAND);
+--              VOID    PostPollResult(PTRANSPORT, DWORD);
+--              BOOL    FlushWriteQueue(PTRANSPORT, HANDLE);
+--              VOID    CompleteWrite(PTRANSPORT, DWORD);
+--              DWORD   GetWriteTimeout(PTRANSPORT);
+--              VOID    CheckWriteTimeout(PTRANSPORT, HANDLE);
+--              INT     GetReadSlot(PTRANSPORT, LPOVERLAPPED);
+--              VOID    DrainTransport(PTRANSPORT, HANDLE);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Added the write queue.
+--              Oct 19, 2026
+--              Added PostPollResult(), so the poll scheduler only runs on the
+--              read thread.
+--              Oct 19, 2026
+--              The queue's critical section lasts as long as the window, and
+--              guards the completion port handle as well.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- The read thread used to call SetCommMask(), WaitCommEvent(),
+-- ClearCommError() and ReadFile() every time a character arrived. Instead,
+-- the port is now associated with an I/O completion port and TRANSPORT_READS
+-- reads are always posted on it, each with its own buffer. With the port's
+-- ReadIntervalTimeout, a read completes once a burst of characters has
+-- arrived, and the next read is already waiting when it does. The inventory
+-- requests are written through the same completion port, so the read thread
+-- sleeps in a single GetQueuedCompletionStatus() call for reads, writes, the
+-- poll timer and disconnects alike.
+--
+-- The OVERLAPPED structures and buffers live in the window extra rather than
+-- on a stack, since the driver owns them until their I/O completes.
+--
+-- Commands are never written directly. QueueCommand() copies them onto a
+-- small ring, and the read thread writes everything waiting on the ring as one
+-- WriteFile() whenever the previous write has completed. A write that hasn't
+-- completed within WRITE_TIMEOUT is cancelled.
+--
+-- Workers queue commands and post poll results while the UI thread may be
+-- closing the port, so the completion port handle is only checked and used
+-- while holding csQueue, which is created with the window and never deleted.
+------------------------------------------------------------------------------*/
+
+#include "Transport.h"
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitTransport
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitTransport(PTRANSPORT pT)
+--                          pT      - the reader's transport
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Creates the queue's critical section. Called once, when the
+--              window is created.
+------------------------------------------------------------------------------*/
+VOID InitTransport(PTRANSPORT pT) {
+
+    ZeroMemory(pT, sizeof(TRANSPORT));
+    InitializeCriticalSection(&pT->csQueue);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    OpenTransport
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Keeps the critical section from InitTransport(), and only
+--              resets the I/O state.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL OpenTransport(PTRANSPORT pT, HANDLE hPort)
+--                          pT      - the reader's transport
+--                          hPort   - the open serial port
+--
+-- RETURNS:     False if the completion port could not be created.
+--
+-- NOTES:
+--              Creates the completion port and associates the serial port with
+--              it. Any I/O started on hPort from now on completes on the
+--              completion port. The write queue starts out empty. The counters
+--              carry on from the previous connection.
+------------------------------------------------------------------------------*/
+BOOL OpenTransport(PTRANSPORT pT, HANDLE hPort) {
+    HANDLE hIocp = NULL;
+
+    if ((hIocp = CreateIoCompletionPort(hPort, NULL, KEY_PORT, 1)) == NULL) {
+        return FALSE;
+    }
+    EnterCriticalSection(&pT->csQueue);
+    ZeroMemory(pT->bReadPending, sizeof(pT->bReadPending));
+    pT->bWritePending   = FALSE;
+    pT->bWriteCancelled = FALSE;
+    pT->dwWriteLength   = 0;
+    pT->dwQueueHead     = 0;
+    pT->dwQueueCount    = 0;
+    pT->hIocp           = hIocp;
+    LeaveCriticalSection(&pT->csQueue);
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CloseTransport
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Clears the handle under the lock, and leaves the critical
+--              section alone.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID CloseTransport(PTRANSPORT pT)
+--                          pT      - the reader's transport
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Closes the completion port. The read thread must have stopped,
+--              and the reader's strand drained (see DrainStrand()). Anything
+--              still on the write queue is discarded by the next
+--              OpenTransport(), and QueueCommand() fails until then.
+------------------------------------------------------------------------------*/
+VOID CloseTransport(PTRANSPORT pT) {
+
+    EnterCriticalSection(&pT->csQueue);
+    if (pT->hIocp != NULL) {
+        CloseHandle(pT->hIocp);
+        pT->hIocp = NULL;
+    }
+    LeaveCriticalSection(&pT->csQueue);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    WakeTransport
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Posts while holding the queue's lock.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID WakeTransport(PTRANSPORT pT)
+--                          pT      - the reader's transport
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Queues a KEY_DISCONNECT packet, which tells the read thread to
+--              finish up.
+------------------------------------------------------------------------------*/
+VOID WakeTransport(PTRANSPORT pT) {
+
+    EnterCriticalSection(&pT->csQueue);
+    if (pT->hIocp != NULL) {
+        PostQueuedCompletionStatus(pT->hIocp, 0, KEY_DISCONNECT, NULL);
+    }
+    LeaveCriticalSection(&pT->csQueue);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    PostTransportRead
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Takes the number of bytes to read, for the low latency profile.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL PostTransportRead(PTRANSPORT pT, HANDLE hPort, 
+--                                     DWORD dwSlot, DWORD dwLength)
+--                          pT          - the reader's transport
+--                          hPort       - the open serial port
+--                          dwSlot      - which of the read buffers to use
+--                          dwLength    - the most bytes to read, up to
+--                                        TRANSPORT_BUFSIZE
+--
+-- RETURNS:     False if the read could not be started. GetLastError() has the
+--              reason.
+--
+-- NOTES:
+--              Starts a read into one of the transport's buffers. The read
+--              completes on the completion port even if it finishes at once.
+------------------------------------------------------------------------------*/
+BOOL PostTransportRead(PTRANSPORT pT, HANDLE hPort, DWORD dwSlot,
+                       DWORD dwLength) {
+
+    ZeroMemory(&pT->readOv[dwSlot], sizeof(OVERLAPPED));
+
+    if (!ReadFile(hPort, pT->psReadBuf[dwSlot], dwLength, NULL,
+                  &pT->readOv[dwSlot])  &&  
+            GetLastError() != ERROR_IO_PENDING) {
+        return FALSE;
+    }
+    pT->bReadPending[dwSlot] = TRUE;
+    pT->dwReadsPosted++;
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    QueueCommand
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              Checks the completion port and posts to it while holding the
+--              lock, so CloseTransport() can't close it underneath.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL QueueCommand(PTRANSPORT pT, PCOMMAND pCmd)
+--                          pT      - the reader's transport
+--                          pCmd    - the command to send
+--
+-- RETURNS:     False if the queue is full and the command was dropped.
+--
+-- NOTES:
+--              Copies the command onto the reader's write queue, so the caller
+--              is free to reuse pCmd straight away. May be called from any 
+--              thread; a KEY_FLUSH packet wakes the read thread, which does
+--              the actual write.
+------------------------------------------------------------------------------*/
+BOOL QueueCommand(PTRANSPORT pT, PCOMMAND pCmd) {
+    DWORD dwTail = 0;
+
+    EnterCriticalSection(&pT->csQueue);
+    if (pT->hIocp == NULL) {
+        LeaveCriticalSection(&pT->csQueue);
+        return FALSE;
+    }
+    if (pT->dwQueueCount == WRITE_QUEUE_LENGTH) {
+        pT->dwCommandsDropped++;
+        LeaveCriticalSection(&pT->csQueue);
+        return FALSE;
+    }
+    dwTail = (pT->dwQueueHead + pT->dwQueueCount) % WRITE_QUEUE_LENGTH;
+    pT->writeQueue[dwTail] = *pCmd;
+    pT->dwQueueCount++;
+    pT->dwCommandsQueued++;
+
+    PostQueuedCompletionStatus(pT->hIocp, 0, KEY_FLUSH, NULL);
+    LeaveCriticalSection(&pT->csQueue);
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    PostPollResult
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID PostPollResult(PTRANSPORT pT, DWORD dwTags)
+--                          pT      - the reader's transport
+--                          dwTags  - the number of tags in the reply
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Tells the read thread that a reply to its inventory request has
+--              been decoded. Called by the worker that decoded it. The read
+--              thread updates the poll scheduler and sets the next request's
+--              deadline, so the new interval applies to this reply rather than
+--              the next one. Only frames whose opcode is the inventory
+--              command's are posted.
+------------------------------------------------------------------------------*/
+VOID PostPollResult(PTRANSPORT pT, DWORD dwTags) {
+
+    EnterCriticalSection(&pT->csQueue);
+    if (pT->hIocp != NULL) {
+        PostQueuedCompletionStatus(pT->hIocp, dwTags, KEY_POLLED, NULL);
+    }
+    LeaveCriticalSection(&pT->csQueue);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FlushWriteQueue
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   BOOL FlushWriteQueue(PTRANSPORT pT, HANDLE hPort)
+--                          pT      - the reader's transport
+--                          hPort   - the open serial port
+--
+-- RETURNS:     False if a write could not be started. GetLastError() has the
+--              reason.
+--
+-- NOTES:
+--              If no write is in progress, copies as many queued commands as
+--              will fit into the write buffer and writes them to the port in
+--              one go. The write completes on the completion port, where the
+--              read thread hands it to CompleteWrite(). Only the read thread
+--              may call this.
+------------------------------------------------------------------------------*/
+BOOL FlushWriteQueue(PTRANSPORT pT, HANDLE hPort) {
+    PCOMMAND pCmd = NULL;
+
+    if (pT->bWritePending) {
+        return TRUE;
+    }
+    pT->dwWriteLength = 0;
+    EnterCriticalSection(&pT->csQueue);
+
+    while (pT->dwQueueCount > 0) {
+        pCmd = &pT->writeQueue[pT->dwQueueHead];
+        if (pT->dwWriteLength + pCmd->dwLength > WRITE_BUFSIZE) {
+            break;
+        }
+        CopyMemory(pT->pcWriteBuf + pT->dwWriteLength, pCmd->pcFrame,
+                   pCmd->dwLength);
+        pT->dwWriteLength += pCmd->dwLength;
+        pT->dwQueueHead = (pT->dwQueueHead + 1) % WRITE_QUEUE_LENGTH;
+        pT->dwQueueCount--;
+    }
+    LeaveCriticalSection(&pT->csQueue);
+
+    if (pT->dwWriteLength == 0) {
+        return TRUE;
+    }
+    ZeroMemory(&pT->writeOv, sizeof(OVERLAPPED));
+    pT->bWriteCancelled = FALSE;
+    pT->dwWriteStart    = GetTickCount();
+
+    if (!WriteFile(hPort, pT->pcWriteBuf, pT->dwWriteLength, NULL, 
+                   &pT->writeOv)  &&
+            GetLastError() != ERROR_IO_PENDING) {
+        return FALSE;
+    }
+    pT->bWritePending = TRUE;
+    pT->dwWritesPosted++;
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CompleteWrite
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID CompleteWrite(PTRANSPORT pT, DWORD dwBytesWritten)
+--                          pT              - the reader's transport
+--                          dwBytesWritten  - from the completion packet
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Called by the read thread when writeOv completes. A write that
+--              was cancelled, or that the driver cut short because of the 
+--              port's write timeout, is counted as timed out.
+------------------------------------------------------------------------------*/
+VOID CompleteWrite(PTRANSPORT pT, DWORD dwBytesWritten) {
+
+    if (pT->bWriteCancelled  ||  dwBytesWritten < pT->dwWriteLength) {
+        pT->dwWriteTimeouts++;
+    }
+    pT->bWritePending   = FALSE;
+    pT->bWriteCancelled = FALSE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetWriteTimeout
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   DWORD GetWriteTimeout(PTRANSPORT pT)
+--                          pT      - the reader's transport
+--
+-- RETURNS:     The ms left before the current write should be cancelled, or
+--              INFINITE if there is nothing to wait for.
+------------------------------------------------------------------------------*/
+DWORD GetWriteTimeout(PTRANSPORT pT) {
+    DWORD dwElapsed = 0;
+
+    if (!pT->bWritePending  ||  pT->bWriteCancelled) {
+        return INFINITE;
+    }
+    dwElapsed = GetTickCount() - pT->dwWriteStart;
+    return (dwElapsed >= WRITE_TIMEOUT) ? 0 : WRITE_TIMEOUT - dwElapsed;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CheckWriteTimeout
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID CheckWriteTimeout(PTRANSPORT pT, HANDLE hPort)
+--                          pT      - the reader's transport
+--                          hPort   - the open serial port
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Cancels the current write if it has run past WRITE_TIMEOUT. The
+--              cancelled write still completes on the completion port (with 
+--              ERROR_OPERATION_ABORTED), and the queue moves on after that.
+------------------------------------------------------------------------------*/
+VOID CheckWriteTimeout(PTRANSPORT pT, HANDLE hPort) {
+
+    if (GetWriteTimeout(pT) == 0) {
+        pT->bWriteCancelled = TRUE;
+        CancelIoEx(hPort, &pT->writeOv);
+    }
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetReadSlot
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   INT GetReadSlot(PTRANSPORT pT, LPOVERLAPPED pOv)
+--                          pT      - the reader's transport
+--                          pOv     - the OVERLAPPED from a completion packet
+--
+-- RETURNS:     The read buffer that pOv belongs to, or -1 if it isn't a read.
+------------------------------------------------------------------------------*/
+INT GetReadSlot(PTRANSPORT pT, LPOVERLAPPED pOv) {
+    INT i = 0;
+
+    for (i = 0; i < TRANSPORT_READS; i++) {
+        if (pOv == &pT->readOv[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    DrainTransport
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID DrainTransport(PTRANSPORT pT, HANDLE hPort)
+--                          pT      - the reader's transport
+--                          hPort   - the open serial port
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Cancels any outstanding I/O and waits for it to complete, so
+--              that the buffers and OVERLAPPED structures can be reused.
+------------------------------------------------------------------------------*/
+VOID DrainTransport(PTRANSPORT pT, HANDLE hPort) {
+    LPOVERLAPPED    pOv     = NULL;
+    ULONG_PTR       key     = 0;
+    DWORD           dwBytes = 0;
+    INT             iSlot   = 0;
+    INT             i       = 0;
+    BOOL            bBusy   = FALSE;
+
+    CancelIo(hPort);
+
+    for (;;) {
+        bBusy = pT->bWritePending;
+        for (i = 0; i < TRANSPORT_READS; i++) {
+            bBusy |= pT->bReadPending[i];
+        }
+        if (!bBusy) {
+            return;
+        }
+        if (!GetQueuedCompletionStatus(pT->hIocp, &dwBytes, &key, &pOv,
+                                       TRANSPORT_DRAIN_TIMEOUT)  &&
+                pOv == NULL) {
+            // nothing more is coming
+            return;
+        }
+        if (pOv == &pT->writeOv) {
+            pT->bWritePending = FALSE;
+        } else if ((iSlot = GetReadSlot(pT, pOv)) >= 0) {
+            pT->bReadPending[iSlot] = FALSE;
+        }
+    }
+}
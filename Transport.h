@@ -0,0 +1,57 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <Windows.h>
+#include "Command.h"
+
+#define TRANSPORT_BUFSIZE       2048    // bytes in each posted read
+#define TRANSPORT_READS         2       // reads kept posted on the port
+#define TRANSPORT_DRAIN_TIMEOUT 1000    // ms to wait for cancelled I/O
+#define WRITE_QUEUE_LENGTH      16      // commands waiting to be written
+#define WRITE_BUFSIZE           512     // bytes in one coalesced write
+#define WRITE_TIMEOUT           1000    // ms before a write is cancelled
+
+#define KEY_PORT                1       // completion keys
+#define KEY_DISCONNECT          2
+#define KEY_FLUSH               3
+#define KEY_POLLED              4       // the byte count is the tag count
+
+typedef struct transport {
+    HANDLE      hIocp;
+    OVERLAPPED  readOv[TRANSPORT_READS];
+    CHAR        psReadBuf[TRANSPORT_READS][TRANSPORT_BUFSIZE];
+    BOOL        bReadPending[TRANSPORT_READS];
+    OVERLAPPED  writeOv;
+    BOOL        bWritePending;
+    BOOL        bWriteCancelled;
+    CHAR        pcWriteBuf[WRITE_BUFSIZE];
+    DWORD       dwWriteLength;
+    DWORD       dwWriteStart;
+    CRITICAL_SECTION    csQueue;
+    COMMAND     writeQueue[WRITE_QUEUE_LENGTH];
+    DWORD       dwQueueHead;
+    DWORD       dwQueueCount;
+    DWORD       dwReadsPosted;
+    DWORD       dwWritesPosted;
+    DWORD       dwCommandsQueued;
+    DWORD       dwCommandsDropped;
+    DWORD       dwWriteTimeouts;
+    DWORD       dwCompletions;
+} TRANSPORT, *PTRANSPORT;
+
+VOID    InitTransport(PTRANSPORT pT);
+BOOL    OpenTransport(PTRANSPORT pT, HANDLE hPort);
+VOID    CloseTransport(PTRANSPORT pT);
+VOID    WakeTransport(PTRANSPORT pT);
+BOOL    PostTransportRead(PTRANSPORT pT, HANDLE hPort, DWORD dwSlot,
+                          DWORD dwLength);
+BOOL    QueueCommand(PTRANSPORT pT, PCOMMAND pCmd);
+VOID    PostPollResult(PTRANSPORT pT, DWORD dwTags);
+BOOL    FlushWriteQueue(PTRANSPORT pT, HANDLE hPort);
+VOID    CompleteWrite(PTRANSPORT pT, DWORD dwBytesWritten);
+DWORD   GetWriteTimeout(PTRANSPORT pT);
+VOID    CheckWriteTimeout(PTRANSPORT pT, HANDLE hPort);
+INT     GetReadSlot(PTRANSPORT pT, LPOVERLAPPED pOv);
+VOID    DrainTransport(PTRANSPORT pT, HANDLE hPort);
+
+#endif
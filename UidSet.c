@@ -0,0 +1,829 @@
+/*------------------------------------------------------------------------------
+-- SOURCE FILE:     UidSet.c - Contains the allow and deny lists that each tag
+--                             is checked against.
+--
+-- PROGRAM:     RFID Reader - Enterprise Edition
+--
+-- FUNCTIONS:
+--              VOID    InitUidLists(HWND);
+--              VOID    RefreshUidLists(HWND);
+--              VOID    MatchUid(PUIDLISTS, PTAGREAD);
+--              VOID    CloseUidLists(HWND);
+--              ULONGLONG   PackUid(PTAGREAD);
+--              ULONGLONG   HashUid(ULONGLONG);
+--
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              PackUid() and HashUid() are public, for the filter and the
+--              analytics sketches.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- NOTES:
+-- A list can hold millions of UIDs, so it is kept in a binary file that is
+-- mapped into memory rather than read (see UIDSETHEADER). Opening one costs
+-- the same whatever its size, and its pages are shared with every other
+-- instance of the program. A UID is a 64-bit integer, MSB first in the top
+-- bytes, so shorter UIDs sort by their prefix. A lookup first checks the
+-- Bloom filter, which rules out almost every UID that isn't on the list
+-- without touching the UIDs themselves. UIDs that pass are found with a
+-- binary search of the short run that shares their top UIDSET_INDEX_BITS.
+--
+-- The files are built from text lists (one UID per line, in hex, as it is
+-- displayed; anything after a # is ignored) whenever the text is newer. The
+-- files are checked every Interval milliseconds, and one that has changed is
+-- mapped and swapped in with a single pointer exchange, so tags are matched
+-- without a pause. The view that was replaced is unmapped at the next swap,
+-- by which time no lookup can still be using it. A file can also be replaced
+-- directly, by writing it under another name and renaming it over the old
+-- one.
+--
+-- A tag on the deny list is denied. Otherwise, if there is an allow list, the
+-- tag is allowed only if it is on it. A list that is configured but can't be
+-- loaded denies everything.
+--
+--      [Lists]
+--      Allow=allow.uids
+--      AllowSource=allow.txt
+--      Deny=deny.uids
+--      DenySource=deny.txt
+--      Interval=5000
+------------------------------------------------------------------------------*/
+
+#include "Main.h"
+
+static BOOL         RefreshUidList(PUIDLIST pList);
+static PUIDVIEW     LoadUidView(LPCTSTR lpszFile);
+static VOID         FreeUidView(PUIDVIEW pView);
+static BOOL         ContainsUid(PUIDVIEW pView, ULONGLONG ullUid);
+static BOOL         BuildUidSet(LPCTSTR lpszSource, LPCTSTR lpszFile);
+static ULONGLONG*   ReadUidText(LPCTSTR lpszSource, SIZE_T* pCount);
+static BOOL         WriteUidSet(LPCTSTR lpszFile, ULONGLONG* pullUids,
+                                SIZE_T count);
+static INT          CompareUids(const VOID* pA, const VOID* pB);
+static BOOL         GetWriteTime(LPCTSTR lpszFile, FILETIME* pft);
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    InitUidLists
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID InitUidLists(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Reads the [Lists] section of the configuration file, builds
+--              and maps the lists, and starts the timer that checks them for
+--              changes. Must be called after InitConfig().
+------------------------------------------------------------------------------*/
+VOID InitUidLists(HWND hWnd) {
+    PWNDDATA    pwd     = NULL;
+    PUIDLISTS   pLists  = NULL;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pLists  = &pwd->uidLists;
+
+    ZeroMemory(pLists, sizeof(UIDLISTS));
+    ReadConfigPath(hWnd, TEXT("Lists"), TEXT("Allow"), pLists->allow.szFile);
+    ReadConfigPath(hWnd, TEXT("Lists"), TEXT("AllowSource"),
+                   pLists->allow.szSource);
+    ReadConfigPath(hWnd, TEXT("Lists"), TEXT("Deny"), pLists->deny.szFile);
+    ReadConfigPath(hWnd, TEXT("Lists"), TEXT("DenySource"),
+                   pLists->deny.szSource);
+
+    if (pLists->allow.szFile[0] == '\0'  &&  pLists->deny.szFile[0] == '\0') {
+        return;
+    }
+    pLists->bEnabled = TRUE;
+
+    if (!RefreshUidList(&pLists->allow)) {
+        DISPLAY_ERROR("Could not load the allow list");
+    }
+    if (!RefreshUidList(&pLists->deny)) {
+        DISPLAY_ERROR("Could not load the deny list");
+    }
+    SetTimer(hWnd, IDT_UIDSET, ReadConfigInt(hWnd, TEXT("Lists"),
+                                             TEXT("Interval"),
+                                             UIDSET_INTERVAL), NULL);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    RefreshUidLists
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID RefreshUidLists(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Called on the IDT_UIDSET timer. Rebuilds and swaps in any list
+--              that has changed. A list that fails to load keeps the one it
+--              already had.
+------------------------------------------------------------------------------*/
+VOID RefreshUidLists(HWND hWnd) {
+    PWNDDATA pwd = NULL;
+    pwd = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+
+    RefreshUidList(&pwd->uidLists.allow);
+    RefreshUidList(&pwd->uidLists.deny);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    MatchUid
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID MatchUid(PUIDLISTS pLists, PTAGREAD pRead)
+--                          pLists  - the lists
+--                          pRead   - a decoded tag; receives the result
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Sets the tag's bMatch. May be called from any thread, while the
+--              lists are being swapped.
+------------------------------------------------------------------------------*/
+VOID MatchUid(PUIDLISTS pLists, PTAGREAD pRead) {
+    PUIDVIEW    pView   = NULL;
+    ULONGLONG   ullUid  = 0;
+
+    pRead->bMatch = MATCH_NONE;
+    if (!pLists->bEnabled) {
+        return;
+    }
+    ullUid = PackUid(pRead);
+
+    if (pLists->deny.szFile[0] != '\0') {
+        pView = pLists->deny.pCurrent;
+        if (pView == NULL  ||  ContainsUid(pView, ullUid)) {
+            pRead->bMatch = MATCH_DENIED;
+            return;
+        }
+    }
+    if (pLists->allow.szFile[0] != '\0') {
+        pView = pLists->allow.pCurrent;
+        pRead->bMatch = (pView != NULL  &&  ContainsUid(pView, ullUid))
+                      ? MATCH_ALLOWED : MATCH_DENIED;
+        return;
+    }
+    pRead->bMatch = MATCH_ALLOWED;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CloseUidLists
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   VOID CloseUidLists(HWND hWnd)
+--                          hWnd - the handle to the window
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Unmaps every list. The decode workers must have stopped.
+------------------------------------------------------------------------------*/
+VOID CloseUidLists(HWND hWnd) {
+    PWNDDATA    pwd     = NULL;
+    PUIDLISTS   pLists  = NULL;
+    pwd     = (PWNDDATA) GetWindowLongPtr(hWnd, 0);
+    pLists  = &pwd->uidLists;
+
+    if (!pLists->bEnabled) {
+        return;
+    }
+    KillTimer(hWnd, IDT_UIDSET);
+    FreeUidView(pLists->allow.pCurrent);
+    FreeUidView(pLists->allow.pRetired);
+    FreeUidView(pLists->deny.pCurrent);
+    FreeUidView(pLists->deny.pRetired);
+    ZeroMemory(pLists, sizeof(UIDLISTS));
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    RefreshUidList
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static BOOL RefreshUidList(PUIDLIST pList)
+--                          pList - the list to check
+--
+-- RETURNS:     False if the list is configured, but its file couldn't be
+--              mapped.
+--
+-- NOTES:
+--              Rebuilds the file if its text list is newer, and maps it again
+--              if it has been written since it was last mapped. The new view
+--              is published with one interlocked exchange; the one it replaces
+--              is retired, and the one retired before that is unmapped.
+------------------------------------------------------------------------------*/
+static BOOL RefreshUidList(PUIDLIST pList) {
+    PUIDVIEW    pView       = NULL;
+    FILETIME    ftSource    = {0};
+    FILETIME    ftFile      = {0};
+
+    if (pList->szFile[0] == '\0') {
+        return TRUE;
+    }
+    if (pList->szSource[0] != '\0'
+            &&  GetWriteTime(pList->szSource, &ftSource)
+            &&  (!GetWriteTime(pList->szFile, &ftFile)
+                 ||  CompareFileTime(&ftSource, &ftFile) > 0)) {
+        BuildUidSet(pList->szSource, pList->szFile);
+    }
+
+    if (!GetWriteTime(pList->szFile, &ftFile)) {
+        return FALSE;
+    }
+    if (pList->pCurrent != NULL
+            &&  CompareFileTime(&ftFile, &pList->ftFile) == 0) {
+        return TRUE;
+    }
+    if ((pView = LoadUidView(pList->szFile)) == NULL) {
+        return FALSE;
+    }
+
+    FreeUidView(pList->pRetired);
+    pList->pRetired = (PUIDVIEW) InterlockedExchangePointer(
+                          (PVOID volatile*) &pList->pCurrent, pView);
+    pList->ftFile   = ftFile;
+    return TRUE;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    LoadUidView
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static PUIDVIEW LoadUidView(LPCTSTR lpszFile)
+--                          lpszFile - the UID set file
+--
+-- RETURNS:     The mapped file, or NULL if it couldn't be mapped or isn't a
+--              valid UID set.
+--
+-- NOTES:
+--              Maps the whole file read-only, and checks that its size matches
+--              its header. Nothing is read until it is looked up. The file is
+--              opened with FILE_SHARE_DELETE so that it can be renamed over
+--              while it is mapped.
+------------------------------------------------------------------------------*/
+static PUIDVIEW LoadUidView(LPCTSTR lpszFile) {
+    PUIDVIEW        pView       = NULL;
+    PUIDSETHEADER   pHeader     = NULL;
+    LARGE_INTEGER   liSize      = {0};
+    ULONGLONG       ullBloom    = 0;
+    ULONGLONG       ullExpected = 0;
+
+    if ((pView = (PUIDVIEW) calloc(1, sizeof(UIDVIEW))) == NULL) {
+        return NULL;
+    }
+    pView->hFile = CreateFile(lpszFile, GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (pView->hFile == INVALID_HANDLE_VALUE
+            ||  !GetFileSizeEx(pView->hFile, &liSize)
+            ||  liSize.QuadPart < sizeof(UIDSETHEADER)) {
+        FreeUidView(pView);
+        return NULL;
+    }
+    pView->hMap = CreateFileMapping(pView->hFile, NULL, PAGE_READONLY, 0, 0,
+                                    NULL);
+    if (pView->hMap == NULL  ||  (pView->pbBase = (BYTE*) MapViewOfFile(
+                                      pView->hMap, FILE_MAP_READ, 0, 0, 0))
+                                 == NULL) {
+        FreeUidView(pView);
+        return NULL;
+    }
+
+    pHeader = (PUIDSETHEADER) pView->pbBase;
+    if (pHeader->dwMagic != UIDSET_MAGIC
+            ||  pHeader->dwVersion != UIDSET_VERSION
+            ||  pHeader->dwBloomShift < UIDSET_MIN_SHIFT
+            ||  pHeader->dwBloomShift > UIDSET_MAX_SHIFT
+            ||  pHeader->dwHashes < 1
+            ||  pHeader->ullCount > MAXDWORD) {
+        FreeUidView(pView);
+        return NULL;
+    }
+    ullBloom    = (1ULL << pHeader->dwBloomShift) / 8;
+    ullExpected = sizeof(UIDSETHEADER) + ullBloom
+                + pHeader->ullCount * sizeof(ULONGLONG)
+                + (UIDSET_INDEX + 1) * sizeof(DWORD);
+    if ((ULONGLONG) liSize.QuadPart != ullExpected) {
+        FreeUidView(pView);
+        return NULL;
+    }
+
+    pView->pHeader      = pHeader;
+    pView->pbBloom      = pView->pbBase + sizeof(UIDSETHEADER);
+    pView->pullUids     = (ULONGLONG*) (pView->pbBloom + ullBloom);
+    pView->pdwIndex     = (DWORD*) (pView->pullUids + pHeader->ullCount);
+    pView->ullBloomMask = (1ULL << pHeader->dwBloomShift) - 1;
+    return pView;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    FreeUidView
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static VOID FreeUidView(PUIDVIEW pView)
+--                          pView - a view from LoadUidView(), or NULL
+--
+-- RETURNS:     VOID.
+--
+-- NOTES:
+--              Unmaps and closes whatever part of the view was opened.
+------------------------------------------------------------------------------*/
+static VOID FreeUidView(PUIDVIEW pView) {
+
+    if (pView == NULL) {
+        return;
+    }
+    if (pView->pbBase != NULL) {
+        UnmapViewOfFile(pView->pbBase);
+    }
+    if (pView->hMap != NULL) {
+        CloseHandle(pView->hMap);
+    }
+    if (pView->hFile != NULL  &&  pView->hFile != INVALID_HANDLE_VALUE) {
+        CloseHandle(pView->hFile);
+    }
+    free(pView);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ContainsUid
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static BOOL ContainsUid(PUIDVIEW pView, ULONGLONG ullUid)
+--                          pView   - a mapped UID set
+--                          ullUid  - the UID to look up
+--
+-- RETURNS:     True if the UID is in the set.
+--
+-- NOTES:
+--              The Bloom filter's bits are found by double hashing: bit i is
+--              h1 + i * h2, where h1 and h2 are the two halves of one hash.
+------------------------------------------------------------------------------*/
+static BOOL ContainsUid(PUIDVIEW pView, ULONGLONG ullUid) {
+    ULONGLONG   ullHash = 0;
+    ULONGLONG   ullBit  = 0;
+    DWORD       dwStep  = 0;
+    DWORD       dwLow   = 0;
+    DWORD       dwHigh  = 0;
+    DWORD       dwMid   = 0;
+    DWORD       i       = 0;
+
+    ullHash = HashUid(ullUid);
+    dwStep  = (DWORD) (ullHash >> 32) | 1;
+    for (i = 0; i < pView->pHeader->dwHashes; i++) {
+        ullBit = ((DWORD) ullHash + (ULONGLONG) i * dwStep)
+               & pView->ullBloomMask;
+        if (!(pView->pbBloom[ullBit >> 3] & (1 << (ullBit & 7)))) {
+            return FALSE;
+        }
+    }
+
+    dwLow   = pView->pdwIndex[ullUid >> (64 - UIDSET_INDEX_BITS)];
+    dwHigh  = pView->pdwIndex[(ullUid >> (64 - UIDSET_INDEX_BITS)) + 1];
+    while (dwLow < dwHigh) {
+        dwMid = dwLow + (dwHigh - dwLow) / 2;
+        if (pView->pullUids[dwMid] < ullUid) {
+            dwLow = dwMid + 1;
+        } else {
+            dwHigh = dwMid;
+        }
+    }
+    return dwLow < pView->pHeader->ullCount
+        &&  pView->pullUids[dwLow] == ullUid;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    PackUid
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   ULONGLONG PackUid(PTAGREAD pRead)
+--                          pRead - a decoded tag
+--
+-- RETURNS:     The tag's UID as an integer, MSB first in the top bytes.
+------------------------------------------------------------------------------*/
+ULONGLONG PackUid(PTAGREAD pRead) {
+    ULONGLONG   ullUid  = 0;
+    DWORD       i       = 0;
+
+    for (i = 0; i < pRead->dwUidLength; i++) {
+        ullUid |= (ULONGLONG) pRead->pbUid[i] << (56 - 8 * i);
+    }
+    return ullUid;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    HashUid
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   Oct 19, 2026
+--              No longer static.
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   ULONGLONG HashUid(ULONGLONG ullUid)
+--                          ullUid - a UID
+--
+-- RETURNS:     The UID's hash.
+--
+-- NOTES:
+--              The SplitMix64 finalizer. UIDs from one manufacturer share
+--              their top bytes, so every bit of the UID has to reach every bit
+--              of the hash. Changing this changes the file format.
+------------------------------------------------------------------------------*/
+ULONGLONG HashUid(ULONGLONG ullUid) {
+
+    ullUid ^= ullUid >> 30;
+    ullUid *= 0xBF58476D1CE4E5B9ULL;
+    ullUid ^= ullUid >> 27;
+    ullUid *= 0x94D049BB133111EBULL;
+    ullUid ^= ullUid >> 31;
+    return ullUid;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    BuildUidSet
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static BOOL BuildUidSet(LPCTSTR lpszSource, LPCTSTR lpszFile)
+--                          lpszSource  - a text list of UIDs
+--                          lpszFile    - the UID set file to write
+--
+-- RETURNS:     False if the list couldn't be read or the file written.
+--
+-- NOTES:
+--              Sorts the UIDs and removes duplicates, then writes them out.
+------------------------------------------------------------------------------*/
+static BOOL BuildUidSet(LPCTSTR lpszSource, LPCTSTR lpszFile) {
+    ULONGLONG*  pullUids    = NULL;
+    SIZE_T      count       = 0;
+    SIZE_T      kept        = 0;
+    SIZE_T      i           = 0;
+    BOOL        bResult     = FALSE;
+
+    if ((pullUids = ReadUidText(lpszSource, &count)) == NULL) {
+        return FALSE;
+    }
+    qsort(pullUids, count, sizeof(ULONGLONG), CompareUids);
+    for (i = 0; i < count; i++) {
+        if (kept == 0  ||  pullUids[i] != pullUids[kept - 1]) {
+            pullUids[kept++] = pullUids[i];
+        }
+    }
+    bResult = WriteUidSet(lpszFile, pullUids, kept);
+    free(pullUids);
+    return bResult;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    ReadUidText
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static ULONGLONG* ReadUidText(LPCTSTR lpszSource,
+--                                            SIZE_T* pCount)
+--                          lpszSource  - a text list of UIDs
+--                          pCount      - receives the number of UIDs
+--
+-- RETURNS:     The UIDs, which the caller must free(), or NULL on an error.
+--
+-- NOTES:
+--              Each line holds one UID in hex, MSB first, up to 16 digits.
+--              Spaces, colons and dashes between the digits are ignored, as is
+--              anything after a '#'. Lines with anything else are skipped.
+------------------------------------------------------------------------------*/
+static ULONGLONG* ReadUidText(LPCTSTR lpszSource, SIZE_T* pCount) {
+    HANDLE          hFile       = INVALID_HANDLE_VALUE;
+    HANDLE          hMap        = NULL;
+    CHAR*           pcText      = NULL;
+    LARGE_INTEGER   liSize      = {0};
+    ULONGLONG*      pullUids    = NULL;
+    ULONGLONG*      pullGrown   = NULL;
+    SIZE_T          capacity    = 1024;
+    ULONGLONG       ullValue    = 0;
+    DWORD           dwDigits    = 0;
+    BOOL            bValid      = TRUE;
+    BOOL            bComment    = FALSE;
+    BOOL            bFailed     = FALSE;
+    LONGLONG        i           = 0;
+    CHAR            c           = 0;
+
+    *pCount = 0;
+    hFile = CreateFile(lpszSource, GENERIC_READ, FILE_SHARE_READ, NULL,
+                       OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+    if (!GetFileSizeEx(hFile, &liSize)
+            ||  (pullUids = (ULONGLONG*) malloc(capacity * sizeof(ULONGLONG)))
+                == NULL) {
+        CloseHandle(hFile);
+        return NULL;
+    }
+    if (liSize.QuadPart > 0) {
+        hMap = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (hMap == NULL  ||  (pcText = (CHAR*) MapViewOfFile(
+                                   hMap, FILE_MAP_READ, 0, 0, 0)) == NULL) {
+            if (hMap != NULL) {
+                CloseHandle(hMap);
+            }
+            CloseHandle(hFile);
+            free(pullUids);
+            return NULL;
+        }
+    }
+
+    // one extra pass, as if the file ended with a newline
+    for (i = 0; i <= liSize.QuadPart; i++) {
+        c = (i < liSize.QuadPart) ? pcText[i] : '\n';
+
+        if (c == '\n'  ||  c == '\r') {
+            if (bValid  &&  dwDigits > 0) {
+                if (*pCount == capacity) {
+                    capacity *= 2;
+                    pullGrown = (ULONGLONG*) realloc(pullUids,
+                                                     capacity
+                                                     * sizeof(ULONGLONG));
+                    if (pullGrown == NULL) {
+                        bFailed = TRUE;
+                        break;
+                    }
+                    pullUids = pullGrown;
+                }
+                pullUids[(*pCount)++] = ullValue << (64 - 4 * dwDigits);
+            }
+            ullValue    = 0;
+            dwDigits    = 0;
+            bValid      = TRUE;
+            bComment    = FALSE;
+        } else if (bComment  ||  c == ' '  ||  c == '\t'  ||  c == ':'
+                   ||  c == '-') {
+            continue;
+        } else if (c == '#') {
+            bComment = TRUE;
+        } else if (c >= '0'  &&  c <= '9'  &&  dwDigits < 16) {
+            ullValue = (ullValue << 4) | (c - '0');
+            dwDigits++;
+        } else if (c >= 'A'  &&  c <= 'F'  &&  dwDigits < 16) {
+            ullValue = (ullValue << 4) | (c - 'A' + 10);
+            dwDigits++;
+        } else if (c >= 'a'  &&  c <= 'f'  &&  dwDigits < 16) {
+            ullValue = (ullValue << 4) | (c - 'a' + 10);
+            dwDigits++;
+        } else {
+            bValid = FALSE;
+        }
+    }
+
+    if (pcText != NULL) {
+        UnmapViewOfFile(pcText);
+        CloseHandle(hMap);
+    }
+    CloseHandle(hFile);
+    if (bFailed) {
+        free(pullUids);
+        return NULL;
+    }
+    return pullUids;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    WriteUidSet
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static BOOL WriteUidSet(LPCTSTR lpszFile, ULONGLONG* pullUids,
+--                                      SIZE_T count)
+--                          lpszFile    - the UID set file to write
+--                          pullUids    - the UIDs, sorted, without duplicates
+--                          count       - the number of UIDs
+--
+-- RETURNS:     False if the file couldn't be written.
+--
+-- NOTES:
+--              Builds the Bloom filter (UIDSET_BITS_PER_UID bits per UID,
+--              rounded up to a power of two) and the index, and writes the
+--              file under a temporary name before renaming it over the old
+--              one. A reader of the old file never sees a partial one.
+------------------------------------------------------------------------------*/
+static BOOL WriteUidSet(LPCTSTR lpszFile, ULONGLONG* pullUids, SIZE_T count) {
+    UIDSETHEADER    header              = {0};
+    TCHAR           szTemp[MAX_PATH]    = {0};
+    HANDLE          hFile               = INVALID_HANDLE_VALUE;
+    BYTE*           pbBloom             = NULL;
+    DWORD*          pdwIndex            = NULL;
+    ULONGLONG       ullHash             = 0;
+    ULONGLONG       ullBit              = 0;
+    SIZE_T          bloomBytes          = 0;
+    DWORD           dwStep              = 0;
+    DWORD           dwWritten           = 0;
+    BOOL            bResult             = TRUE;
+    SIZE_T          i                   = 0;
+    DWORD           j                   = 0;
+
+    if (count > MAXDWORD  ||  lstrlen(lpszFile) + 5 >= MAX_PATH) {
+        return FALSE;
+    }
+    header.dwMagic      = UIDSET_MAGIC;
+    header.dwVersion    = UIDSET_VERSION;
+    header.dwHashes     = UIDSET_HASHES;
+    header.ullCount     = count;
+    header.dwBloomShift = UIDSET_MIN_SHIFT;
+    while (header.dwBloomShift < UIDSET_MAX_SHIFT
+            &&  (1ULL << header.dwBloomShift) < count * UIDSET_BITS_PER_UID) {
+        header.dwBloomShift++;
+    }
+    bloomBytes = (SIZE_T) ((1ULL << header.dwBloomShift) / 8);
+
+    pbBloom  = (BYTE*) calloc(bloomBytes, 1);
+    pdwIndex = (DWORD*) malloc((UIDSET_INDEX + 1) * sizeof(DWORD));
+    if (pbBloom == NULL  ||  pdwIndex == NULL) {
+        free(pbBloom);
+        free(pdwIndex);
+        return FALSE;
+    }
+
+    for (i = 0; i < count; i++) {
+        ullHash = HashUid(pullUids[i]);
+        dwStep  = (DWORD) (ullHash >> 32) | 1;
+        for (j = 0; j < UIDSET_HASHES; j++) {
+            ullBit = ((DWORD) ullHash + (ULONGLONG) j * dwStep)
+                   & ((1ULL << header.dwBloomShift) - 1);
+            pbBloom[ullBit >> 3] |= 1 << (ullBit & 7);
+        }
+    }
+    for (i = 0, j = 0; j <= UIDSET_INDEX; j++) {
+        while (i < count  &&  (pullUids[i] >> (64 - UIDSET_INDEX_BITS)) < j) {
+            i++;
+        }
+        pdwIndex[j] = (DWORD) i;
+    }
+
+    wsprintf(szTemp, TEXT("%s.tmp"), lpszFile);
+    hFile = CreateFile(szTemp, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                       FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        bResult = FALSE;
+    } else {
+        bResult = WriteFile(hFile, &header, sizeof(header), &dwWritten, NULL)
+               && WriteFile(hFile, pbBloom, (DWORD) bloomBytes, &dwWritten,
+                            NULL)
+               && WriteFile(hFile, pullUids, (DWORD) (count
+                                                      * sizeof(ULONGLONG)),
+                            &dwWritten, NULL)
+               && WriteFile(hFile, pdwIndex, (UIDSET_INDEX + 1)
+                                             * sizeof(DWORD),
+                            &dwWritten, NULL);
+        CloseHandle(hFile);
+        bResult = bResult  &&  MoveFileEx(szTemp, lpszFile,
+                                          MOVEFILE_REPLACE_EXISTING
+                                          | MOVEFILE_WRITE_THROUGH);
+        if (!bResult) {
+            DeleteFile(szTemp);
+        }
+    }
+    free(pbBloom);
+    free(pdwIndex);
+    return bResult;
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    CompareUids
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static INT CompareUids(const VOID* pA, const VOID* pB)
+--                          pA  - a UID
+--                          pB  - another UID
+--
+-- RETURNS:     Less than, equal to, or greater than 0, for qsort().
+------------------------------------------------------------------------------*/
+static INT CompareUids(const VOID* pA, const VOID* pB) {
+    ULONGLONG ullA = *(const ULONGLONG*) pA;
+    ULONGLONG ullB = *(const ULONGLONG*) pB;
+
+    return (ullA > ullB) - (ullA < ullB);
+}
+
+/*------------------------------------------------------------------------------
+-- FUNCTION:    GetWriteTime
+--
+-- DATE:        Oct 19, 2026
+--
+-- REVISIONS:   (Date and Description)
+--
+-- DESIGNER:    Dean Morin
+--
+-- PROGRAMMER:  Dean Morin
+--
+-- INTERFACE:   static BOOL GetWriteTime(LPCTSTR lpszFile, FILETIME* pft)
+--                          lpszFile    - the file
+--                          pft         - receives when it was last written
+--
+-- RETURNS:     False if the file doesn't exist.
+------------------------------------------------------------------------------*/
+static BOOL GetWriteTime(LPCTSTR lpszFile, FILETIME* pft) {
+    WIN32_FILE_ATTRIBUTE_DATA fad = {0};
+
+    if (!GetFileAttributesEx(lpszFile, GetFileExInfoStandard, &fad)) {
+        return FALSE;
+    }
+    *pft = fad.ftLastWriteTime;
+    return TRUE;
+}
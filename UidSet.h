@@ -0,0 +1,63 @@
+#ifndef UIDSET_H
+#define UIDSET_H
+
+#include <Windows.h>
+#include "Tag.h"
+
+#define IDT_UIDSET          3
+#define UIDSET_INTERVAL     5000    // ms between checks for a new list
+#define UIDSET_MAGIC        0x53444955  // "UIDS"
+#define UIDSET_VERSION      1
+#define UIDSET_HASHES       7       // Bloom filter bits set per UID
+#define UIDSET_BITS_PER_UID 10      // Bloom filter size, about 1% false hits
+#define UIDSET_MIN_SHIFT    13      // the smallest Bloom filter, 2^13 bits
+#define UIDSET_MAX_SHIFT    31
+#define UIDSET_INDEX_BITS   16      // UIDs are indexed by their top bits
+#define UIDSET_INDEX        (1 << UIDSET_INDEX_BITS)
+
+// The file is the header, the Bloom filter, the sorted UIDs, and then
+// UIDSET_INDEX + 1 offsets into the UIDs, one for each value of their top
+// UIDSET_INDEX_BITS bits.
+typedef struct uidSetHeader {
+    DWORD       dwMagic;
+    DWORD       dwVersion;
+    DWORD       dwBloomShift;   // log2 of the bits in the Bloom filter
+    DWORD       dwHashes;
+    ULONGLONG   ullCount;
+    ULONGLONG   ullReserved;
+} UIDSETHEADER, *PUIDSETHEADER;
+
+typedef struct uidView {
+    HANDLE          hFile;
+    HANDLE          hMap;
+    BYTE*           pbBase;
+    PUIDSETHEADER   pHeader;
+    BYTE*           pbBloom;
+    ULONGLONG*      pullUids;
+    DWORD*          pdwIndex;
+    ULONGLONG       ullBloomMask;
+} UIDVIEW, *PUIDVIEW;
+
+typedef struct uidList {
+    TCHAR               szFile[MAX_PATH];
+    TCHAR               szSource[MAX_PATH];
+    FILETIME            ftFile;             // when the mapped file was written
+    PUIDVIEW volatile   pCurrent;
+    PUIDVIEW            pRetired;           // unmapped at the next swap
+} UIDLIST, *PUIDLIST;
+
+typedef struct uidLists {
+    BOOL        bEnabled;
+    UIDLIST     allow;
+    UIDLIST     deny;
+    DWORD       dwSwaps;
+} UIDLISTS, *PUIDLISTS;
+
+VOID    InitUidLists(HWND hWnd);
+VOID    RefreshUidLists(HWND hWnd);
+VOID    MatchUid(PUIDLISTS pLists, PTAGREAD pRead);
+VOID    CloseUidLists(HWND hWnd);
+ULONGLONG   PackUid(PTAGREAD pRead);
+ULONGLONG   HashUid(ULONGLONG ullUid);
+
+#endif